@@ -0,0 +1,125 @@
+/******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2016 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+/*
+ *      PROJECT:   ST25R3911 firmware
+ *      $Revision: $
+ *      LANGUAGE:  ANSI C
+ */
+
+
+/*! \file
+ *
+ *  \brief Discovery of PICCs of several technologies in one go
+ *
+ *  Polls the technologies in the order given, each for up to its time
+ *  budget, and collects the PICCs found into one list. The technologies
+ *  are switched by their poller initialization only: the field stays on
+ *  and just the guard time of the next technology applies, as in the NFC
+ *  Forum polling loop.
+ *
+ */
+
+#ifndef DISCOVERY_H
+#define DISCOVERY_H
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include "platform.h"
+#include "uid_set.h"
+
+/*
+******************************************************************************
+* GLOBAL DEFINES
+******************************************************************************
+*/
+#define DISCOVERY_MAX_DEVICES    16U  /*!< most PICCs returned by one discovery    */
+#define DISCOVERY_MAX_STEPS      8U   /*!< most technologies polled by one discovery */
+#define DISCOVERY_MAX_ID_LEN     32U  /*!< longest ID: 256 bit Kovio code           */
+#define DISCOVERY_MAX_INFO_LEN   8U   /*!< longest info: FeliCa PMm                 */
+
+#define DISCOVERY_TECH_ISO15693  UID_SET_TECH_ISO15693 /*!< ID: UID, info: DSFID          */
+#define DISCOVERY_TECH_NFCA      UID_SET_TECH_NFCA     /*!< ID: NFCID1, info: ATQA, SAK   */
+#define DISCOVERY_TECH_NFCB      UID_SET_TECH_NFCB     /*!< ID: PUPI, info: app data, protocol info */
+#define DISCOVERY_TECH_FELICA    UID_SET_TECH_FELICA   /*!< ID: IDm, info: PMm            */
+#define DISCOVERY_TECH_ST25TB    UID_SET_TECH_ST25TB   /*!< ID: UID, info: Chip_ID        */
+#define DISCOVERY_TECH_KOVIO     6U                    /*!< ID: code, no info             */
+
+#define DISCOVERY_OPT_STOP_FIRST 0x01 /*!< stop after the first technology which found PICCs */
+
+/*
+******************************************************************************
+* GLOBAL DATATYPES
+******************************************************************************
+*/
+/*!
+ * One technology to be polled by #discoveryRun().
+ */
+typedef struct
+{
+    uint8_t tech;       /*!< DISCOVERY_TECH_xxx */
+    uint8_t budgetMs;   /*!< polls are repeated until a PICC answers or this
+                             time is over, 0 polls once */
+} discoveryStep_t;
+
+/*!
+ * A PICC found by #discoveryRun().
+ */
+typedef struct
+{
+    uint8_t tech;                           /*!< DISCOVERY_TECH_xxx */
+    uint8_t idLen;                          /*!< length of \a id */
+    uint8_t id[DISCOVERY_MAX_ID_LEN];       /*!< UID as received */
+    uint8_t infoLen;                        /*!< length of \a info */
+    uint8_t info[DISCOVERY_MAX_INFO_LEN];   /*!< technology specific, see DISCOVERY_TECH_xxx */
+} discoveryDevice_t;
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ *  \brief  Poll several technologies and collect the PICCs found.
+ *  Stops when \a maxDevices PICCs are found, after the last step or with
+ *  #DISCOVERY_OPT_STOP_FIRST after the first step which found PICCs.
+ *  The RF is left in the mode of the last technology polled.
+ *  \param[in] steps : technologies in the order to be polled
+ *  \param[in] numSteps : number of \a steps, at most #DISCOVERY_MAX_STEPS
+ *  \param[in] options : DISCOVERY_OPT_xxx
+ *  \param[out] devices : PICCs found
+ *  \param[in] maxDevices : size of \a devices, at most #DISCOVERY_MAX_DEVICES
+ *  \param[out] numDevices : number of PICCs found
+ *  \param[out] polls : poll commands sent, repeats within a budget included
+ *  \return ERR_PARAM : Unknown technology or count out of range.
+ *  \return ERR_NOTFOUND : No PICC answered.
+ *  \return ERR_xxx : A technology could not be initialized.
+ *  \return ERR_NONE : No error.
+ *****************************************************************************
+ */
+extern ReturnCode discoveryRun(const discoveryStep_t *steps, uint8_t numSteps, uint8_t options,
+                               discoveryDevice_t *devices, uint8_t maxDevices, uint8_t *numDevices, uint16_t *polls);
+
+#endif /* DISCOVERY_H */
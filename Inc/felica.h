@@ -51,6 +51,11 @@
 ******************************************************************************
 */
 #define FELICA_MAX_ID_LENGTH 8
+#define FELICA_PMM_LENGTH 8
+#define FELICA_BLOCK_LENGTH 16
+#define FELICA_MAX_BLOCKS_PER_READ 15   /*!< most blocks of one Read Without Encryption, limited by the frame length */
+#define FELICA_LITE_BLOCKS_PER_READ 4   /*!< most blocks FeliCa Lite and Lite-S read at once */
+#define FELICA_MAX_SERVICES_PER_READ 16 /*!< most services of one Read Without Encryption */
 
 /*
 ******************************************************************************
@@ -95,6 +100,28 @@ enum felicaCommand
     FELICA_CMD_WRITE                    = 0x16, /*!< write Block Data to a Service that requires authentication. */
 };
 
+/*!
+  consecutive blocks of one service to be read by #felicaReadBlocks
+ */
+struct felicaBlockRange
+{
+    uint16_t serviceCode; /*!< service code as a number, e.g. 0x000B */
+    uint16_t firstBlock;  /*!< number of the first block */
+    uint8_t  numBlocks;   /*!< number of blocks */
+};
+
+/*!
+  outcome of #felicaReadBlocks
+ */
+struct felicaReadResult
+{
+    uint16_t blocks;      /*!< blocks read */
+    uint8_t  commands;    /*!< Read Without Encryption commands which succeeded */
+    uint8_t  failures;    /*!< commands which failed and were retried with less blocks */
+    uint8_t  statusFlag1; /*!< status flags of the last response */
+    uint8_t  statusFlag2;
+};
+
 enum felicaSlots
 {
     FELICA_1_SLOT = 0,
@@ -182,4 +209,41 @@ extern ReturnCode felicaPoll(enum felicaSlots slots,
  *****************************************************************************
  */
 extern ReturnCode felicaTxRxNBytes(const uint8_t *txbuf, uint16_t sizeof_txbuf, uint8_t *rxbuf, uint16_t sizeof_rxbuf, uint16_t *actrxlength);
+
+/*!
+ *****************************************************************************
+ *  Read the blocks of several services with as few Read Without Encryption
+ *  commands as possible. Each command takes up to \a maxPerCmd blocks of
+ *  the ranges in the given order, services are mixed within a command.
+ *  The FWT of each command is calculated from the Read parameter of the
+ *  card's PMm and the number of blocks.
+ *  A command the card rejects or does not answer is repeated with half the
+ *  blocks, the read stops after 3 failures in a row or when the card
+ *  rejects a single block. Each command read doubles the blocks again, up
+ *  to the most the card did not reject.
+ *  A command is: length, 0x06, IDm, number of services, service code list
+ *  with each code LSB first, number of blocks, block list. A block list
+ *  element is 0x80 | service index followed by the block number for blocks
+ *  up to 0xFF, else service index and the block number LSB first.
+ *  \param[in] idm: IDm of the card as returned by #felicaPoll
+ *  \param[in] pmm: PMm of the card as returned by #felicaPoll
+ *  \param[in] ranges: blocks to be read
+ *  \param[in] numRanges: number of entries in \a ranges
+ *  \param[in] maxPerCmd: most blocks per command, 0 chooses by the IC type:
+ *                     #FELICA_LITE_BLOCKS_PER_READ for FeliCa Lite and Lite-S,
+ *                     #FELICA_MAX_BLOCKS_PER_READ else
+ *  \param[out] data: block data in the order of \a ranges
+ *  \param[in] dataSize: size of \a data
+ *  \param[out] result: blocks read, commands and last status flags
+ *  \return ERR_PARAM : \a maxPerCmd too large or an empty range.
+ *  \return ERR_NOMEM : \a data cannot hold all blocks.
+ *  \return ERR_PROTO : card rejected a block, see status flags of \a result.
+ *  \return ERR_xxx : error of the last command, \a data holds the blocks
+ *                    read so far.
+ *  \return ERR_NONE : No error.
+ *****************************************************************************
+ */
+extern ReturnCode felicaReadBlocks(const uint8_t *idm, const uint8_t *pmm,
+                     const struct felicaBlockRange *ranges, uint8_t numRanges, uint8_t maxPerCmd,
+                     uint8_t *data, uint16_t dataSize, struct felicaReadResult *result);
 #endif /* FELICA_H */
@@ -44,6 +44,52 @@
 ******************************************************************************
 */
 #include "platform.h"
+#include "coroutine.h"
+#include "rfal_isoDep.h"
+
+/*
+******************************************************************************
+* GLOBAL DEFINES
+******************************************************************************
+*/
+/*! Largest FSD asked on activation, limited by RFAL_FEATURE_ISO_DEP_IBLOCK_MAX_LEN */
+#define ISO14443_L4_MAX_FSDI        RFAL_ISODEP_FSXI_256
+/*! Longest answer to activation: ATS of NFC-A, ATTRIB response of NFC-B is shorter */
+#define ISO14443_L4_ANSWER_MAX_LEN  sizeof(rfalIsoDepAts)
+
+/*
+******************************************************************************
+* GLOBAL DATATYPES
+******************************************************************************
+*/
+/*!
+ * Parameters of a running #iso14443TransmitAndReceiveL4Co(), see
+ * #iso14443TransmitAndReceiveL4() for their meaning.
+ */
+typedef struct
+{
+    const uint8_t* txbuf;   /*!< data to be transmitted. */
+    uint16_t txlen;         /*!< Number of bytes to transmit. */
+    uint8_t* rxbuf;         /*!< Buffer where the result will be written to. */
+    uint16_t rxlen;         /*!< Max. number of bytes to receive, overwritten while running. */
+    uint16_t* actrxlength;  /*!< actual receive length. */
+} iso14443L4Context_t;
+
+/*!
+ * Parameters agreed by #iso14443AActivate() or #iso14443BActivate()
+ */
+typedef struct
+{
+    uint8_t  dsi;           /*!< bit rate PICC to PCD, a rfalBitRate */
+    uint8_t  dri;           /*!< bit rate PCD to PICC, a rfalBitRate */
+    uint16_t fsc;           /*!< frame size of the PICC */
+    uint16_t fsd;           /*!< frame size of the reader */
+    uint8_t  fwi;           /*!< frame waiting time integer */
+    uint8_t  sfgi;          /*!< start-up frame guard time integer */
+    uint8_t  did;           /*!< device ID, RFAL_ISODEP_NO_DID if not used */
+    uint8_t  answerLen;     /*!< length of \a answer */
+    uint8_t  answer[ISO14443_L4_ANSWER_MAX_LEN]; /*!< ATS or ATTRIB response */
+} iso14443L4Activation_t;
 
 /*
 ******************************************************************************
@@ -81,6 +127,25 @@ extern ReturnCode iso14443TransmitAndReceiveL4(const uint8_t* txbuf,
                                     uint8_t* rxbuf,
                                     uint16_t rxlen,
                                     uint16_t* actrxlength);
+
+/*!
+ *****************************************************************************
+ *  \brief  Transmit an ISO14443 frame and get response (coroutine)
+ *
+ *  Same as #iso14443TransmitAndReceiveL4() but yields while the ISO-DEP
+ *  exchange is ongoing instead of blocking, see rfal_coroutine.h.
+ *  Can be given to #rfalCoroutineStart().
+ *
+ *  \param[in] co: control block of the coroutine.
+ *  \param[in,out] arg: a #iso14443L4Context_t holding the parameters.
+ *
+ *  \return ERR_BUSY : Still running, call again.
+ *  \return others : as #iso14443TransmitAndReceiveL4().
+ *
+ *****************************************************************************
+ */
+extern ReturnCode iso14443TransmitAndReceiveL4Co(coroutine_t *co, void *arg);
+
 /*!
  *****************************************************************************
  *  \brief  Transmit an ISO14443 frame and get response
@@ -113,6 +178,21 @@ extern ReturnCode iso14443TransmitAndReceive(const uint8_t* txbuf,
                                     uint16_t* actrxlength,
                                     uint32_t fwt_64fcs);
 
+/*!
+ *****************************************************************************
+ *  \brief  Take over the parameters of an activated PICC
+ *
+ *  Used by #iso14443AActivate() and #iso14443BActivate() to set up the
+ *  exchanges of #iso14443TransmitAndReceiveL4() and of the APDU pipe.
+ *
+ *  \param[in] dev: PICC as activated by RFAL.
+ *  \param[in] fsdi: FSDI sent to the PICC.
+ *  \param[out] act: agreed parameters, the answer is left untouched.
+ *
+ *****************************************************************************
+ */
+extern void iso14443L4SetDevice(const rfalIsoDepDevice *dev, rfalIsoDepFSxI fsdi, iso14443L4Activation_t *act);
+
 /*!
  *****************************************************************************
  *  \brief  Deselect a PICC
@@ -127,5 +207,78 @@ extern ReturnCode iso14443TransmitAndReceive(const uint8_t* txbuf,
  */
 extern ReturnCode iso14443Deselect( void );
 
+/*!
+ *****************************************************************************
+ *  \brief  Write (a part of) a command APDU to the APDU pipe
+ *
+ *  The pipe exchanges an APDU of any length with the PICC in protocol mode,
+ *  see #iso14443TransmitAndReceiveL4() for its parameters. The command APDU
+ *  is written in parts as it arrives, each I-block is sent as soon as it is
+ *  complete. The response is read with #iso14443L4PipeRead() I-block by
+ *  I-block while it is received. Neither has to fit into a buffer as a
+ *  whole, so extended length APDUs of up to 64KB can be exchanged.
+ *
+ *  The first write starts a new exchange. While it runs the RF must not be
+ *  used otherwise.
+ *
+ *  \param[in] data: next bytes of the command APDU.
+ *  \param[in] len: Number of bytes in \a data.
+ *  \param[in] last: \a data ends the command APDU.
+ *
+ *  \return ERR_BUSY : Not enough room, or response of the previous APDU
+ *                     still being read: nothing written, try again later.
+ *  \return ERR_PARAM : \a len larger than the staging buffer.
+ *  \return ERR_NONE : Data written.
+ *
+ *****************************************************************************
+ */
+extern ReturnCode iso14443L4PipeWrite(const uint8_t *data, uint16_t len, bool last);
+
+/*!
+ *****************************************************************************
+ *  \brief  Read the response APDU from the APDU pipe
+ *
+ *  Advances the exchange and hands out the received bytes, must be called
+ *  cyclically while #iso14443L4PipeIsActive().
+ *
+ *  \param[out] buf: Buffer for the next bytes of the response.
+ *  \param[in] bufLen: Size of \a buf.
+ *  \param[out] len: Number of bytes written to \a buf.
+ *
+ *  \return ERR_BUSY : Exchange ongoing, call again.
+ *  \return ERR_WRONG_STATE : No exchange active.
+ *  \return ERR_NONE : \a buf holds the end of the response, exchange done.
+ *  \return others : ISO-DEP error, exchange aborted.
+ *
+ *****************************************************************************
+ */
+extern ReturnCode iso14443L4PipeRead(uint8_t *buf, uint16_t bufLen, uint16_t *len);
+
+/*!
+ *****************************************************************************
+ *  \brief  Get the number of bytes #iso14443L4PipeWrite() can take now
+ *****************************************************************************
+ */
+extern uint16_t iso14443L4PipeTxFree(void);
+
+/*!
+ *****************************************************************************
+ *  \brief  Check whether an exchange of the APDU pipe is going on
+ *****************************************************************************
+ */
+extern bool iso14443L4PipeIsActive(void);
+
+/*!
+ *****************************************************************************
+ *  \brief  Give up the exchange of the APDU pipe
+ *
+ *  An I-block on the air is completed, then the PICC is sent S(DESELECT).
+ *  The ISO-DEP block number and chaining state are reset in any case, the
+ *  PICC has to be activated again before going on.
+ *
+ *****************************************************************************
+ */
+extern void iso14443L4PipeAbort(void);
+
 #endif /* ISO_14443_COMMON_H */
 
@@ -44,6 +44,7 @@
 ******************************************************************************
 */
 #include "platform.h"
+#include "iso14443_common.h"
 
 /*
 ******************************************************************************
@@ -54,6 +55,10 @@
 #define ISO14443A_MAX_CASCADE_LEVELS 3
 #define ISO14443A_CASCADE_LENGTH 7
 #define ISO14443A_RESPONSE_CT  0x88
+#define ISO14443A_MAX_CARDS 16 /*!< most PICCs resolved by #iso14443AResolveAll */
+
+#define ISO14443A_RESOLVE_OPT_WUPA      0x01 /*!< start with WUPA and halt every PICC resolved, wakes halted PICCs */
+#define ISO14443A_RESOLVE_OPT_HALT_LAST 0x02 /*!< halt the last PICC too, all PICCs found are halted afterwards */
 
 /*
 ******************************************************************************
@@ -162,6 +167,35 @@ extern ReturnCode iso14443ASelect(iso14443ACommand_t cmd, iso14443AProximityCard
  */
 extern ReturnCode iso14443ASendHlta(void);
 
+/*!
+ *****************************************************************************
+ *  \brief  Resolve all PICCs in the field
+ *
+ *  Runs the full collision resolution: every PICC found is selected,
+ *  halted and the remaining ones are requested again until no more
+ *  answer or \a maxCards is reached.
+ *  Without #ISO14443A_RESOLVE_OPT_WUPA it starts with REQA so PICCs halted
+ *  before are skipped, with #ISO14443A_RESOLVE_OPT_HALT_LAST all PICCs are
+ *  halted at the end. Both together report all PICCs on every call, only
+ *  #ISO14443A_RESOLVE_OPT_HALT_LAST reports the PICCs arrived since the
+ *  last call.
+ *  Only the final SAK is known, it is stored to \a sak[0].
+ *
+ *  \param[in] options : ISO14443A_RESOLVE_OPT_xxx
+ *  \param[out] cards : PICCs found
+ *  \param[in] maxCards : size of \a cards, at most #ISO14443A_MAX_CARDS
+ *  \param[out] cardsFound : number of PICCs found
+ *
+ *  \return ERR_NOTFOUND : No PICC answered.
+ *  \return ERR_PARAM : \a maxCards out of range.
+ *  \return ERR_xxx : Resolution broken off, \a cards holds the PICCs
+ *                    found so far.
+ *  \return ERR_NONE : No error.
+ *
+ *****************************************************************************
+ */
+extern ReturnCode iso14443AResolveAll(uint8_t options, iso14443AProximityCard_t* cards, uint8_t maxCards, uint8_t* cardsFound);
+
 /*!
  *****************************************************************************
  *  \brief  Enter protocol mode
@@ -208,5 +242,28 @@ extern ReturnCode iso14443AEnterProtocolMode(uint8_t fscid, uint8_t* answer, uin
  */
 extern ReturnCode iso14443ASendProtocolAndParameterSelection(uint8_t cid, uint8_t pps1);
 
+/*!
+ *****************************************************************************
+ *  \brief  Enter protocol mode at the highest common bit rate
+ *
+ *  Does #iso14443AEnterProtocolMode() and #iso14443ASendProtocolAndParameterSelection()
+ *  in one go: RATS asks the largest frame size the reader takes, then PPS
+ *  selects the highest bit rates up to \a maxBR the PICC announces in TA(1).
+ *  A failed PPS leaves the PICC at 106kbps, which is reported in \a act.
+ *  The PICC must be in ACTIVE state using #iso14443ASelect.
+ *
+ *  \param[in] maxBR : highest bit rate to use, a rfalBitRate up to RFAL_BR_848
+ *  \param[in] did : card id to assign, used only if the PICC supports it
+ *  \param[out] act : agreed parameters and ATS
+ *
+ *  \return ERR_NOTFOUND : PICC not in field or in right state.
+ *  \return ERR_PARAM : Invalid parameters.
+ *  \return ERR_IO : Error during communication.
+ *  \return ERR_NONE : No error, PICC in protocol mode.
+ *
+ *****************************************************************************
+ */
+extern ReturnCode iso14443AActivate(uint8_t maxBR, uint8_t did, iso14443L4Activation_t* act);
+
 #endif /* ISO_14443_A_H */
 
@@ -41,6 +41,7 @@
 ******************************************************************************
 */
 #include "platform.h"
+#include "iso14443_common.h"
 
 /*
 ******************************************************************************
@@ -50,6 +51,8 @@
 #define ISO14443B_PUPI_LENGTH 4
 #define ISO14443B_APPDATA_LENGTH 4
 #define ISO14443B_PROTINFO_LENGTH 3
+#define ISO14443B_ATQB_LENGTH 12 /*!< ATQB as stored in #iso14443BProximityCard_t, without collision flag */
+#define ISO14443B_MAX_CARDS 16 /*!< most PICCs resolved by #iso14443BResolveAll */
 /*
 ******************************************************************************
 * GLOBAL DATATYPES
@@ -176,6 +179,44 @@ extern ReturnCode iso14443BSelect(iso14443BCommand_t cmd,
                         uint8_t afi,
                         iso14443BSlotCount_t slotCount);
 
+/*!
+ *****************************************************************************
+ *  \brief  Resolve all PICCs in the field
+ *
+ *  Runs the slotted collision resolution: starts with WUPB opening
+ *  \a initSlots slots and sends a slot marker for each further slot. Every
+ *  PICC answering alone is recorded, the previous one is halted. As long
+ *  as collisions remain the round is repeated, with twice the slots if no
+ *  PICC answered alone, up to \a endSlots.
+ *  Starting with many slots saves rounds if several PICCs are expected,
+ *  a low \a endSlots bounds the time spent on PICCs which keep colliding.
+ *  All PICCs found are halted except the last one, which stays in state
+ *  READY_DECLARED and can be activated right away.
+ *
+ *  \param[in] afi : application family identifier (Refer to ISO14443-3)
+ *  \param[in] initSlots : slots of the first round
+ *  \param[in] endSlots : most slots of a round, at least \a initSlots
+ *  \param[out] cards : PICCs found
+ *  \param[in] maxCards : size of \a cards, at most #ISO14443B_MAX_CARDS
+ *  \param[out] cardsFound : number of PICCs found
+ *  \param[out] colPending : true if unresolved collisions are left
+ *
+ *  \return ERR_NOTFOUND : No PICC answered alone.
+ *  \return ERR_PARAM : \a maxCards or slots out of range.
+ *  \return ERR_xxx : Resolution broken off, \a cards holds the PICCs
+ *                    found so far.
+ *  \return ERR_NONE : No error.
+ *
+ *****************************************************************************
+ */
+extern ReturnCode iso14443BResolveAll(uint8_t afi,
+                        iso14443BSlotCount_t initSlots,
+                        iso14443BSlotCount_t endSlots,
+                        iso14443BProximityCard_t* cards,
+                        uint8_t maxCards,
+                        uint8_t* cardsFound,
+                        bool* colPending);
+
 /*!
  *****************************************************************************
  *  \brief  Send the HLTB command
@@ -219,5 +260,27 @@ extern ReturnCode iso14443BEnterProtocolMode(iso14443BProximityCard_t* card,
                                 iso14443BAttribParameter_t* param,
                                 iso14443BAttribAnswer_t* answer);
 
+/*!
+ *****************************************************************************
+ *  \brief  Enter protocol mode at the highest common bit rate
+ *
+ *  Sends ATTRIB asking the largest frame size the reader takes and the
+ *  highest bit rates up to \a maxBR the PICC announces in its ATQB. The
+ *  PICC must be in READY_DECLARED state using #iso14443BSelect command.
+ *
+ *  \param[in] card : the PICC as returned by #iso14443BSelect
+ *  \param[in] maxBR : highest bit rate to use, a rfalBitRate up to RFAL_BR_848
+ *  \param[in] did : card id to assign, used only if the PICC supports it
+ *  \param[out] act : agreed parameters and ATTRIB response
+ *
+ *  \return ERR_NOTFOUND : PICC not in field or in right state.
+ *  \return ERR_PARAM : Invalid parameters.
+ *  \return ERR_IO : Error during communication.
+ *  \return ERR_NONE : No error, PICC in protocol mode.
+ *
+ *****************************************************************************
+ */
+extern ReturnCode iso14443BActivate(const iso14443BProximityCard_t* card, uint8_t maxBR, uint8_t did, iso14443L4Activation_t* act);
+
 #endif /* ISO_14443_B_H */
 
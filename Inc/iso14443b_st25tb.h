@@ -48,6 +48,8 @@
 ******************************************************************************
 */
 #define ISO14443B_ST25TB_UIDSIZE 8
+#define ISO14443B_ST25TB_BLOCKSIZE 4    /*!< bytes of one block */
+#define ISO14443B_ST25TB_MAX_TAGS 16    /*!< tags resolved by #iso14443B_ST25TB_DumpInit() */
 /*
 ******************************************************************************
 * GLOBAL DATATYPES
@@ -66,6 +68,26 @@ typedef struct
                         otherwise no collision occured */
 }iso14443B_ST25TB_t;
 
+/*!
+ * State of a memory dump of all tags in the field, see #iso14443B_ST25TB_DumpChunk().
+ */
+typedef struct
+{
+    iso14443B_ST25TB_t tags[ISO14443B_ST25TB_MAX_TAGS]; /*!< tags resolved, Chip_ID and UID */
+    uint8_t numTags;        /*!< tags resolved */
+    uint8_t tag;            /*!< index of the tag being read */
+    uint8_t firstBlock;     /*!< first block read of each tag */
+    uint8_t lastBlock;      /*!< last block read of each tag */
+    uint16_t nextBlock;     /*!< next block of the current tag */
+    bool selected;          /*!< current tag has been selected */
+    bool complete;          /*!< send Completion after a tag has been read */
+    uint8_t attempts;       /*!< failed attempts of the current block */
+    uint8_t tagsFailed;     /*!< tags given up before their last block */
+    uint16_t frames;        /*!< read requests sent */
+    uint16_t retries;       /*!< read requests repeated */
+    uint32_t bytes;         /*!< bytes read */
+} iso14443B_ST25TB_Dump_t;
+
 /*
 ******************************************************************************
 * GLOBAL FUNCTION PROTOTYPES
@@ -237,4 +259,70 @@ ReturnCode iso14443B_ST25TB_Write_block(uint8_t address, const uint8_t wdata[4])
  */
 ReturnCode iso14443B_ST25TB_SingulateAndGetUID(iso14443B_ST25TB_t *card);
 
+/*!
+ *****************************************************************************
+ *  \brief  Resolve all tags in the field
+ *
+ *  Runs the Initiate/Pcall16/Slot_marker anticollision until no more
+ *  collisions are seen or \a maxCards tags are found. Every tag found gets
+ *  selected to read its UID, so all but the last are left Deselected.
+ *
+ *  \param[out] cards : Chip_ID and UID of the tags found.
+ *  \param[in] maxCards : size of \a cards, 1..#ISO14443B_ST25TB_MAX_TAGS.
+ *  \param[out] cardsFound : number of tags found.
+ *
+ *  \return ERR_PARAM : \a maxCards out of range.
+ *  \return ERR_NOTFOUND : No tag in the field.
+ *  \return ERR_NONE : No error.
+ *
+ *****************************************************************************
+ */
+ReturnCode iso14443B_ST25TB_ResolveAll(iso14443B_ST25TB_t *cards, uint8_t maxCards, uint8_t *cardsFound);
+
+/*!
+ *****************************************************************************
+ *  \brief  Resolve all tags in the field for a memory dump
+ *
+ *  Runs the Initiate/Pcall16/Slot_marker anticollision until no more
+ *  collisions are seen or \a maxTags tags are found. The tags stay in
+ *  Deselected state and are addressed by their Chip_ID afterwards.
+ *
+ *  \param[out] dump : state to initialize.
+ *  \param[in] firstBlock : first block read of each tag.
+ *  \param[in] lastBlock : last block read of each tag, must exist on all tags.
+ *  \param[in] maxTags : most tags resolved, 1..#ISO14443B_ST25TB_MAX_TAGS.
+ *  \param[in] complete : send Completion after a tag has been read so it
+ *                        keeps silent until the field is reset.
+ *
+ *  \return ERR_PARAM : Invalid block range or tag count.
+ *  \return ERR_NOTFOUND : No tag in the field.
+ *  \return ERR_NONE : No error.
+ *
+ *****************************************************************************
+ */
+ReturnCode iso14443B_ST25TB_DumpInit(iso14443B_ST25TB_Dump_t *dump, uint8_t firstBlock, uint8_t lastBlock, uint8_t maxTags, bool complete);
+
+/*!
+ *****************************************************************************
+ *  \brief  Read the next chunk of a memory dump
+ *
+ *  Selects the tags one after the other and reads as many blocks of the
+ *  current one as fit \a rxBuf. A failed block is retried after selecting
+ *  the tag again, up to 2 times; then the rest of the tag is skipped.
+ *
+ *  \param[in,out] dump: state set up by #iso14443B_ST25TB_DumpInit().
+ *  \param[out] rxBuf: data of the chunk.
+ *  \param[in] rxBufLen: size of \a rxBuf.
+ *  \param[out] tag: index into dump->tags of the tag read.
+ *  \param[out] startBlock: first block of the chunk.
+ *  \param[out] numBlocks: blocks read, may be 0 if a tag was skipped.
+ *
+ *  \return ERR_BUSY : Chunk read, more to come.
+ *  \return ERR_NONE : Last chunk read.
+ *  \return ERR_NOMEM : \a rxBuf cannot take a block.
+ *
+ *****************************************************************************
+ */
+ReturnCode iso14443B_ST25TB_DumpChunk(iso14443B_ST25TB_Dump_t *dump, uint8_t *rxBuf, uint16_t rxBufLen, uint8_t *tag, uint8_t *startBlock, uint8_t *numBlocks);
+
 #endif /* ISO_14443_B_ST25TB_H */
@@ -76,6 +76,15 @@
 
 #define ISO15693_RESP_FLAG_ERROR          0x01
 #define ISO15693_RESP_FLAG_PROT_EXTENSION 0x08
+
+#define ISO15693_MULTI_INV_OPT_16_SLOTS   0x01 /*!< multi round inventory: 16 slots per inventory instead of 1 */
+#define ISO15693_MULTI_INV_OPT_STAY_QUIET 0x02 /*!< multi round inventory: quiet found PICCs instead of partitioning by mask */
+#define ISO15693_MULTI_INV_OPT_AFI        0x04 /*!< multi round inventory: only PICCs matching the given AFI */
+#define ISO15693_MULTI_INV_OPT_ADAPTIVE   0x08 /*!< multi round inventory: choose slot count and mask depth from the estimated population */
+
+#define ISO15693_SIM_MAX_TAGS             1024 /*!< largest simulated PICC population */
+
+#define ISO15693_DUMP_MAX_CHUNK_BLOCKS      64 /*!< most blocks asked by one read request of a dump */
 /*
 ******************************************************************************
 * GLOBAL DATATYPES
@@ -130,6 +139,44 @@ typedef enum
     ISO15693_NUM_SLOTS_16 /*!< 16 slots */
 }iso15693NumSlots_t;
 
+/*!
+ * state of a multi round inventory, see #iso15693MultiInventoryRound
+ */
+typedef struct
+{
+    uint8_t options; /*!< ISO15693_MULTI_INV_OPT_xxx */
+    uint8_t afi; /*!< AFI used with #ISO15693_MULTI_INV_OPT_AFI */
+    uint8_t depth; /*!< mask length of the current partition in nibbles */
+    uint8_t mask[ISO15693_UID_LENGTH]; /*!< mask of the current partition */
+    bool done; /*!< no more rounds needed */
+    bool slots16; /*!< last round used 16 slots */
+    bool estimated; /*!< \a estimate is valid */
+    uint16_t estimate; /*!< estimated population, see #ISO15693_MULTI_INV_OPT_ADAPTIVE */
+    uint16_t expected; /*!< PICCs expected to answer the last round */
+    uint8_t errors; /*!< rounds which failed */
+    uint16_t rounds; /*!< rounds run so far */
+    uint16_t found; /*!< PICCs returned so far */
+    uint16_t quiets; /*!< Stay Quiet commands sent so far */
+    uint32_t frames; /*!< inventory requests and slot EOFs sent so far */
+}iso15693MultiInventory_t;
+
+/*!
+ * state of a memory dump, see #iso15693DumpChunk
+ */
+typedef struct
+{
+    iso15693ProximityCard_t card; /*!< PICC dumped, only the UID is used */
+    bool fast; /*!< use ST Fast Read Multiple Blocks */
+    uint16_t numBlocks; /*!< blocks of the PICC */
+    uint8_t blockSize; /*!< bytes per block */
+    uint8_t chunkBlocks; /*!< blocks asked per request, halved on failures, doubled on success */
+    uint8_t attempts; /*!< failed attempts of the current chunk */
+    uint16_t nextBlock; /*!< first block of the next chunk */
+    uint16_t frames; /*!< requests sent */
+    uint16_t retries; /*!< requests repeated */
+    uint32_t bytes; /*!< bytes read */
+}iso15693Dump_t;
+
 /*
 ******************************************************************************
 * GLOBAL FUNCTION PROTOTYPES
@@ -180,6 +227,7 @@ extern ReturnCode iso15693Deinitialize(uint8_t keep_on);
  *  \return ERR_COLLISION : Collision which couldn't be resolved.
  *  \return ERR_NOTFOUND : No PICC could be selected.
  *  \return ERR_IO : Error during communication.
+ *  \return ERR_SYSTEM : GP timer timing a silent slot did not expire.
  *  \return ERR_NONE : No error.
  *
  *****************************************************************************
@@ -191,6 +239,116 @@ extern ReturnCode iso15693Inventory(iso15693NumSlots_t slotcnt,
                     uint8_t maxCards,
                     uint8_t* cardsFound);
 
+/*!
+ *****************************************************************************
+ *  \brief  Perform an ISO15693 inventory with AFI.
+ *  Same as #iso15693Inventory but only PICCs matching \a afi answer.
+ *  \param[in] afi : AFI to send, NULL to address PICCs of all families
+ *  \return see #iso15693Inventory
+ *****************************************************************************
+ */
+extern ReturnCode iso15693InventoryAfi(iso15693NumSlots_t slotcnt,
+                    const uint8_t* afi,
+                    uint8_t maskLength,
+                    uint8_t* mask,
+                    iso15693ProximityCard_t* cards,
+                    uint8_t maxCards,
+                    uint8_t* cardsFound);
+
+/*!
+ *****************************************************************************
+ *  \brief  Start a multi round inventory.
+ *  A multi round inventory reads PICC populations of any size in rounds
+ *  of at most the card buffer size. Either found PICCs are sent to quiet
+ *  state and the inventory is repeated until nobody answers anymore, or
+ *  the UID space is partitioned by mask, splitting every partition which
+ *  fills the card buffer into 16 sub-partitions.
+ *  With #ISO15693_MULTI_INV_OPT_ADAPTIVE the population is estimated from
+ *  the PICCs read and the empty and collided slots seen. Each round then
+ *  uses 1 or 16 slots and is narrowed by mask so that its partition is
+ *  expected to fit the card buffer, also when quieting PICCs.
+ *  \note With #ISO15693_MULTI_INV_OPT_STAY_QUIET the field is switched off
+ *  shortly to release PICCs quieted before.
+ *  \param[out] inv : state to initialize
+ *  \param[in] options : ISO15693_MULTI_INV_OPT_xxx
+ *  \param[in] afi : AFI used with #ISO15693_MULTI_INV_OPT_AFI
+ *  \return ERR_PARAM : \a inv is NULL.
+ *  \return ERR_NONE : No error.
+ *****************************************************************************
+ */
+extern ReturnCode iso15693MultiInventoryInit(iso15693MultiInventory_t *inv, uint8_t options, uint8_t afi);
+
+/*!
+ *****************************************************************************
+ *  \brief  Run the next round of a multi round inventory.
+ *  \param[in,out] inv : state set up by #iso15693MultiInventoryInit
+ *  \param[out] cards : buffer array where newly found PICCs are stored.
+ *  \param[in] maxCards : size of \a cards
+ *  \param[out] cardsFound : number of PICCs found in this round.
+ *  \return ERR_BUSY : More rounds are needed.
+ *  \return ERR_NONE : Inventory finished.
+ *****************************************************************************
+ */
+extern ReturnCode iso15693MultiInventoryRound(iso15693MultiInventory_t *inv,
+                    iso15693ProximityCard_t* cards,
+                    uint8_t maxCards,
+                    uint8_t* cardsFound);
+
+/*!
+ *****************************************************************************
+ *  \brief  Start dumping the whole memory of a PICC.
+ *  Reads the system information of the PICC to learn its memory size.
+ *  \param[out] dump : state to initialize
+ *  \param[in] uid : UID of the PICC
+ *  \param[in] allowFast : use Fast Read Multiple Blocks on ST PICCs
+ *  \return ERR_NOTSUPP : PICC does not report its memory size.
+ *  \return ERR_xxx : Reading the system information failed.
+ *  \return ERR_NONE : No error.
+ *****************************************************************************
+ */
+extern ReturnCode iso15693DumpInit(iso15693Dump_t *dump, const uint8_t *uid, bool allowFast);
+
+/*!
+ *****************************************************************************
+ *  \brief  Read the next chunk of a dump.
+ *  Reads as many blocks as fit \a rxBuf, at most
+ *  #ISO15693_DUMP_MAX_CHUNK_BLOCKS. A failed chunk is retried with half the
+ *  blocks up to 3 times, each chunk read doubles the blocks again.
+ *  \param[in,out] dump : state set up by #iso15693DumpInit
+ *  \param[out] rxBuf : response flags followed by the data of the chunk,
+ *                      2 more bytes are needed for the CRC
+ *  \param[in] rxBufLen : size of \a rxBuf
+ *  \param[out] startBlock : first block of the chunk
+ *  \param[out] numBlocks : blocks read, 0 on error
+ *  \return ERR_BUSY : Chunk read, more to come.
+ *  \return ERR_NONE : Last chunk read.
+ *  \return ERR_NOMEM : \a rxBuf cannot take a block.
+ *  \return ERR_xxx : Chunk could not be read.
+ *****************************************************************************
+ */
+extern ReturnCode iso15693DumpChunk(iso15693Dump_t *dump, uint8_t *rxBuf, uint16_t rxBufLen, uint16_t *startBlock, uint8_t *numBlocks);
+
+/*!
+ *****************************************************************************
+ *  \brief  Let a simulated PICC population answer inventories.
+ *  Inventories and Stay Quiet are answered by \a numTags PICCs with UIDs
+ *  derived from \a seed instead of using the RF, the air time they would
+ *  take is modelled. Other commands are not affected.
+ *  \param[in] numTags : population size, at most #ISO15693_SIM_MAX_TAGS.
+ *                       0 switches back to the RF.
+ *  \param[in] seed : seed of the UIDs
+ *****************************************************************************
+ */
+extern void iso15693SetSimulation(uint16_t numTags, uint32_t seed);
+
+/*!
+ *****************************************************************************
+ *  \brief  Get modelled air time spent by the simulated PICC population
+ *  \return air time in us since #iso15693SetSimulation
+ *****************************************************************************
+ */
+extern uint32_t iso15693GetSimulationAirTime(void);
+
 /*!
  *****************************************************************************
  *  \brief  Send command 'stay quiet' to given PICC.
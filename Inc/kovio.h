@@ -67,6 +67,22 @@ typedef struct
     uint8_t uid[KOVIO_UID_LENGTH]; /*<! UID of the PICC */
 }kovioProximityCard_t;
 
+/*!
+ * Burst timing of a Kovio tag learnt by #kovioCaptureRead(), so that
+ * the receiver is opened right before the next burst.
+ */
+typedef struct
+{
+    uint32_t lastEndUs;     /*!< getUs() at the end of the last burst seen */
+    uint32_t periodUs;      /*!< measured burst period */
+    uint16_t burstBits;     /*!< length of the last complete burst, 0 before the first one */
+    bool     synced;        /*!< lastEndUs is valid */
+    uint16_t reads;         /*!< bursts received with valid CRC */
+    uint16_t crcErrors;     /*!< complete bursts with wrong CRC */
+    uint16_t partial;       /*!< bursts joined after their start */
+    uint16_t misses;        /*!< windows without a burst */
+}kovioCapture_t;
+
 /*
 ******************************************************************************
 * GLOBAL FUNCTION PROTOTYPES
@@ -113,4 +129,37 @@ extern ReturnCode kovioDeinitialize(uint8_t keep_on);
  */
 extern ReturnCode kovioRead(kovioProximityCard_t *card);
 
+/*!
+ *****************************************************************************
+ *  \brief  Start a capture without knowledge of the tag timing
+ *
+ *  \param[out] cap : capture state to initialize.
+ *
+ *****************************************************************************
+ */
+extern void kovioCaptureInit(kovioCapture_t *cap);
+
+/*!
+ *****************************************************************************
+ *  \brief  Receive the next burst of a Kovio tag in sync with its timing
+ *
+ *  The end of every burst received, even if it was joined late, fixes the
+ *  phase of the tag; complete bursts one period apart refine the period.
+ *  Once synchronized, the receiver is opened shortly before the next burst
+ *  is due instead of listening for a whole period. The CRC is checked right
+ *  after each burst and a bad one is repeated with the next burst, the
+ *  field stays on all the time.
+ *
+ *  \param[in,out] cap : capture state, see #kovioCaptureInit().
+ *  \param[out] card : code received.
+ *
+ *  \return ERR_NOTFOUND : no kovio barcode tag was found
+ *  \return ERR_CRC : only bursts with wrong CRC were received
+ *  \return ERR_FRAMING : code of unexpected length
+ *  \return ERR_NONE : No error.
+ *
+ *****************************************************************************
+ */
+extern ReturnCode kovioCaptureRead(kovioCapture_t *cap, kovioProximityCard_t *card);
+
 #endif /* KOVIO_H */
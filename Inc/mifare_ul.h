@@ -44,6 +44,55 @@
 ******************************************************************************
 */
 #include "platform.h"
+#include "coroutine.h"
+
+/*
+******************************************************************************
+* GLOBAL DEFINES
+******************************************************************************
+*/
+#define MIFARE_UL_PAGE_SIZE      4  /*!< bytes per page                       */
+#define MIFARE_UL_VERSION_LEN    8  /*!< length of the GET_VERSION response    */
+#define MIFARE_UL_UID_LEN        7  /*!< double size UID of all NTAG/Ultralight */
+
+/*
+******************************************************************************
+* GLOBAL DATATYPES
+******************************************************************************
+*/
+/*!
+ * Context of a running #mifareUlReadNBytesCo(). Caller fills in the
+ * parameters, the remaining members are private to the coroutine.
+ */
+typedef struct
+{
+    uint8_t startAddr;      /*!< Address of the first page to read out. */
+    uint8_t* readbuf;       /*!< Buffer with size \a length for the result. */
+    uint8_t length;         /*!< Number of bytes to read out. */
+    uint8_t* actLength;     /*!< Number of bytes actually read. */
+
+    coroutine_t co;         /*!< private: running transceive */
+    uint8_t txbuf[2];       /*!< private: READ command */
+    uint8_t rxbuf[16];      /*!< private: READ response */
+    uint16_t actrxlength;   /*!< private: length of READ response */
+} mifareUlReadContext_t;
+
+/*!
+ * State of a whole tag read, see #mifareUlDumpChunk().
+ */
+typedef struct
+{
+    uint8_t version[MIFARE_UL_VERSION_LEN]; /*!< GET_VERSION response, 0 if not supported */
+    uint8_t uid[MIFARE_UL_UID_LEN]; /*!< UID read from page 0 and 1, selected again after a NAK */
+    bool fast;              /*!< read with FAST_READ, else with READ */
+    uint16_t numPages;      /*!< pages of the tag */
+    uint16_t nextPage;      /*!< first page of the next chunk */
+    uint8_t chunkPages;     /*!< most pages asked per request, halved on failures, doubled on success */
+    uint8_t attempts;       /*!< failed attempts of the current chunk */
+    uint16_t frames;        /*!< read requests sent */
+    uint16_t retries;       /*!< read requests repeated */
+    uint32_t bytes;         /*!< bytes read */
+} mifareUlDump_t;
 
 /*
 ******************************************************************************
@@ -77,6 +126,23 @@
  */
 extern ReturnCode mifareUlReadNBytes(uint8_t startAddr, uint8_t* readbuf, uint8_t length, uint8_t* actLength);
 
+/*!
+ *****************************************************************************
+ *  \brief  Read out a given number of bytes from a MIFARE UL PICC (coroutine).
+ *
+ *  Same as #mifareUlReadNBytes() but yields at each READ command instead of
+ *  blocking, see rfal_coroutine.h. Can be given to #rfalCoroutineStart().
+ *
+ *  \param[in] co: control block of the coroutine.
+ *  \param[in,out] arg: a #mifareUlReadContext_t holding the parameters.
+ *
+ *  \return ERR_BUSY : Still running, call again.
+ *  \return others : as #mifareUlReadNBytes().
+ *
+ *****************************************************************************
+ */
+extern ReturnCode mifareUlReadNBytesCo(coroutine_t *co, void *arg);
+
 /*!
  *****************************************************************************
  *  \brief  Write a page of a MIFARE UL PICC.
@@ -99,5 +165,51 @@ extern ReturnCode mifareUlReadNBytes(uint8_t startAddr, uint8_t* readbuf, uint8_
  */
 extern ReturnCode mifareUlWritePage(uint8_t pageAddr, const uint8_t* writebuf);
 
+/*!
+ *****************************************************************************
+ *  \brief  Start reading a whole NTAG/Ultralight PICC.
+ *
+ *  Reads the UID from page 0 and 1, then sends GET_VERSION to learn the
+ *  memory size. PICCs answering it are read with FAST_READ, others
+ *  (MIFARE UL, UL C) with READ assuming 16 pages. As the NAK to an unknown
+ *  command halts the PICC, it is woken by WUPA and selected by this UID
+ *  again, so another PICC in the field is never read instead.
+ *  \note PICC must be in ACTIVE state using #iso14443ASelect
+ *
+ *  \param[out] dump: state to initialize.
+ *  \param[in] allowFast: use FAST_READ if the PICC supports it.
+ *
+ *  \return ERR_NOTFOUND : PICC lost.
+ *  \return ERR_xxx : UID could not be read.
+ *  \return ERR_NONE : No error.
+ *
+ *****************************************************************************
+ */
+extern ReturnCode mifareUlDumpInit(mifareUlDump_t *dump, bool allowFast);
+
+/*!
+ *****************************************************************************
+ *  \brief  Read the next chunk of a whole tag read.
+ *
+ *  FAST_READ asks as many pages as fit \a rxBuf, READ returns 4 pages.
+ *  A failed chunk is retried with half the pages after selecting the PICC
+ *  by its UID again, up to 3 times, each chunk read doubles the pages again.
+ *
+ *  \param[in,out] dump: state set up by #mifareUlDumpInit().
+ *  \param[out] rxBuf: data of the chunk, 2 more bytes are needed for the CRC.
+ *  \param[in] rxBufLen: size of \a rxBuf.
+ *  \param[out] startPage: first page of the chunk.
+ *  \param[out] numPages: pages read, 0 on error.
+ *
+ *  \return ERR_BUSY : Chunk read, more to come.
+ *  \return ERR_NONE : Last chunk read.
+ *  \return ERR_NOMEM : \a rxBuf cannot take a READ response.
+ *  \return ERR_NOTFOUND : PICC lost, none with its UID answers.
+ *  \return ERR_xxx : Chunk could not be read.
+ *
+ *****************************************************************************
+ */
+extern ReturnCode mifareUlDumpChunk(mifareUlDump_t *dump, uint8_t *rxBuf, uint16_t rxBufLen, uint16_t *startPage, uint8_t *numPages);
+
 #endif /* MIFARE_UL_H */
 
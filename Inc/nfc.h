@@ -99,6 +99,14 @@
 */
 #include "platform.h"
 
+/*
+******************************************************************************
+* GLOBAL DEFINES
+******************************************************************************
+*/
+#define NFC_DEP_PIPE_LEN     1024U  /*!< bytes staged for sending and received bytes buffered by the NFC-DEP pipe */
+#define NFC_DEP_BR_HIGHEST   0xFFU  /*!< desired bit rate of nfcDepInitiatorHandleActivation(): highest possible */
+
 /*
 ******************************************************************************
 * GLOBAL FUNCTION PROTOTYPES
@@ -224,11 +232,15 @@ extern ReturnCode nfcRxNBytes(uint8_t *bitrate, uint8_t *buf, uint16_t bufsize,
  *  This will transmit the given Data through NFC-DEP protocol, performing if
  *  required the necessary retransmissions and error handling.
  *  NFC-DEP header will be prepended to the given data before transmission.
+ *  Data not fitting into one frame is chained (MI) over several ones.
+ *  Starts a new exchange of the NFC-DEP pipe, see #nfcDepPipeWrite().
  *
  *
  *  \param[in] buf : Buffer/Data to be transmitted.
- *  \param[in] bufSize : Number of bytes to be transmitted (= length of \a buf).
+ *  \param[in] bufSize : Number of bytes to be transmitted (= length of \a buf),
+ *                       at most #NFC_DEP_PIPE_LEN.
  *
+ *  \return ERR_PARAM : \a bufSize too large.
  *  \return ERR_IO: Error during communication
  *  \return ERR_NONE : No error.
  *****************************************************************************
@@ -241,7 +253,9 @@ extern ReturnCode nfcDepTx( const uint8_t *buf, uint16_t bufSize );
  *
  *  Checks the status of an ongoing NFC-DEP data reception. If the data
  *  reception is completed then the received data will be stored in \a buf.
- *  The NFC-DEP header will be removed before returning to the caller
+ *  The NFC-DEP header will be removed before returning to the caller.
+ *  A chained answer is handed out in parts as it is received, each with
+ *  ERR_AGAIN, the last one with ERR_NONE.
  *
  *  \param[out] buf    : Pointer to memory area where received Data will be stored.
  *  \param[in] bufsize : Max. number of bytes to receive (= length of \a buf).
@@ -254,6 +268,7 @@ extern ReturnCode nfcDepTx( const uint8_t *buf, uint16_t bufSize );
  *    reception failed. \a buf may still contain valid data.
  *  \return ERR_INTERNAL : Timeout while waiting for the CAT, CAC, or OSC interrupt.
  *  \return ERR_BUSY : Reception in progress.
+ *  \return ERR_AGAIN : \a buf holds a part of the answer, call again.
  *  \return ERR_IO : Error during communication.
  *  \return ERR_NONE : No error.
  *
@@ -261,6 +276,89 @@ extern ReturnCode nfcDepTx( const uint8_t *buf, uint16_t bufSize );
  */
 extern ReturnCode nfcDepRx( uint8_t *buf, uint16_t bufsize, uint16_t *actlen );
 
+/*!
+ *****************************************************************************
+ *  \brief  Write to the NFC-DEP pipe
+ *
+ *  The pipe exchanges data of any length with the peer once NFC-DEP is
+ *  activated, in initiator as well as in target role. The outgoing data is
+ *  written in parts as it arrives, each DEP frame is sent as soon as it is
+ *  complete, chained with MI as long as \a last has not been given. The
+ *  answer is read with #nfcDepPipeRead() frame by frame while it is
+ *  received. Neither has to fit into a buffer as a whole.
+ *
+ *  The first write starts a new exchange. While it runs the RF must not be
+ *  used otherwise.
+ *
+ *  \param[in] data: next bytes to be sent.
+ *  \param[in] len: Number of bytes in \a data.
+ *  \param[in] last: \a data ends the outgoing data.
+ *
+ *  \return ERR_BUSY : Not enough room, or answer of the previous exchange
+ *                     still being read: nothing written, try again later.
+ *  \return ERR_PARAM : \a len larger than #NFC_DEP_PIPE_LEN.
+ *  \return ERR_NONE : Data written.
+ *
+ *****************************************************************************
+ */
+extern ReturnCode nfcDepPipeWrite( const uint8_t *data, uint16_t len, bool last );
+
+/*!
+ *****************************************************************************
+ *  \brief  Read the answer from the NFC-DEP pipe
+ *
+ *  Advances the exchange and hands out the received bytes.
+ *
+ *  \param[out] buf: Buffer for the next bytes of the answer.
+ *  \param[in] bufLen: Size of \a buf.
+ *  \param[out] len: Number of bytes written to \a buf.
+ *
+ *  \return ERR_BUSY : Exchange ongoing, call again.
+ *  \return ERR_WRONG_STATE : No exchange active.
+ *  \return ERR_NONE : \a buf holds the end of the answer, exchange done.
+ *  \return others : NFC-DEP error, exchange aborted.
+ *
+ *****************************************************************************
+ */
+extern ReturnCode nfcDepPipeRead( uint8_t *buf, uint16_t bufLen, uint16_t *len );
+
+/*!
+ *****************************************************************************
+ *  \brief  Advance the exchange of the NFC-DEP pipe
+ *
+ *  Must be called cyclically while #nfcDepPipeIsActive(), so frames keep
+ *  flowing while the host is busy. An error is reported by the next
+ *  #nfcDepPipeRead().
+ *
+ *****************************************************************************
+ */
+extern void nfcDepPipeWorker( void );
+
+/*!
+ *****************************************************************************
+ *  \brief  Get the number of bytes #nfcDepPipeWrite() can take now
+ *****************************************************************************
+ */
+extern uint16_t nfcDepPipeTxFree( void );
+
+/*!
+ *****************************************************************************
+ *  \brief  Check whether an exchange of the NFC-DEP pipe is going on
+ *****************************************************************************
+ */
+extern bool nfcDepPipeIsActive( void );
+
+/*!
+ *****************************************************************************
+ *  \brief  Give up the exchange of the NFC-DEP pipe
+ *
+ *  The peer is left within the exchange, deselect or release it before
+ *  going on.
+ *
+ *****************************************************************************
+ */
+extern void nfcDepPipeAbort( void );
+
 /*!
  *****************************************************************************
  *  \brief NFC-DEP Initiator Handle Activation
@@ -273,7 +371,8 @@ extern ReturnCode nfcDepRx( uint8_t *buf, uint16_t bufsize, uint16_t *actlen );
  *  \param[in]  nfcid3 : NFCID to be used on the ATR_REQ
  *  \param[in]  desiredBitRate : the bitrate that should be used for the
  *                              following communications (if supported
- *                              by both devices)
+ *                              by both devices), #NFC_DEP_BR_HIGHEST for
+ *                              424kbps which every target supports
  *  \param[in]  gbLen :  General bytes length
  *  \param[in]  gb    :  General bytes
  *  \param[out] currentBitRate :  actual bitrate after activation
@@ -0,0 +1,163 @@
+/******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2016 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+/*
+ *      PROJECT:   ST25R3911 firmware
+ *      $Revision: $
+ *      LANGUAGE:  ANSI C
+ */
+
+/*! \file
+ *
+ *  \brief Buffers of a chained exchange streamed between host and RF
+ *
+ *  Used by the ISO-DEP and the NFC-DEP pipe. The outgoing data is staged
+ *  as the host writes it and each frame is taken from its front as soon
+ *  as it is complete, so the peer receives while the host is still
+ *  writing. The INF of the received frames is appended to a ring which
+ *  the host reads while further frames arrive.
+ *
+ *  The protocol only takes the next frame when #rfPipeRxFree() can hold
+ *  it. Until then the peer waits for the ACK of the previous one, so a
+ *  slow host throttles the peer instead of overflowing the ring.
+ *
+ */
+
+#ifndef RF_PIPE_H
+#define RF_PIPE_H
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include "platform.h"
+
+/*
+******************************************************************************
+* GLOBAL DATATYPES
+******************************************************************************
+*/
+/*!
+ * State of a pipe, the buffers are set by the owner once
+ */
+typedef struct
+{
+    bool     active;        /*!< an exchange is going on                         */
+    bool     running;       /*!< a frame exchange is started                     */
+    bool     txChaining;    /*!< the running frame is not the last one           */
+    bool     txLast;        /*!< the end of the outgoing data has been written   */
+    bool     rxDone;        /*!< the last frame of the answer was received       */
+    uint8_t  *txBuf;        /*!< staging buffer                                  */
+    uint16_t txSize;        /*!< size of \a txBuf                                */
+    uint16_t txLen;         /*!< bytes staged                                    */
+    uint8_t  *rxBuf;        /*!< ring buffer                                     */
+    uint16_t rxSize;        /*!< size of \a rxBuf                                */
+    uint16_t rxHead;        /*!< ring position written next                      */
+    uint16_t rxTail;        /*!< ring position read next                         */
+    uint16_t rxUsed;        /*!< bytes in the ring                               */
+}rfPipe_t;
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ *  \brief  Stage outgoing data.
+ *  The first write after the pipe went inactive starts a new exchange.
+ *  \param[in] pipe : the pipe
+ *  \param[in] data : data to append
+ *  \param[in] len : length of \a data
+ *  \param[in] last : \a data ends the outgoing data
+ *  \return ERR_PARAM : \a len larger than the staging buffer.
+ *  \return ERR_BUSY : Nothing staged, not enough room or the answer of
+ *                     the previous exchange is not read yet.
+ *  \return ERR_NONE : No error.
+ *****************************************************************************
+ */
+extern ReturnCode rfPipeStage(rfPipe_t *pipe, const uint8_t *data, uint16_t len, bool last);
+
+/*!
+ *****************************************************************************
+ *  \brief  Get the next frame to send from the front of the staged data.
+ *  A chained frame is sent once it can be filled completely, the last one
+ *  once the end of the data has been written.
+ *  \param[in] pipe : the pipe
+ *  \param[in] maxInf : longest INF of a frame
+ *  \param[out] len : INF length of the frame
+ *  \param[out] chaining : more frames follow
+ *  \return true if a frame can be sent, false to wait for more data
+ *****************************************************************************
+ */
+extern bool rfPipeNextFrame(const rfPipe_t *pipe, uint16_t maxInf, uint16_t *len, bool *chaining);
+
+/*!
+ *****************************************************************************
+ *  \brief  Drop sent data from the front of the staging buffer.
+ *  \param[in] pipe : the pipe
+ *  \param[in] len : bytes to drop
+ *****************************************************************************
+ */
+extern void rfPipeDrop(rfPipe_t *pipe, uint16_t len);
+
+/*!
+ *****************************************************************************
+ *  \brief  Append the INF of a received frame to the ring.
+ *  \param[in] pipe : the pipe
+ *  \param[in] data : INF
+ *  \param[in] len : length of \a data, at most #rfPipeRxFree()
+ *****************************************************************************
+ */
+extern void rfPipeQueue(rfPipe_t *pipe, const uint8_t *data, uint16_t len);
+
+/*!
+ *****************************************************************************
+ *  \brief  Take received data from the ring.
+ *  The exchange ends once the last frame was received and read.
+ *  \param[in] pipe : the pipe
+ *  \param[out] buf : buffer for the data
+ *  \param[in] bufLen : size of \a buf
+ *  \param[out] len : bytes written to \a buf
+ *  \return ERR_BUSY : More data follows.
+ *  \return ERR_NONE : All data is read, the pipe is inactive again.
+ *****************************************************************************
+ */
+extern ReturnCode rfPipeRead(rfPipe_t *pipe, uint8_t *buf, uint16_t bufLen, uint16_t *len);
+
+/*!
+ *****************************************************************************
+ *  \brief  Get the room left in the ring.
+ *  \return bytes #rfPipeQueue() can take
+ *****************************************************************************
+ */
+extern uint16_t rfPipeRxFree(const rfPipe_t *pipe);
+
+/*!
+ *****************************************************************************
+ *  \brief  Get the room left in the staging buffer.
+ *  \return bytes #rfPipeStage() can take, all if the pipe is inactive
+ *****************************************************************************
+ */
+extern uint16_t rfPipeTxFree(const rfPipe_t *pipe);
+
+#endif /* RF_PIPE_H */
@@ -0,0 +1,151 @@
+/******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2016 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+/*
+ *      PROJECT:   ST25R3911 firmware
+ *      $Revision: $
+ *      LANGUAGE:  ANSI C
+ */
+
+/*! \file
+ *
+ *  \brief Cooperative execution of RFAL based protocol operations
+ *
+ *  Protocol operations written as coroutines (see coroutine.h) yield at
+ *  every transceive instead of spinning rfalWorker(). One such operation
+ *  can be started in the background with #rfalCoroutineStart() and is
+ *  advanced by #rfalCoroutineWorker() from the main loop, so the stream
+ *  layer keeps receiving and answering packets while the RF work runs.
+ *
+ */
+
+#ifndef RFAL_COROUTINE_H
+#define RFAL_COROUTINE_H
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include "platform.h"
+#include "coroutine.h"
+
+/*
+******************************************************************************
+* GLOBAL DATATYPES
+******************************************************************************
+*/
+
+/*! Coroutine function run by #rfalCoroutineWorker(), \a arg is passed as given to #rfalCoroutineStart() */
+typedef ReturnCode (*rfalCoroutineFunc)( coroutine_t *co, void *arg );
+
+/*
+******************************************************************************
+* GLOBAL MACROS
+******************************************************************************
+*/
+
+/*! Suspends coroutine \a co for \a ms milliseconds, \a tmr must be kept in the coroutine's context */
+#define RFAL_CO_DELAY(co, tmr, ms)                                             \
+    do { (tmr) = platformTimerCreate(ms); CO_WAIT_WHILE(co, !platformTimerIsExpired(tmr)); } while (0)
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ *  \brief  Transceive a frame without blocking
+ *
+ *  Coroutine counterpart of #rfalTransceiveBlockingTxRx() with the same
+ *  parameters. The first call starts the transceive, every following call
+ *  returns ERR_BUSY until the transceive has finished.
+ *  Use it through CO_AWAIT(). All pointers must stay valid until it finished.
+ *
+ *  \param[in]  co       : control block of this child coroutine
+ *  \param[in]  txBuf    : data to be transmitted
+ *  \param[in]  txBufLen : number of bytes to be transmitted
+ *  \param[out] rxBuf    : buffer for the received data
+ *  \param[in]  rxBufLen : size of \a rxBuf in bytes
+ *  \param[out] actLen   : number of bytes received
+ *  \param[in]  flags    : transceive flags, see #rfalTransceiveContext
+ *  \param[in]  fwt      : frame waiting time in 1/fc
+ *
+ *  \return ERR_BUSY : Transceive ongoing, call again.
+ *  \return ERR_xxx  : Result of the transceive as by #rfalGetTransceiveStatus().
+ *
+ *****************************************************************************
+ */
+extern ReturnCode rfalCoTransceiveTxRx( coroutine_t *co, uint8_t* txBuf, uint16_t txBufLen, uint8_t* rxBuf, uint16_t rxBufLen, uint16_t* actLen, uint32_t flags, uint32_t fwt );
+
+/*!
+ *****************************************************************************
+ *  \brief  Start a protocol operation in the background
+ *
+ *  Only one operation may run at a time.
+ *
+ *  \param[in] func : coroutine to be run.
+ *  \param[in] arg  : context passed to \a func on each call, must stay valid
+ *                    until the operation finished.
+ *
+ *  \return ERR_BUSY  : Another operation is still running.
+ *  \return ERR_PARAM : \a func is NULL.
+ *  \return ERR_NONE  : Operation started.
+ *
+ *****************************************************************************
+ */
+extern ReturnCode rfalCoroutineStart( rfalCoroutineFunc func, void *arg );
+
+/*!
+ *****************************************************************************
+ *  \brief  Advance the background operation
+ *
+ *  Resumes the background operation once. Must be called cyclically from
+ *  the main loop, which runs rfalWorker() as well.
+ *
+ *****************************************************************************
+ */
+extern void rfalCoroutineWorker( void );
+
+/*!
+ *****************************************************************************
+ *  \brief  Get status of the background operation
+ *
+ *  \return ERR_BUSY : Operation is still running.
+ *  \return ERR_xxx  : Result of the last finished operation.
+ *
+ *****************************************************************************
+ */
+extern ReturnCode rfalCoroutineGetStatus( void );
+
+/*!
+ *****************************************************************************
+ *  \brief  Abandon the background operation
+ *
+ *  The operation is not resumed anymore. A transceive already started
+ *  completes on its own by FWT. Status becomes ERR_INTERNAL.
+ *
+ *****************************************************************************
+ */
+extern void rfalCoroutineAbort( void );
+
+#endif /* RFAL_COROUTINE_H */
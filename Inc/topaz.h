@@ -44,6 +44,7 @@
 ******************************************************************************
 */
 #include "platform.h"
+#include "coroutine.h"
 
 /*
 ******************************************************************************
@@ -52,6 +53,10 @@
 */
 #define TOPAZ_UID_LENGTH 4
 #define TOPAZ_HR_LENGTH 2
+#define TOPAZ_BLOCK_LENGTH 8        /*!< bytes of one block */
+#define TOPAZ_SEGMENT_LENGTH 128    /*!< bytes read by one RSEG */
+#define TOPAZ_STATIC_MEM_SIZE 120   /*!< blocks 0x0..0xE of a static memory tag as read by RALL */
+#define TOPAZ_MAX_MEM_SIZE 2048     /*!< largest dynamic memory, 16 segments */
 
 /*
 ******************************************************************************
@@ -86,6 +91,21 @@ typedef enum
     TOPAZ_CMD_WRITE_NE= 0x1a, /*!< command Write, no erase */
 }topazCommand_t;
 
+/*!
+ * Context of a running #topazReadAllCo(). Caller fills in the
+ * parameters, the remaining members are private to the coroutine.
+ */
+typedef struct
+{
+    const topazProximityCard_t* card; /*!< PICC to read, holds the UID. */
+    uint8_t* buf;           /*!< Buffer where the complete memory should be put. */
+    uint16_t bufSize;       /*!< Size of \a buf. */
+    uint16_t* actSize;      /*!< Size actually received. */
+
+    coroutine_t co;         /*!< private: running transceive */
+    uint8_t txbuf[3 + TOPAZ_UID_LENGTH]; /*!< private: RALL command */
+} topazReadAllContext_t;
+
 /*
 ******************************************************************************
 * GLOBAL FUNCTION PROTOTYPES
@@ -176,6 +196,23 @@ extern ReturnCode topazReadUID(topazProximityCard_t* card);
  */
 extern ReturnCode topazReadAll(const topazProximityCard_t* card, uint8_t *buf, uint16_t buf_size, uint16_t* act_size);
 
+/*!
+ *****************************************************************************
+ *  \brief  Read the memory from a tag in READY state (coroutine)
+ *
+ *  Same as #topazReadAll() but yields while the RALL is ongoing instead of
+ *  blocking, see rfal_coroutine.h. Can be given to #rfalCoroutineStart().
+ *
+ *  \param[in] co: control block of the coroutine.
+ *  \param[in,out] arg: a #topazReadAllContext_t holding the parameters.
+ *
+ *  \return ERR_BUSY : Still running, call again.
+ *  \return others : as #topazReadAll().
+ *
+ *****************************************************************************
+ */
+extern ReturnCode topazReadAllCo(coroutine_t *co, void *arg);
+
 /*!
  *****************************************************************************
  *  \brief  Write one byte of memory to a tag in READY state
@@ -195,5 +232,113 @@ extern ReturnCode topazReadAll(const topazProximityCard_t* card, uint8_t *buf, u
  */
 extern ReturnCode topazWriteByte(topazProximityCard_t* card, uint8_t addr, uint8_t data);
 
+/*!
+ *****************************************************************************
+ *  \brief  Read one segment of a dynamic memory tag (RSEG)
+ *
+ *  \param[in] card : Parameter of type #topazProximityCard_t which holds
+ *                the UID of the card to read.
+ *  \param[in] segment : segment to be read, 0..15
+ *  \param[out] buf : #TOPAZ_SEGMENT_LENGTH bytes read
+ *
+ *  \return ERR_TIMEOUT : Timeout waiting for interrupts or no reply from cards.
+ *  \return ERR_PROTO : Unexpected response.
+ *  \return ERR_NONE : No error.
+ *
+ *****************************************************************************
+ */
+extern ReturnCode topazReadSegment(const topazProximityCard_t* card, uint8_t segment, uint8_t *buf);
+
+/*!
+ *****************************************************************************
+ *  \brief  Read one block of a dynamic memory tag (READ8)
+ *
+ *  \param[in] card : Parameter of type #topazProximityCard_t which holds
+ *                the UID of the card to read.
+ *  \param[in] block : block to be read
+ *  \param[out] buf : #TOPAZ_BLOCK_LENGTH bytes read
+ *
+ *  \return ERR_TIMEOUT : Timeout waiting for interrupts or no reply from cards.
+ *  \return ERR_PROTO : Unexpected response.
+ *  \return ERR_NONE : No error.
+ *
+ *****************************************************************************
+ */
+extern ReturnCode topazReadBlock(const topazProximityCard_t* card, uint8_t block, uint8_t *buf);
+
+/*!
+ *****************************************************************************
+ *  \brief  Write one block of a dynamic memory tag (WRITE-E8 / WRITE-NE8)
+ *
+ *  \param[in] card : Parameter of type #topazProximityCard_t which holds
+ *                the UID of the card to write.
+ *  \param[in] block : block to be written
+ *  \param[in] data : #TOPAZ_BLOCK_LENGTH bytes to be written
+ *  \param[in] erase : false ORs \a data to the block without erasing it.
+ *
+ *  \return ERR_TIMEOUT : Timeout waiting for interrupts or no reply from cards.
+ *  \return ERR_PROTO : Response does not match the data written.
+ *  \return ERR_NONE : No error.
+ *
+ *****************************************************************************
+ */
+extern ReturnCode topazWriteBlock(const topazProximityCard_t* card, uint8_t block, const uint8_t *data, bool erase);
+
+/*!
+ *****************************************************************************
+ *  \brief  Read the whole memory of a tag with the fewest frames
+ *
+ *  RID tells the memory structure from HR0. Static memory tags are read
+ *  by one RALL. Dynamic memory tags are read segment by segment with RSEG,
+ *  the size is taken from the capability container in block 1 if present,
+ *  else 512 bytes (Topaz 512) are assumed.
+ *
+ *  \param[in,out] card : holds the UID of the card to read, gets its HR.
+ *  \param[out] buf : memory content from byte 0 on.
+ *  \param[in] bufSize : size of \a buf.
+ *  \param[out] actSize : bytes read.
+ *  \param[out] frames : commands sent, RID included.
+ *
+ *  \return ERR_NOTFOUND : No card with this UID answered.
+ *  \return ERR_NOMEM : \a buf cannot take the memory, \a actSize bytes are valid.
+ *  \return ERR_TIMEOUT : Timeout waiting for interrupts or no reply from cards.
+ *  \return ERR_NONE : No error.
+ *
+ *****************************************************************************
+ */
+extern ReturnCode topazReadMemory(topazProximityCard_t* card, uint8_t *buf, uint16_t bufSize, uint16_t *actSize, uint8_t *frames);
+
+/*!
+ *****************************************************************************
+ *  \brief  Write consecutive blocks of a tag with the fewest frames
+ *
+ *  RID tells the memory structure from HR0. Dynamic memory tags are written
+ *  a block per frame, static memory tags a byte per frame with WRITE-E.
+ *  The blocks have to lie within the memory: 0x0..0xE of a static tag, as
+ *  far as the capability container of a dynamic tag tells (read with READ8
+ *  of block 1), else 512 bytes. The UID block 0x0, the reserved blocks 0xD
+ *  and 0xF and the lock and OTP block 0xE are written only if \a lockOtp is
+ *  set; lock bits located by a Lock Control TLV are not checked.
+ *
+ *  \param[in,out] card : holds the UID of the card to write, gets its HR.
+ *  \param[in] firstBlock : first block to be written.
+ *  \param[in] data : data to be written.
+ *  \param[in] len : length of \a data, multiple of #TOPAZ_BLOCK_LENGTH.
+ *  \param[in] erase : false ORs \a data to the memory without erasing it,
+ *                   dynamic memory tags only.
+ *  \param[in] lockOtp : allow writing the UID, reserved, lock and OTP blocks.
+ *  \param[out] frames : commands sent, RID and READ8 included.
+ *
+ *  \return ERR_PARAM : \a len is not a multiple of #TOPAZ_BLOCK_LENGTH, the
+ *                      blocks go past the memory or are protected.
+ *  \return ERR_NOTFOUND : No card with this UID answered.
+ *  \return ERR_NOTSUPP : Write without erase to a static memory tag.
+ *  \return ERR_PROTO : Response does not match the data written.
+ *  \return ERR_NONE : No error.
+ *
+ *****************************************************************************
+ */
+extern ReturnCode topazWriteMemory(topazProximityCard_t* card, uint8_t firstBlock, const uint8_t *data, uint16_t len, bool erase, bool lockOtp, uint8_t *frames);
+
 #endif /* TOPAZ_H */
 
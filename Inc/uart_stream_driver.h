@@ -64,7 +64,8 @@ typedef enum {
  *  This function takes care for proper initialisation of buffers, variables, etc.
  *
  *  \param rxBuf : buffer where received packets will be copied into
- *  \param txBuf : buffer where to be transmitted packets will be copied into
+ *  \param txBuf : buffer where to be transmitted packets will be copied into,
+ *  ST_STREAM_TX_HEADROOM bytes in front of it must be available as well
  *****************************************************************************
  */
 void uartStreamInitialize (uint8_t * rxBuf, uint8_t * txBuf);
@@ -85,9 +86,10 @@ void uartStreamDisconnect(void);
 
 /*!
  *****************************************************************************
- *  \brief  returns 1 if stream init is finished
+ *  \brief  returns 1 if stream init is finished and no transmission is pending
  *
- *  \return 0=init has not finished yet, 1=stream has been initialized
+ *  \return 0=init has not finished yet or txBuf is still being transmitted,
+ *  1=stream has been initialized and txBuf may be written
  *****************************************************************************
  */
 uint8_t uartStreamReady(void);
@@ -131,12 +133,10 @@ uint16_t uartStreamReceive (void);
  *  \brief checks if there is data to be transmitted from the UART device to
  *  the host.
  *
- *  Checks if there is data waiting to be transmitted to the host. Copies this
- *  data from a local buffer to the uart buffer and transmits this buffer.
- *  If more than 1 uart report is needed to transmit the data, the function
- *  waits until the first one is sent, and than refills the uart buffer with
- *  the next chunk of data and transmits the buffer again. And so on, until
- *  all data is sent.
+ *  Checks if there is data waiting to be transmitted to the host. The UART
+ *  header is written into the ST_STREAM_TX_HEADROOM in front of txBuf and
+ *  header plus data are transmitted by DMA in place, without copying.
+ *  txBuf must not be written until #uartStreamReady() returns 1 again.
  *
  *  \param [in] totalTxSize: the size of the data to be transmitted (the UART
  *  header is not included)
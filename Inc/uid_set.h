@@ -0,0 +1,151 @@
+/******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2016 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+/*
+ *      PROJECT:   ST25R3911 firmware
+ *      $Revision: $
+ *      LANGUAGE:  ANSI C
+ */
+
+/*! \file
+ *
+ *  \brief Set of recently seen UIDs with time to live
+ *
+ *  Keeps track of the PICCs seen by continuous scanning so that only
+ *  arrivals and departures have to be reported. A PICC is not stored by
+ *  its UID but by a 32 bit fingerprint, see #uidSetFingerprint(): the
+ *  technology in its top 3 bits and 29 bits of a hash over technology and
+ *  UID below. With the 16 bit time the PICC was last seen an entry takes
+ *  6 bytes in an open addressed table with linear probing, so insert and
+ *  lookup take constant time and the 1024 slots need 6 KB.
+ *
+ *  PICCs of a technology whose hashes agree in all 29 bits are taken for
+ *  the same PICC; among the 896 PICCs the set holds at most that happens
+ *  with a probability below 1/1000.
+ *
+ *  Entries not seen for longer than the TTL are removed by #uidSetExpire()
+ *  which sweeps a few slots per call and returns the fingerprints of the
+ *  departed PICCs. The host knows their UIDs from the arrival reports and
+ *  computes the same fingerprints. A PICC seen again after its TTL but
+ *  before it was swept is reported as arriving again without a departure.
+ *
+ */
+
+#ifndef UID_SET_H
+#define UID_SET_H
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include "platform.h"
+
+/*
+******************************************************************************
+* GLOBAL DEFINES
+******************************************************************************
+*/
+#define UID_SET_SIZE          1024U   /*!< slots of the table, power of 2                   */
+#define UID_SET_MAX_ENTRIES   (UID_SET_SIZE - (UID_SET_SIZE / 8)) /*!< load limit of 7/8   */
+#define UID_SET_TICK_SHIFT    4U      /*!< time is kept in units of 2^4 ms                  */
+#define UID_SET_MAX_TTL_MS    0x7FFFFUL /*!< largest TTL, half the range of the 16 bit ticks */
+#define UID_SET_MAX_UID_LEN   10U     /*!< longest UID: triple size NFCID1                  */
+#define UID_SET_FP_TECH_SHIFT 29U     /*!< technology is kept in the top bits of a fingerprint */
+
+#define UID_SET_FP_TECH(fp)   ((uint8_t)((fp) >> UID_SET_FP_TECH_SHIFT)) /*!< UID_SET_TECH_xxx of fingerprint \a fp */
+
+#define UID_SET_TECH_ISO15693    1U   /*!< 64 bit UID                    */
+#define UID_SET_TECH_NFCA        2U   /*!< 4, 7 or 10 byte NFCID1        */
+#define UID_SET_TECH_NFCB        3U   /*!< 4 byte NFCID0                 */
+#define UID_SET_TECH_FELICA      4U   /*!< 8 byte IDm                    */
+#define UID_SET_TECH_ST25TB      5U   /*!< 8 byte UID                    */
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ *  \brief  Clear the set and set the time to live of its entries.
+ *  \param[in] ttlMs : time in ms after which a PICC not seen again has
+ *                     departed, at most #UID_SET_MAX_TTL_MS.
+ *  \return ERR_PARAM : \a ttlMs too large.
+ *  \return ERR_NONE : No error.
+ *****************************************************************************
+ */
+extern ReturnCode uidSetInit(uint32_t ttlMs);
+
+/*!
+ *****************************************************************************
+ *  \brief  Record that a PICC was seen.
+ *  Inserts the PICC or refreshes its entry.
+ *  \param[in] tech : UID_SET_TECH_xxx
+ *  \param[in] uid : UID as received
+ *  \param[in] uidLen : length of \a uid, must match \a tech
+ *  \param[in] nowMs : current time in ms
+ *  \param[out] arrived : true if the PICC was not in the set, may be NULL
+ *  \return ERR_PARAM : Unknown technology or wrong UID length.
+ *  \return ERR_NOMEM : Set holds #UID_SET_MAX_ENTRIES PICCs already.
+ *  \return ERR_NONE : No error.
+ *****************************************************************************
+ */
+extern ReturnCode uidSetSeen(uint8_t tech, const uint8_t *uid, uint8_t uidLen, uint32_t nowMs, bool *arrived);
+
+/*!
+ *****************************************************************************
+ *  \brief  Remove departed PICCs.
+ *  Checks the next \a maxSlots slots of the table, wrapping around at its
+ *  end, and removes the entries older than the TTL. Every slot has to be
+ *  checked at least once per 2^19 ms for the 16 bit timestamps not to wrap.
+ *  \param[in] nowMs : current time in ms
+ *  \param[in] maxSlots : slots to check
+ *  \param[out] departed : fingerprints of the departed PICCs
+ *  \param[in] maxDeparted : size of \a departed, checking stops when it is full
+ *  \return number of fingerprints written to \a departed
+ *****************************************************************************
+ */
+extern uint16_t uidSetExpire(uint32_t nowMs, uint16_t maxSlots, uint32_t *departed, uint16_t maxDeparted);
+
+/*!
+ *****************************************************************************
+ *  \brief  Get the fingerprint a PICC is stored by.
+ *  FNV-1a over the technology byte followed by the UID, then the murmur3
+ *  finalizer: h ^= h >> 16; h *= 0x85EBCA6B; h ^= h >> 13; h *= 0xC2B2AE35;
+ *  h ^= h >> 16. The fingerprint is (tech << 29) | (h & 0x1FFFFFFF).
+ *  \param[in] tech : UID_SET_TECH_xxx
+ *  \param[in] uid : UID as received
+ *  \param[in] uidLen : length of \a uid
+ *  \return the fingerprint, never 0
+ *****************************************************************************
+ */
+extern uint32_t uidSetFingerprint(uint8_t tech, const uint8_t *uid, uint8_t uidLen);
+
+/*!
+ *****************************************************************************
+ *  \brief  Get the number of PICCs in the set.
+ *  \return number of entries
+ *****************************************************************************
+ */
+extern uint16_t uidSetCount(void);
+
+#endif /* UID_SET_H */
@@ -47,6 +47,25 @@
 */
 #include "platform.h"
 
+/*
+******************************************************************************
+* GLOBAL DEFINES
+******************************************************************************
+*/
+#define RFAL_CRC_ENGINE_BITWISE   0   /*!< Byte wise shift/XOR calculation, the reference           */
+#define RFAL_CRC_ENGINE_TABLE     1   /*!< Table driven slice-by-8 calculation (4kB table in RAM)   */
+#define RFAL_CRC_ENGINE_HW        2   /*!< STM32 CRC peripheral                                     */
+
+/*! CRC engine used by rfalCrcCalculateCcitt(), may be given by the build. Defaults to the CRC  *
+ *  peripheral if the target has a programmable one, else to the table driven engine           */
+#ifndef RFAL_CRC_ENGINE
+    #if defined(CRC) && defined(CRC_CR_POLYSIZE)
+        #define RFAL_CRC_ENGINE   RFAL_CRC_ENGINE_HW
+    #else
+        #define RFAL_CRC_ENGINE   RFAL_CRC_ENGINE_TABLE
+    #endif
+#endif
+
 /*
 ******************************************************************************
 * GLOBAL FUNCTION PROTOTYPES
@@ -71,5 +90,23 @@
  */
 extern uint16_t rfalCrcCalculateCcitt(uint16_t preloadValue, const uint8_t* buf, uint16_t length);
 
+/*! 
+ *****************************************************************************
+ *  \brief  Calculate CRC according to CCITT standard, reference implementation.
+ *
+ *  Same as rfalCrcCalculateCcitt() but always uses the byte wise
+ *  calculation, regardless of #RFAL_CRC_ENGINE. Used to verify and
+ *  benchmark the selected engine.
+ *
+ *  \param[in] preloadValue : Initial value of CRC calculation.
+ *  \param[in] buf : buffer to calculate the CRC for.
+ *  \param[in] length : size of the buffer.
+ *
+ *  \return 16 bit long crc value.
+ *
+ *****************************************************************************
+ */
+extern uint16_t rfalCrcCalculateCcittBitwise(uint16_t preloadValue, const uint8_t* buf, uint16_t length);
+
 #endif /* RFAL_CRC_H_ */
 
@@ -539,6 +539,19 @@ typedef enum
     RFAL_WUM_STATE_ENABLED               = 0x01,     /*!< Wake-Up mode is enabled                     */
     RFAL_WUM_STATE_ENABLED_WOKE          = 0x02,     /*!< Wake-Up mode enabled and has received IRQ(s)*/
 } rfalWumState;
+
+
+/*! FIFO water level statistics, see rfalGetFIFOStats()                                       */
+typedef struct
+{
+    uint16_t txReloads;     /*!< Tx FIFO refills on water level                                */
+    uint16_t txNearMiss;    /*!< Tx refills with the FIFO (almost) run empty                   */
+    uint16_t txUnderflow;   /*!< Tx ended before the FIFO was refilled                         */
+    uint16_t rxReads;       /*!< Rx FIFO reads on water level                                  */
+    uint16_t rxNearMiss;    /*!< Rx reads with the FIFO (almost) full                          */
+    uint16_t rxOverflow;    /*!< Rx FIFO overflowed before it was read                         */
+    uint16_t latencyMaxUs;  /*!< Longest water level service latency seen, estimated in us    */
+} rfalFIFOStats;
 /*******************************************************************************/
 
 /*
@@ -887,6 +900,34 @@ void rfalSetFDTPoll( uint32_t fdt );
 uint32_t rfalGetFDTPoll( void );
 
 
+/*! 
+ *****************************************************************************
+ * \brief  RFAL Get FIFO Statistics
+ *  
+ * Gets the counters of the FIFO water level handling. The water levels are
+ * chosen before each transceive from bit rate, frame length and the measured
+ * latency with which water level interrupts are serviced. A near miss is
+ * a water level serviced with the FIFO (almost) empty on Tx or (almost) full
+ * on Rx.
+ *
+ * \param[out]  stats : location to copy the statistics to
+ *
+ *****************************************************************************
+ */
+void rfalGetFIFOStats( rfalFIFOStats *stats );
+
+
+/*! 
+ *****************************************************************************
+ * \brief  RFAL Clear FIFO Statistics
+ *  
+ * Resets the counters returned by rfalGetFIFOStats()
+ *
+ *****************************************************************************
+ */
+void rfalClearFIFOStats( void );
+
+
 /*! 
  *****************************************************************************
  * \brief  RFAL Set FDT Listen
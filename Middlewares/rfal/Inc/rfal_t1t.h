@@ -69,6 +69,9 @@
  */
 #define RFAL_T1T_UID_LEN               4   /*!< T1T UID length of cascade level 1 only tag  */
 #define RFAL_T1T_HR_LENGTH             2   /*!< T1T HR(Header ROM) length                   */
+#define RFAL_T1T_BLOCK_LEN             8   /*!< T1T block length                            */
+#define RFAL_T1T_SEGMENT_LEN         128   /*!< T1T segment length, 16 blocks               */
+#define RFAL_T1T_MAX_SEGMENTS         16   /*!< T1T segments addressable by ADDS            */
 
 #define RFAL_T1T_HR0_NDEF_MASK      0xF0   /*!< T1T HR0 NDEF capability mask  T1T 1.2 2.2.2 */
 #define RFAL_T1T_HR0_NDEF_SUPPORT   0x10   /*!< T1T HR0 NDEF capable value    T1T 1.2 2.2.2 */
@@ -81,7 +84,11 @@ typedef enum
     RFAL_T1T_CMD_RALL     = 0x00,          /*!< T1T Read All                                */
     RFAL_T1T_CMD_READ     = 0x01,          /*!< T1T Read                                    */
     RFAL_T1T_CMD_WRITE_E  = 0x53,          /*!< T1T Write with erase (single byte)          */
-    RFAL_T1T_CMD_WRITE_NE = 0x1A           /*!< T1T Write with no erase (single byte)       */
+    RFAL_T1T_CMD_WRITE_NE = 0x1A,          /*!< T1T Write with no erase (single byte)       */
+    RFAL_T1T_CMD_RSEG     = 0x10,          /*!< T1T Read Segment                            */
+    RFAL_T1T_CMD_READ8    = 0x02,          /*!< T1T Read 8 bytes (one block)                */
+    RFAL_T1T_CMD_WRITE_E8 = 0x54,          /*!< T1T Write with erase (one block)            */
+    RFAL_T1T_CMD_WRITE_NE8= 0x1B           /*!< T1T Write with no erase (one block)         */
 } rfalT1Tcmds;
 
 
@@ -176,6 +183,71 @@ ReturnCode rfalT1TPollerRall( uint8_t* uid, uint8_t* rxBuf, uint16_t rxBufLen, u
  */
 ReturnCode rfalT1TPollerWrite( uint8_t* uid, uint8_t address, uint8_t data );
 
+
+/*!
+ *****************************************************************************
+ * \brief  NFC-A T1T Poller RSEG
+ *
+ * This method reads one segment (16 blocks) of a NFC-A T1T Listener device
+ * with dynamic memory structure
+ *
+ *
+ * \param[in]   uid       : the UID of the device to read data
+ * \param[in]   segment   : segment to be read, 0..15
+ * \param[out]  segData   : pointer to place the RFAL_T1T_SEGMENT_LEN bytes read
+ *
+ * \return ERR_WRONG_STATE  : RFAL not initialized or mode not set
+ * \return ERR_PARAM        : Invalid parameter
+ * \return ERR_PROTO        : Response of unexpected length or segment
+ * \return ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalT1TPollerRseg( uint8_t* uid, uint8_t segment, uint8_t* segData );
+
+
+/*!
+ *****************************************************************************
+ * \brief  NFC-A T1T Poller READ8
+ *
+ * This method reads one block of a NFC-A T1T Listener device with dynamic
+ * memory structure
+ *
+ *
+ * \param[in]   uid       : the UID of the device to read data
+ * \param[in]   block     : block to be read
+ * \param[out]  blockData : pointer to place the RFAL_T1T_BLOCK_LEN bytes read
+ *
+ * \return ERR_WRONG_STATE  : RFAL not initialized or mode not set
+ * \return ERR_PARAM        : Invalid parameter
+ * \return ERR_PROTO        : Response of unexpected length or block
+ * \return ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalT1TPollerRead8( uint8_t* uid, uint8_t block, uint8_t* blockData );
+
+
+/*!
+ *****************************************************************************
+ * \brief  NFC-A T1T Poller WRITE-E8 / WRITE-NE8
+ *
+ * This method writes one block of a NFC-A T1T Listener device with dynamic
+ * memory structure. Without erase the bits set in \a blockData are ORed
+ * to the block in about half the time.
+ *
+ *
+ * \param[in]   uid       : the UID of the device to write data
+ * \param[in]   block     : block to be written
+ * \param[in]   blockData : the RFAL_T1T_BLOCK_LEN bytes to be written
+ * \param[in]   erase     : true: WRITE-E8, false: WRITE-NE8
+ *
+ * \return ERR_WRONG_STATE  : RFAL not initialized or mode not set
+ * \return ERR_PARAM        : Invalid parameter
+ * \return ERR_PROTO        : Response does not echo block and data
+ * \return ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalT1TPollerWrite8( uint8_t* uid, uint8_t block, const uint8_t* blockData, bool erase );
+
 #endif /* RFAL_T1T_H */
 
 /**
@@ -32,6 +32,10 @@
  *
  *  \brief CRC calculation implementation
  *
+ *  rfalCrcCalculateCcitt() uses the engine selected by #RFAL_CRC_ENGINE.
+ *  The engines are not reentrant (table initialisation, CRC peripheral)
+ *  and must not be used from interrupt context.
+ *
  */
 
 /*
@@ -40,6 +44,26 @@
 ******************************************************************************
 */
 #include "rfal_crc.h"
+#include "utils.h"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define RFAL_CRC_SLICES         8   /*!< Bytes processed per step by the table driven engine */
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+#if (RFAL_CRC_ENGINE == RFAL_CRC_ENGINE_TABLE)
+static uint16_t rfalCrcTable[RFAL_CRC_SLICES][256];    /*!< rfalCrcTable[k][i]: CRC of i followed by k zero bytes */
+static bool     rfalCrcTableValid;
+#elif (RFAL_CRC_ENGINE == RFAL_CRC_ENGINE_HW)
+static bool     rfalCrcHwValid;
+#endif
 
 /*
 ******************************************************************************
@@ -47,6 +71,11 @@
 ******************************************************************************
 */
 static uint16_t rfalCrcUpdateCcitt(uint16_t crc, uint8_t dat);
+#if (RFAL_CRC_ENGINE == RFAL_CRC_ENGINE_TABLE)
+static uint16_t rfalCrcCalculateCcittTable(uint16_t preloadValue, const uint8_t* buf, uint16_t length);
+#elif (RFAL_CRC_ENGINE == RFAL_CRC_ENGINE_HW)
+static uint16_t rfalCrcCalculateCcittHw(uint16_t preloadValue, const uint8_t* buf, uint16_t length);
+#endif
 
 /*
 ******************************************************************************
@@ -54,6 +83,17 @@ static uint16_t rfalCrcUpdateCcitt(uint16_t crc, uint8_t dat);
 ******************************************************************************
 */
 uint16_t rfalCrcCalculateCcitt(uint16_t preloadValue, const uint8_t* buf, uint16_t length)
+{
+#if (RFAL_CRC_ENGINE == RFAL_CRC_ENGINE_TABLE)
+    return rfalCrcCalculateCcittTable(preloadValue, buf, length);
+#elif (RFAL_CRC_ENGINE == RFAL_CRC_ENGINE_HW)
+    return rfalCrcCalculateCcittHw(preloadValue, buf, length);
+#else
+    return rfalCrcCalculateCcittBitwise(preloadValue, buf, length);
+#endif
+}
+
+uint16_t rfalCrcCalculateCcittBitwise(uint16_t preloadValue, const uint8_t* buf, uint16_t length)
 {
     uint16_t crc = preloadValue;
     uint16_t index;
@@ -81,3 +121,88 @@ static uint16_t rfalCrcUpdateCcitt(uint16_t crc, uint8_t dat)
     return crc;
 }
 
+#if (RFAL_CRC_ENGINE == RFAL_CRC_ENGINE_TABLE)
+static uint16_t rfalCrcCalculateCcittTable(uint16_t preloadValue, const uint8_t* buf, uint16_t length)
+{
+    uint16_t crc = preloadValue;
+    uint16_t i;
+    uint8_t  k;
+
+    if (!rfalCrcTableValid)
+    {
+        for (i = 0; i < 256; i++)
+        {
+            rfalCrcTable[0][i] = rfalCrcUpdateCcitt(0, (uint8_t)i);
+        }
+        for (k = 1; k < RFAL_CRC_SLICES; k++)
+        {
+            for (i = 0; i < 256; i++)
+            {
+                rfalCrcTable[k][i] = (rfalCrcTable[k-1][i] >> 8) ^ rfalCrcTable[0][rfalCrcTable[k-1][i] & 0xFF];
+            }
+        }
+        rfalCrcTableValid = true;
+    }
+
+    /* CRC is reflected: the current value only affects the first two bytes of each slice */
+    while (length >= RFAL_CRC_SLICES)
+    {
+        crc ^= (uint16_t)(buf[0] | (buf[1] << 8));
+        crc  = rfalCrcTable[7][crc & 0xFF] ^ rfalCrcTable[6][crc >> 8] ^
+               rfalCrcTable[5][buf[2]]     ^ rfalCrcTable[4][buf[3]]   ^
+               rfalCrcTable[3][buf[4]]     ^ rfalCrcTable[2][buf[5]]   ^
+               rfalCrcTable[1][buf[6]]     ^ rfalCrcTable[0][buf[7]];
+        buf    += RFAL_CRC_SLICES;
+        length -= RFAL_CRC_SLICES;
+    }
+
+    while (length--)
+    {
+        crc = (crc >> 8) ^ rfalCrcTable[0][(crc ^ *buf++) & 0xFF];
+    }
+
+    return crc;
+}
+
+#elif (RFAL_CRC_ENGINE == RFAL_CRC_ENGINE_HW)
+static uint16_t rfalCrcCalculateCcittHw(uint16_t preloadValue, const uint8_t* buf, uint16_t length)
+{
+    uint16_t init = 0;
+    uint32_t word;
+    uint8_t  i;
+
+    if (!rfalCrcHwValid)
+    {
+        __HAL_RCC_CRC_CLK_ENABLE();
+        CRC->POL = 0x1021;
+        rfalCrcHwValid = true;
+    }
+
+    /* The peripheral shifts MSB first: reflected CRC = non reflected CRC on bit *
+     * reversed input with bit reversed preload and result                      */
+    for (i = 0; i < 16; i++)
+    {
+        init |= ((preloadValue >> i) & 1) << (15 - i);
+    }
+    CRC->INIT = init;
+
+    /* Words are reversed as a whole: the first byte in memory ends up as first, bit reversed, byte */
+    CRC->CR = (CRC_CR_POLYSIZE_0 | CRC_CR_REV_IN_0 | CRC_CR_REV_IN_1 | CRC_CR_REV_OUT | CRC_CR_RESET);
+    while (length >= sizeof(word))
+    {
+        ST_MEMCPY(&word, buf, sizeof(word));
+        CRC->DR = word;
+        buf    += sizeof(word);
+        length -= sizeof(word);
+    }
+
+    /* Remaining bytes are reversed per byte */
+    CRC->CR = (CRC_CR_POLYSIZE_0 | CRC_CR_REV_IN_0 | CRC_CR_REV_OUT);
+    while (length--)
+    {
+        *(__IO uint8_t*)&CRC->DR = *buf++;
+    }
+
+    return (uint16_t)CRC->DR;
+}
+#endif
@@ -85,6 +85,27 @@
 
 #define ISO15693_PHY_DAT_MANCHESTER_1 0xaaaa
 
+/* 1 of 4 coding: one pulse per 2 bit pair, ISO15693_DAT_00_1_4 shifted by 2 per pair value.
+ * A data byte gives 4 symbols, LSB pair first, packed little endian into 32 bits. */
+#define ISO15693_1OF4_SYM(d, n)  ((uint32_t)(ISO15693_DAT_00_1_4 << (2 * (((d) >> (2 * (n))) & 0x3))) << (8 * (n)))
+#define ISO15693_1OF4(d)         (ISO15693_1OF4_SYM(d, 0) | ISO15693_1OF4_SYM(d, 1) | ISO15693_1OF4_SYM(d, 2) | ISO15693_1OF4_SYM(d, 3))
+
+/* Manchester decoding of 4 bit pairs (8 stream bits, first pair in the LSBs) to a nibble.
+ * Pair 01b (as read: first bit in bit 0) is a 0, 10b is a 1, 00b and 11b are no valid symbols. */
+#define ISO15693_MAN_INVALID     0xFF
+#define ISO15693_MAN_PAIR(d, n)  (((d) >> (2 * (n))) & 0x3)
+#define ISO15693_MAN_VALID(d, n) ((ISO15693_MAN_PAIR(d, n) == 0x1) || (ISO15693_MAN_PAIR(d, n) == 0x2))
+#define ISO15693_MAN_BIT(d, n)   ((ISO15693_MAN_PAIR(d, n) >> 1) << (n))
+#define ISO15693_MAN(d)          ((ISO15693_MAN_VALID(d, 0) && ISO15693_MAN_VALID(d, 1) && ISO15693_MAN_VALID(d, 2) && ISO15693_MAN_VALID(d, 3)) \
+                                  ? (ISO15693_MAN_BIT(d, 0) | ISO15693_MAN_BIT(d, 1) | ISO15693_MAN_BIT(d, 2) | ISO15693_MAN_BIT(d, 3))   \
+                                  : ISO15693_MAN_INVALID)
+
+/* Expand f() for 256 consecutive byte values to initialize lookup tables */
+#define ISO15693_TABLE_4(f, d)   f(d), f((d) + 1), f((d) + 2), f((d) + 3)
+#define ISO15693_TABLE_16(f, d)  ISO15693_TABLE_4(f, d), ISO15693_TABLE_4(f, (d) + 4), ISO15693_TABLE_4(f, (d) + 8), ISO15693_TABLE_4(f, (d) + 12)
+#define ISO15693_TABLE_64(f, d)  ISO15693_TABLE_16(f, d), ISO15693_TABLE_16(f, (d) + 16), ISO15693_TABLE_16(f, (d) + 32), ISO15693_TABLE_16(f, (d) + 48)
+#define ISO15693_TABLE_256(f)    ISO15693_TABLE_64(f, 0), ISO15693_TABLE_64(f, 64), ISO15693_TABLE_64(f, 128), ISO15693_TABLE_64(f, 192)
+
 #define ISO15693_PHY_BIT_BUFFER_SIZE 1000 /*!<
                                 size of the receiving buffer. Might be adjusted
                                 if longer datastreams are expected. */
@@ -97,13 +118,24 @@
 */
 static iso15693PhyConfig_t iso15693PhyConfig; /*!< current phy configuration */
 
+/*! 1 of 4 coded symbols of each byte value, see ISO15693_1OF4() */
+static const uint32_t iso15693PhyVCDCode1Of4Table[256] =
+{
+    ISO15693_TABLE_256(ISO15693_1OF4)
+};
+
+/*! Nibble decoded from 8 Manchester stream bits or ISO15693_MAN_INVALID, see ISO15693_MAN() */
+static const uint8_t iso15693PhyManchesterTable[256] =
+{
+    ISO15693_TABLE_256(ISO15693_MAN)
+};
+
 /*
 ******************************************************************************
 * LOCAL FUNCTION PROTOTYPES
 ******************************************************************************
 */
-static ReturnCode iso15693PhyVCDCode1Of4(const uint8_t data, uint8_t* outbuf, uint16_t maxOutBufLen, uint16_t* outBufLen);
-static ReturnCode iso15693PhyVCDCode1Of256(const uint8_t data, uint8_t* outbuf, uint16_t maxOutBufLen, uint16_t* outBufLen);
+static uint16_t iso15693PhyVCDCode(const uint8_t* data, uint16_t length, uint8_t* outbuf, uint16_t outBufSize, uint16_t* outBufLen);
 
 static struct iso15693StreamConfig stream_config = {
     .useBPSK = 0, /* 0: subcarrier, 1:BPSK */
@@ -146,7 +178,7 @@ ReturnCode iso15693VCDCode(uint8_t* buffer, uint16_t length, bool sendCrc, bool
     uint8_t eof, sof;
     uint8_t transbuf[2];
     uint16_t crc = 0;
-    ReturnCode (*txFunc)(const uint8_t, uint8_t*, uint16_t, uint16_t*);
+    uint16_t filled_size;
     uint8_t crc_len;
 
     crc_len = ((sendCrc)?2:0);
@@ -157,7 +189,6 @@ ReturnCode iso15693VCDCode(uint8_t* buffer, uint16_t length, bool sendCrc, bool
     {
         sof = ISO15693_DAT_SOF_1_4;
         eof = ISO15693_DAT_EOF_1_4;
-        txFunc = iso15693PhyVCDCode1Of4;
         *subbit_total_length = (
                 ( 1  /* SOF */
                   + (length + crc_len) * 4
@@ -170,7 +201,6 @@ ReturnCode iso15693VCDCode(uint8_t* buffer, uint16_t length, bool sendCrc, bool
     {
         sof = ISO15693_DAT_SOF_1_256;
         eof = ISO15693_DAT_EOF_1_256;
-        txFunc = iso15693PhyVCDCode1Of256;
         *subbit_total_length = (
                 ( 1  /* SOF */
                   + (length + crc_len) * 64
@@ -211,39 +241,33 @@ ReturnCode iso15693VCDCode(uint8_t* buffer, uint16_t length, bool sendCrc, bool
         outbuf++;
     }
 
-    while (*offset < length && err == ERR_NONE)
+    if (*offset < length)
     {
-        uint16_t filled_size;
-        /* send data */
-        err = txFunc(buffer[*offset], outbuf, outBufSize, &filled_size);
+        /* send data: as much as fits in one pass */
+        (*offset) += iso15693PhyVCDCode(&buffer[*offset], length - *offset, outbuf, outBufSize, &filled_size);
         (*actOutBufSize) += filled_size;
         outbuf+=filled_size;
         outBufSize -= filled_size;
-        if (!err) (*offset)++;
+        if (*offset < length) return ERR_AGAIN;
     }
-    if (err) return ERR_AGAIN;
 
-    while (!err && sendCrc && *offset < length + 2)
+    if (sendCrc && *offset < length + 2)
     {
-        uint16_t filled_size;
-        if (0==crc)
-        {
-            crc = rfalCrcCalculateCcitt( ((picopassMode) ? 0xE012 : 0xFFFF),         /* In PicoPass Mode a different Preset Value is used   */
-                                         ((picopassMode) ? (buffer + 1) : buffer),   /* CMD byte is not taken into account in PicoPass mode */
-                                         ((picopassMode) ? (length - 1) : length));  /* CMD byte is not taken into account in PicoPass mode */
+        crc = rfalCrcCalculateCcitt( ((picopassMode) ? 0xE012 : 0xFFFF),         /* In PicoPass Mode a different Preset Value is used   */
+                                     ((picopassMode) ? (buffer + 1) : buffer),   /* CMD byte is not taken into account in PicoPass mode */
+                                     ((picopassMode) ? (length - 1) : length));  /* CMD byte is not taken into account in PicoPass mode */
+
+        crc = ((picopassMode) ? crc : ~crc);
 
-            crc = ((picopassMode) ? crc : ~crc);
-        }
         /* send crc */
         transbuf[0] = crc & 0xff;
         transbuf[1] = (crc >> 8) & 0xff;
-        err = txFunc(transbuf[*offset - length], outbuf, outBufSize, &filled_size);
+        (*offset) += iso15693PhyVCDCode(&transbuf[*offset - length], length + 2 - *offset, outbuf, outBufSize, &filled_size);
         (*actOutBufSize) += filled_size;
         outbuf+=filled_size;
         outBufSize -= filled_size;
-        if(!err) (*offset)++;
+        if (*offset < length + 2) return ERR_AGAIN;
     }
-    if (err) return ERR_AGAIN;
 
     if ((!sendCrc && (*offset) == length)
             || (sendCrc && (*offset) == length + 2))
@@ -297,6 +321,34 @@ ReturnCode iso15693VICCDecode(uint8_t *inBuf,
     for ( ; mp < inBufLen * 8 - 2; mp+=2 )
     {
         uint8_t man;
+
+        /* Fast path: decode 4 pairs to a nibble with one lookup. Taken only while the nibble is  *
+         * aligned in outBuf, all 4 pairs are inside the frame and fit into outBuf, so that the    *
+         * EOF check and the end of buffer check can only apply after the 4th pair, as below      */
+        if ( ((bp & 0x3) == 0) && ((mp + 6) < (inBufLen * 8 - 2)) && ((bp + 4) <= (outBufLen * 8)) )
+        {
+            man = iso15693PhyManchesterTable[ (uint8_t)((inBuf[mp >> 3] | (inBuf[(mp >> 3) + 1] << 8)) >> (mp & 0x7)) ];
+            if (ISO15693_MAN_INVALID != man)
+            {
+                outBuf[bp >> 3] |= man << (bp & 0x7);
+                bp += 4;
+                mp += 6; /* now at the 4th pair, the loop advances beyond it */
+
+                if (((bp & 0x7) == 0)
+                   && ((inBuf[mp/8]   & 0xe0) == 0xa0)
+                   && (inBuf[mp/8+1] == 0x03))
+                { /* EOF */
+                    break;
+                }
+                if (bp >= outBufLen * 8)
+                { /* Don't write beyond the end */
+                    break;
+                }
+                continue;
+            }
+        }
+
+        /* A collision or the frame end is near: one pair at a time */
         man  = (inBuf[mp/8] >> mp%8) & 0x1;
         man |= ((inBuf[(mp+1)/8] >> (mp+1)%8) & 0x1) << 1;
         if (1 == man)
@@ -382,110 +434,52 @@ out:
 */
 /*!
  *****************************************************************************
- *  \brief  Perform 1 of 4 coding and send coded data
+ *  \brief  Perform 1 of 4 or 1 of 256 coding of a block of data
  *
- *  This function takes \a length bytes from \a buffer, perform 1 of 4 coding
- *  (see ISO15693-2 specification) and sends the data using stream mode.
+ *  This function takes up to \a length bytes from \a data, performs the
+ *  coding configured in iso15693PhyConfigure() (see ISO15693-2 specification)
+ *  and writes the coded stream to \a outbuf. Only whole bytes are coded,
+ *  as many as fit into \a outBufSize.
  *
- *  \param[in] sendSof : send SOF prior to data.
- *  \param[in] buffer : data to send.
- *  \param[in] length : number of bytes to send.
+ *  \param[in] data : data to code.
+ *  \param[in] length : number of bytes in \a data.
+ *  \param[out] outbuf : buffer for the coded stream.
+ *  \param[in] outBufSize : size of \a outbuf.
+ *  \param[out] outBufLen : number of bytes written to \a outbuf.
  *
- *  \return ERR_IO : Error during communication.
- *  \return ERR_NONE : No error.
+ *  \return number of bytes of \a data coded.
  *
  *****************************************************************************
  */
-static ReturnCode iso15693PhyVCDCode1Of4(const uint8_t data, uint8_t* outbuf, uint16_t maxOutBufLen, uint16_t* outBufLen)
+static uint16_t iso15693PhyVCDCode(const uint8_t* data, uint16_t length, uint8_t* outbuf, uint16_t outBufSize, uint16_t* outBufLen)
 {
-    uint8_t tmp;
-    ReturnCode err = ERR_NONE;
-    uint16_t a;
-
-    *outBufLen = 0;
+    uint16_t n;
+    uint16_t i;
 
-    if (maxOutBufLen < 4)
-        return ERR_NOMEM;
-
-    tmp = data;
-    for (a = 0; a < 4; a++)
+    if (ISO15693_VCD_CODING_1_4 == iso15693PhyConfig.coding)
     {
-        switch (tmp & 0x3)
+        n = MIN(length, outBufSize / 4);
+        for (i = 0; i < n; i++)
         {
-            case 0:
-                *outbuf = ISO15693_DAT_00_1_4;
-                break;
-            case 1:
-                *outbuf = ISO15693_DAT_01_1_4;
-                break;
-            case 2:
-                *outbuf = ISO15693_DAT_10_1_4;
-                break;
-            case 3:
-                *outbuf = ISO15693_DAT_11_1_4;
-                break;
+            /* table entries hold the 4 symbols in memory order */
+            ST_MEMCPY(outbuf, &iso15693PhyVCDCode1Of4Table[data[i]], 4);
+            outbuf += 4;
         }
-        outbuf++;
-        (*outBufLen)++;
-        tmp >>= 2;
+        *outBufLen = n * 4;
     }
-    return err;
-}
-
-/*!
- *****************************************************************************
- *  \brief  Perform 1 of 256 coding and send coded data
- *
- *  This function takes \a length bytes from \a buffer, perform 1 of 256 coding
- *  (see ISO15693-2 specification) and sends the data using stream mode.
- *  \note This function sends SOF prior to the data.
- *
- *  \param[in] sendSof : send SOF prior to data.
- *  \param[in] buffer : data to send.
- *  \param[in] length : number of bytes to send.
- *
- *  \return ERR_IO : Error during communication.
- *  \return ERR_NONE : No error.
- *
- *****************************************************************************
- */
-static ReturnCode iso15693PhyVCDCode1Of256(const uint8_t data, uint8_t* outbuf, uint16_t maxOutBufLen, uint16_t* outBufLen)
-{
-    uint8_t tmp;
-    ReturnCode err = ERR_NONE;
-    uint16_t a;
-
-    *outBufLen = 0;
-
-    if (maxOutBufLen < 64)
-        return ERR_NOMEM;
-
-    tmp = data;
-    for (a = 0; a < 64; a++)
+    else
     {
-        switch (tmp)
+        n = MIN(length, outBufSize / 64);
+        ST_MEMSET(outbuf, 0, n * 64);
+        for (i = 0; i < n; i++)
         {
-            case 0:
-                *outbuf = ISO15693_DAT_SLOT0_1_256;
-                break;
-            case 1:
-                *outbuf = ISO15693_DAT_SLOT1_1_256;
-                break;
-            case 2:
-                *outbuf = ISO15693_DAT_SLOT2_1_256;
-                break;
-            case 3:
-                *outbuf = ISO15693_DAT_SLOT3_1_256;
-                break;
-            default:
-                *outbuf = 0;
+            /* a single pulse in the 4 slot wide group selected by the upper 6 bits */
+            outbuf[(i * 64) + (data[i] >> 2)] = (ISO15693_DAT_SLOT0_1_256 << (2 * (data[i] & 0x3)));
         }
-        outbuf++;
-        (*outBufLen)++;
-        tmp -= 4;
+        *outBufLen = n * 64;
     }
 
-    return err;
+    return n;
 }
 
 #endif /* RFAL_FEATURE_NFCV */
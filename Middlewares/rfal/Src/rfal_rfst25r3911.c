@@ -117,6 +117,9 @@ typedef struct{
     uint16_t                bytesTotal;  /*!< Total bytes to be transmitted OR the total bytes received                                  */
     uint16_t                bytesWritten;/*!< Amount of bytes already written on FIFO (Tx) OR read (RX) from FIFO and written on rxBuffer*/
     uint8_t                 status[ST25R3911_FIFO_STATUS_LEN];   /*!< FIFO Status Registers                                              */
+    uint8_t                 wl;          /*!< Water levels currently set in ST25R3911_REG_IO_CONF1 (fifo_lt | fifo_lr)                   */
+    uint16_t                latency;     /*!< Decaying peak of the water level service latency in us                                     */
+    rfalFIFOStats           stats;       /*!< Water level statistics                                                                     */
 } rfalFIFO;
 
 
@@ -215,6 +218,16 @@ typedef enum
 #define RFAL_FIFO_OUT_LT_32             (ST25R3911_FIFO_DEPTH - RFAL_FIFO_IN_LT_32)  /*!< Number of bytes sent/out of the FIFO when WL interrupt occurs while Tx ( fifo_lt: 0 ) */
 #define RFAL_FIFO_OUT_LT_16             (ST25R3911_FIFO_DEPTH - RFAL_FIFO_IN_LT_16)  /*!< Number of bytes sent/out of the FIFO when WL interrupt occurs while Tx ( fifo_lt: 1 ) */
 
+#define RFAL_FIFO_IN_LR_64              64                                           /*!< Number of bytes in the FIFO when WL interrupt occurs while Rx ( fifo_lr: 0 )    */
+#define RFAL_FIFO_IN_LR_80              80                                           /*!< Number of bytes in the FIFO when WL interrupt occurs while Rx ( fifo_lr: 1 )    */
+
+#define RFAL_FIFO_NEAR_MISS             4                                            /*!< FIFO bytes left (Tx) or free (Rx) at WL service counted as near miss            */
+#define RFAL_FIFO_LATENCY_INIT_US       250                                          /*!< Assumed WL service latency until one is measured                                */
+#define RFAL_FIFO_LATENCY_MARGIN        2                                            /*!< Factor between latency and FIFO time required for the higher water level        */
+#define RFAL_FIFO_NFCV_1_4_BYTES        4                                            /*!< FIFO bytes per NFC-V payload byte in 1 out of 4 coding                          */
+#define RFAL_FIFO_NFCV_1_256_BYTES      64                                           /*!< FIFO bytes per NFC-V payload byte in 1 out of 256 coding                        */
+#define RFAL_FIFO_NFCV_SOF_EOF_BYTES    2                                            /*!< FIFO bytes of the NFC-V SOF and EOF                                             */
+
 #define RFAL_FIFO_STATUS_REG1           0                                            /*!< Location of FIFO status register 1 in local copy                                */
 #define RFAL_FIFO_STATUS_REG2           1                                            /*!< Location of FIFO status register 2 in local copy                                */
 #define RFAL_FIFO_STATUS_INVALID        0xFF                                         /*!< Value indicating that the local FIFO status in invalid|cleared                  */
@@ -370,6 +383,9 @@ static bool rfalFIFOStatusIsMissingPar( void );
 static bool rfalFIFOStatusIsIncompleteByte( void );
 static uint8_t rfalFIFOStatusGetNumBytes( void );
 static uint8_t rfalFIFOGetNumIncompleteBits( void );
+static void rfalFIFOSetWaterLevels( void );
+static uint16_t rfalFIFOByteTimeUs( rfalBitRate br );
+static void rfalFIFOUpdateLatency( uint16_t bytes, rfalBitRate br );
 
 
 /*
@@ -398,7 +414,10 @@ ReturnCode rfalInitialize( void )
 
     /*******************************************************************************/
     /* Set FIFO Water Levels to be used */
-    st25r3911ChangeRegisterBits( ST25R3911_REG_IO_CONF1, (ST25R3911_REG_IO_CONF1_fifo_lt | ST25R3911_REG_IO_CONF1_fifo_lr), (ST25R3911_REG_IO_CONF1_fifo_lt_32bytes | ST25R3911_REG_IO_CONF1_fifo_lr_64bytes) );
+    /* Start with the levels leaving most room, rfalFIFOSetWaterLevels() adapts them per transceive */
+    gRFAL.fifo.wl      = (ST25R3911_REG_IO_CONF1_fifo_lt_32bytes | ST25R3911_REG_IO_CONF1_fifo_lr_64bytes);
+    gRFAL.fifo.latency = RFAL_FIFO_LATENCY_INIT_US;
+    st25r3911ChangeRegisterBits( ST25R3911_REG_IO_CONF1, (ST25R3911_REG_IO_CONF1_fifo_lt | ST25R3911_REG_IO_CONF1_fifo_lr), gRFAL.fifo.wl );
 
     /* Always have CRC in FIFO upon reception  */
     st25r3911SetRegisterBits( ST25R3911_REG_AUX, ST25R3911_REG_AUX_crc_2_fifo );
@@ -991,6 +1010,23 @@ uint32_t rfalGetFDTPoll( void )
 }
 
 
+/*******************************************************************************/
+void rfalGetFIFOStats( rfalFIFOStats *stats )
+{
+    if( stats != NULL )
+    {
+        ST_MEMCPY( stats, &gRFAL.fifo.stats, sizeof(rfalFIFOStats) );
+    }
+}
+
+
+/*******************************************************************************/
+void rfalClearFIFOStats( void )
+{
+    ST_MEMSET( &gRFAL.fifo.stats, 0x00, sizeof(rfalFIFOStats) );
+}
+
+
 /*******************************************************************************/
 void rfalSetFDTListen( uint32_t FDTListen )
 {
@@ -1556,6 +1592,7 @@ static void rfalTransceiveTx( void )
 {
     volatile uint32_t irqs;
     uint16_t          tmp;
+    uint16_t          wl;
     ReturnCode        ret;
 
    /* NO_WARNING(ret); */
@@ -1615,8 +1652,9 @@ static void rfalTransceiveTx( void )
             /* Clear FIFO, Clear and Enable the Interrupts */
             rfalPrepareTransceive( );
 
-            /* Calculate when Water Level Interrupt will be triggered */
-            gRFAL.fifo.expWL = ( st25r3911CheckReg( ST25R3911_REG_IO_CONF1, ST25R3911_REG_IO_CONF1_fifo_lt, ST25R3911_REG_IO_CONF1_fifo_lt_16bytes) ? RFAL_FIFO_OUT_LT_16 : RFAL_FIFO_OUT_LT_32 );
+            /* Select water levels for this frame and calculate when Water Level Interrupt will be triggered */
+            rfalFIFOSetWaterLevels();
+            gRFAL.fifo.expWL = ( ((gRFAL.fifo.wl & ST25R3911_REG_IO_CONF1_fifo_lt) == ST25R3911_REG_IO_CONF1_fifo_lt_16bytes) ? RFAL_FIFO_OUT_LT_16 : RFAL_FIFO_OUT_LT_32 );
 
         #if RFAL_FEATURE_NFCV
             /*******************************************************************************/
@@ -1694,6 +1732,8 @@ static void rfalTransceiveTx( void )
             }
             else
             {
+                /* FIFO ran empty before the water level was serviced */
+                gRFAL.fifo.stats.txUnderflow++;
                 gRFAL.TxRx.status = ERR_IO;
                 gRFAL.TxRx.state  = RFAL_TXRX_STATE_TX_FAIL;
                 break;
@@ -1704,6 +1744,22 @@ static void rfalTransceiveTx( void )
         /*******************************************************************************/
         case RFAL_TXRX_STATE_TX_RELOAD_FIFO:
 
+            /*******************************************************************************/
+            /* Measure how far the FIFO drained below the water level while waiting to be  *
+             * serviced and refill everything that is free instead of only expWL          */
+            rfalFIFOStatusClear();
+            tmp = rfalFIFOStatusGetNumBytes();
+            rfalFIFOStatusClear();
+
+            gRFAL.fifo.stats.txReloads++;
+            if( tmp <= RFAL_FIFO_NEAR_MISS )
+            {
+                gRFAL.fifo.stats.txNearMiss++;
+            }
+            wl  = ( ((gRFAL.fifo.wl & ST25R3911_REG_IO_CONF1_fifo_lt) == ST25R3911_REG_IO_CONF1_fifo_lt_16bytes) ? RFAL_FIFO_IN_LT_16 : RFAL_FIFO_IN_LT_32 );
+            rfalFIFOUpdateLatency( ((wl > tmp) ? (wl - tmp) : 0), gRFAL.txBR );
+            gRFAL.fifo.expWL = (ST25R3911_FIFO_DEPTH - tmp);
+
         #if RFAL_FEATURE_NFCV
             /*******************************************************************************/
             /* In NFC-V streaming mode, the FIFO needs to be loaded with the coded bits    */
@@ -2201,6 +2257,20 @@ static void rfalTransceiveRx( void )
             tmp = rfalFIFOStatusGetNumBytes();
             gRFAL.fifo.bytesTotal += tmp;
 
+            /*******************************************************************************/
+            /* Account how far the FIFO filled above the water level before being serviced */
+            gRFAL.fifo.stats.rxReads++;
+            if( gRFAL.fifo.status[RFAL_FIFO_STATUS_REG2] & ST25R3911_REG_FIFO_RX_STATUS2_fifo_ovr )
+            {
+                gRFAL.fifo.stats.rxOverflow++;
+            }
+            else if( tmp >= (ST25R3911_FIFO_DEPTH - RFAL_FIFO_NEAR_MISS) )
+            {
+                gRFAL.fifo.stats.rxNearMiss++;
+            }
+            aux = ( ((gRFAL.fifo.wl & ST25R3911_REG_IO_CONF1_fifo_lr) == ST25R3911_REG_IO_CONF1_fifo_lr_80bytes) ? RFAL_FIFO_IN_LR_80 : RFAL_FIFO_IN_LR_64 );
+            rfalFIFOUpdateLatency( ((tmp > aux) ? (tmp - aux) : 0), gRFAL.rxBR );
+
             /*******************************************************************************/
             /* Calculate the amount of bytes that still fits in rxBuf                      */
             aux = (( gRFAL.fifo.bytesTotal > rfalConvBitsToBytes(gRFAL.TxRx.ctx.rxBufLen) ) ? (rfalConvBitsToBytes(gRFAL.TxRx.ctx.rxBufLen) - gRFAL.fifo.bytesWritten) : tmp);
@@ -2351,6 +2421,78 @@ static uint8_t rfalFIFOGetNumIncompleteBits( void )
 }
 
 
+/*******************************************************************************/
+static uint16_t rfalFIFOByteTimeUs( rfalBitRate br )
+{
+    /* ~75us per byte at 106kbps halving with each bit rate step. NFC-V/PicoPass *
+     * stream coded data through the FIFO, treat them like 106kbps               */
+    if( br <= RFAL_BR_6780 )
+    {
+        return MAX( (75 >> br), 1 );
+    }
+    return 75;
+}
+
+
+/*******************************************************************************/
+static void rfalFIFOUpdateLatency( uint16_t bytes, rfalBitRate br )
+{
+    uint16_t us;
+
+    /* bytes moved through the FIFO beyond the water level while waiting for service */
+    us = (bytes * rfalFIFOByteTimeUs( br ));
+
+    gRFAL.fifo.stats.latencyMaxUs = MAX( gRFAL.fifo.stats.latencyMaxUs, us );
+
+    /* Peak follower with slow decay: a single slow service takes effect at once */
+    gRFAL.fifo.latency = MAX( us, (gRFAL.fifo.latency - (gRFAL.fifo.latency >> 3)) );
+}
+
+
+/*******************************************************************************/
+static void rfalFIFOSetWaterLevels( void )
+{
+    uint8_t  wl;
+    uint16_t margin;
+    uint16_t txBytes;
+
+    margin  = (gRFAL.fifo.latency * RFAL_FIFO_LATENCY_MARGIN);
+    wl      = gRFAL.fifo.wl;
+    txBytes = rfalCalcNumBytes(gRFAL.TxRx.ctx.txBufLen);
+
+#if RFAL_FEATURE_NFCV
+    /* NFC-V/PicoPass load the FIFO with the coded frame, as iso15693VCDCode() will: SOF, payload and CRC coded, EOF */
+    if( (RFAL_MODE_POLL_NFCV == gRFAL.mode) || (RFAL_MODE_POLL_PICOPASS == gRFAL.mode) )
+    {
+        txBytes = (rfalConvBitsToBytes(gRFAL.TxRx.ctx.txBufLen) + ((gRFAL.nfcvData.origCtx.flags & RFAL_TXRX_FLAGS_CRC_TX_MANUAL) ? 0 : RFAL_CRC_LEN));
+        txBytes = ((txBytes * ((gRFAL.txBR == RFAL_BR_1p66) ? RFAL_FIFO_NFCV_1_256_BYTES : RFAL_FIFO_NFCV_1_4_BYTES)) + RFAL_FIFO_NFCV_SOF_EOF_BYTES);
+    }
+#endif /* RFAL_FEATURE_NFCV */
+
+    /* Tx: a WL only occurs for frames longer than the FIFO. The lower level (16 bytes left)  *
+     * needs fewer refills, use it only if the time to send 16 bytes covers the latency      */
+    if( txBytes > ST25R3911_FIFO_DEPTH )
+    {
+        wl &= ~ST25R3911_REG_IO_CONF1_fifo_lt;
+        wl |= ( ((RFAL_FIFO_IN_LT_16 * rfalFIFOByteTimeUs( gRFAL.txBR )) > margin) ? ST25R3911_REG_IO_CONF1_fifo_lt_16bytes : ST25R3911_REG_IO_CONF1_fifo_lt_32bytes );
+    }
+
+    /* Rx: a WL only occurs for frames longer than the lower level. The higher level (16 bytes *
+     * free) needs fewer reads, use it only if the time to receive 16 bytes covers the latency  */
+    if( rfalConvBitsToBytes(gRFAL.TxRx.ctx.rxBufLen) > RFAL_FIFO_IN_LR_64 )
+    {
+        wl &= ~ST25R3911_REG_IO_CONF1_fifo_lr;
+        wl |= ( (((ST25R3911_FIFO_DEPTH - RFAL_FIFO_IN_LR_80) * rfalFIFOByteTimeUs( gRFAL.rxBR )) > margin) ? ST25R3911_REG_IO_CONF1_fifo_lr_80bytes : ST25R3911_REG_IO_CONF1_fifo_lr_64bytes );
+    }
+
+    if( wl != gRFAL.fifo.wl )
+    {
+        gRFAL.fifo.wl = wl;
+        st25r3911ChangeRegisterBits( ST25R3911_REG_IO_CONF1, (ST25R3911_REG_IO_CONF1_fifo_lt | ST25R3911_REG_IO_CONF1_fifo_lr), wl );
+    }
+}
+
+
 #if RFAL_FEATURE_NFCA
 
 /*******************************************************************************/
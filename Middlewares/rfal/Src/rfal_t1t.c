@@ -66,6 +66,7 @@
 #define RFAL_T1T_DRD_READ           (1236*2)/*!< DRD for Reads with n=9         => 1236/fc  ~= 91 us   T1T 1.2  4.4.2 */
 #define RFAL_T1T_DRD_WRITE          36052   /*!< DRD for Write with n=281       => 36052/fc ~= 2659 us T1T 1.2  4.4.2 */
 #define RFAL_T1T_DRD_WRITE_E        70996   /*!< DRD for Write/Erase with n=554 => 70996/fc ~= 5236 us T1T 1.2  4.4.2 */
+                                            /*   RSEG/READ8 and the 8 byte writes use the same n as their single byte counterparts */
 
 #define RFAL_T1T_RID_RES_HR0_VAL    0x10    /*!< HR0 indicating NDEF support  Digital 2.0 (Candidate) 11.6.2.1        */
 #define RFAL_T1T_RID_RES_HR0_MASK   0xF0    /*!< HR0 most significant nibble mask                                     */
@@ -113,6 +114,32 @@ typedef struct
     uint8_t data;                                            /*!< DAT                       */
 } rfalT1TWriteRes;
 
+
+/*! NFC-A T1T (Topaz) RSEG_REQ, READ8_REQ, WRITE-E8_REQ, WRITE-NE8_REQ   T1T 1.2  Table 5 */
+typedef struct
+{
+    uint8_t cmd;                                             /*!< T1T cmd                   */
+    uint8_t add;                                             /*!< ADDS or ADD8              */
+    uint8_t data[RFAL_T1T_BLOCK_LEN];                        /*!< DATA: 0x00 for reads      */
+    uint8_t uid[RFAL_T1T_UID_LEN];                           /*!< UID                       */
+} rfalT1T8Req;
+
+
+/*! NFC-A T1T (Topaz) READ8_RES, WRITE-E8_RES, WRITE-NE8_RES   T1T 1.2  Table 5 */
+typedef struct
+{
+    uint8_t add;                                             /*!< ADD8                      */
+    uint8_t data[RFAL_T1T_BLOCK_LEN];                        /*!< DATA                      */
+} rfalT1T8Res;
+
+
+/*! NFC-A T1T (Topaz) RSEG_RES   T1T 1.2  Table 5 */
+typedef struct
+{
+    uint8_t adds;                                            /*!< ADDS                      */
+    uint8_t data[RFAL_T1T_SEGMENT_LEN];                      /*!< DATA of the segment       */
+} rfalT1TRsegRes;
+
 /*
 ******************************************************************************
 * LOCAL FUNCTION PROTOTYPES
@@ -217,4 +244,96 @@ ReturnCode rfalT1TPollerWrite( uint8_t* uid, uint8_t address, uint8_t data )
     return err;
 }
 
+
+/*******************************************************************************/
+ReturnCode rfalT1TPollerRseg( uint8_t* uid, uint8_t segment, uint8_t* segData )
+{
+    rfalT1T8Req     rsegReq;
+    rfalT1TRsegRes  rsegRes;
+    uint16_t        rxRcvdLen;
+    ReturnCode      err;
+
+    if( (uid == NULL) || (segData == NULL) || (segment >= RFAL_T1T_MAX_SEGMENTS) )
+    {
+        return ERR_PARAM;
+    }
+
+    /* ADDS carries the segment in its upper nibble */
+    ST_MEMSET( &rsegReq, 0x00, sizeof(rfalT1T8Req) );
+    rsegReq.cmd = RFAL_T1T_CMD_RSEG;
+    rsegReq.add = (segment << 4);
+    ST_MEMCPY(rsegReq.uid, uid, RFAL_T1T_UID_LEN);
+
+    EXIT_ON_ERR( err, rfalTransceiveBlockingTxRx( (uint8_t*)&rsegReq, sizeof(rfalT1T8Req), (uint8_t*)&rsegRes, sizeof(rfalT1TRsegRes), &rxRcvdLen, RFAL_TXRX_FLAGS_DEFAULT, RFAL_T1T_DRD_READ ) );
+
+    if( (rxRcvdLen != sizeof(rfalT1TRsegRes)) || (rsegRes.adds != rsegReq.add) )
+    {
+        return ERR_PROTO;
+    }
+
+    ST_MEMCPY( segData, rsegRes.data, RFAL_T1T_SEGMENT_LEN );
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalT1TPollerRead8( uint8_t* uid, uint8_t block, uint8_t* blockData )
+{
+    rfalT1T8Req     read8Req;
+    rfalT1T8Res     read8Res;
+    uint16_t        rxRcvdLen;
+    ReturnCode      err;
+
+    if( (uid == NULL) || (blockData == NULL) )
+    {
+        return ERR_PARAM;
+    }
+
+    ST_MEMSET( &read8Req, 0x00, sizeof(rfalT1T8Req) );
+    read8Req.cmd = RFAL_T1T_CMD_READ8;
+    read8Req.add = block;
+    ST_MEMCPY(read8Req.uid, uid, RFAL_T1T_UID_LEN);
+
+    EXIT_ON_ERR( err, rfalTransceiveBlockingTxRx( (uint8_t*)&read8Req, sizeof(rfalT1T8Req), (uint8_t*)&read8Res, sizeof(rfalT1T8Res), &rxRcvdLen, RFAL_TXRX_FLAGS_DEFAULT, RFAL_T1T_DRD_READ ) );
+
+    if( (rxRcvdLen != sizeof(rfalT1T8Res)) || (read8Res.add != block) )
+    {
+        return ERR_PROTO;
+    }
+
+    ST_MEMCPY( blockData, read8Res.data, RFAL_T1T_BLOCK_LEN );
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalT1TPollerWrite8( uint8_t* uid, uint8_t block, const uint8_t* blockData, bool erase )
+{
+    rfalT1T8Req     write8Req;
+    rfalT1T8Res     write8Res;
+    uint16_t        rxRcvdLen;
+    ReturnCode      err;
+
+    if( (uid == NULL) || (blockData == NULL) )
+    {
+        return ERR_PARAM;
+    }
+
+    write8Req.cmd = (erase ? RFAL_T1T_CMD_WRITE_E8 : RFAL_T1T_CMD_WRITE_NE8);
+    write8Req.add = block;
+    ST_MEMCPY(write8Req.data, blockData, RFAL_T1T_BLOCK_LEN);
+    ST_MEMCPY(write8Req.uid, uid, RFAL_T1T_UID_LEN);
+
+    EXIT_ON_ERR( err, rfalTransceiveBlockingTxRx( (uint8_t*)&write8Req, sizeof(rfalT1T8Req), (uint8_t*)&write8Res, sizeof(rfalT1T8Res), &rxRcvdLen, RFAL_TXRX_FLAGS_DEFAULT, (erase ? RFAL_T1T_DRD_WRITE_E : RFAL_T1T_DRD_WRITE) ) );
+
+    /* WRITE-NE8 returns the block content after ORing, not the data sent */
+    if( (rxRcvdLen != sizeof(rfalT1T8Res)) || (write8Res.add != block) ||
+        (erase && (ST_BYTECMP(write8Res.data, write8Req.data, RFAL_T1T_BLOCK_LEN) != 0)) )
+    {
+        return ERR_PROTO;
+    }
+
+    return ERR_NONE;
+}
+
 #endif /* RFAL_FEATURE_T1T */
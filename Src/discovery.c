@@ -0,0 +1,274 @@
+/******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2016 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+/*
+ *      PROJECT:   ST25R3911 firmware
+ *      $Revision: $
+ *      LANGUAGE:  ANSI C
+ */
+
+
+/*! \file
+ *
+ *  \brief Discovery of PICCs of several technologies in one go
+ *
+ */
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include "discovery.h"
+#include "utils.h"
+#include "iso14443a.h"
+#include "iso14443b.h"
+#include "iso14443b_st25tb.h"
+#include "felica.h"
+#include "iso15693_3.h"
+#include "kovio.h"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define DISCOVERY_FELICA_MAX_CARDS  4U  /*!< answers to a 4 slot polling */
+#define DISCOVERY_ISO15693_MAX_CARDS 16U /*!< answers to a 16 slot inventory */
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+/*! PICCs found by the poll of one technology, only one is polled at a time */
+static union
+{
+    iso14443AProximityCard_t a[ISO14443A_MAX_CARDS];
+    iso14443BProximityCard_t b[ISO14443B_MAX_CARDS];
+    struct felicaProximityCard f[DISCOVERY_FELICA_MAX_CARDS];
+    iso15693ProximityCard_t v[DISCOVERY_ISO15693_MAX_CARDS];
+    iso14443B_ST25TB_t st[ISO14443B_ST25TB_MAX_TAGS];
+    kovioProximityCard_t k;
+} discoveryCards;
+
+/*
+******************************************************************************
+* LOCAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+static ReturnCode discoveryInitTech(uint8_t tech);
+static uint8_t discoveryPollTech(uint8_t tech, discoveryDevice_t *devices, uint8_t maxDevices);
+static void discoveryAdd(discoveryDevice_t *device, uint8_t tech, const uint8_t *id, uint8_t idLen, const uint8_t *info, uint8_t infoLen);
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+ReturnCode discoveryRun(const discoveryStep_t *steps, uint8_t numSteps, uint8_t options,
+                        discoveryDevice_t *devices, uint8_t maxDevices, uint8_t *numDevices, uint16_t *polls)
+{
+    ReturnCode err;
+    uint32_t start;
+    uint8_t found;
+    uint8_t s;
+
+    *numDevices = 0;
+    *polls = 0;
+    if ((numSteps == 0) || (numSteps > DISCOVERY_MAX_STEPS) ||
+        (maxDevices == 0) || (maxDevices > DISCOVERY_MAX_DEVICES))
+    {
+        return ERR_PARAM;
+    }
+    for (s = 0; s < numSteps; s++)
+    {
+        if ((steps[s].tech < DISCOVERY_TECH_ISO15693) || (steps[s].tech > DISCOVERY_TECH_KOVIO))
+        {
+            return ERR_PARAM;
+        }
+    }
+
+    for (s = 0; (s < numSteps) && (*numDevices < maxDevices); s++)
+    {
+        /* mode switch only, the field stays on */
+        err = discoveryInitTech(steps[s].tech);
+        if (ERR_NONE != err)
+        {
+            return err;
+        }
+
+        start = platformGetSysTick();
+        do
+        {
+            (*polls)++;
+            found = discoveryPollTech(steps[s].tech, &devices[*numDevices], maxDevices - *numDevices);
+        } while ((found == 0) && ((platformGetSysTick() - start) < steps[s].budgetMs));
+
+        *numDevices += found;
+        if ((found > 0) && (options & DISCOVERY_OPT_STOP_FIRST))
+        {
+            break;
+        }
+    }
+
+    return ((*numDevices > 0) ? ERR_NONE : ERR_NOTFOUND);
+}
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+/*!
+ *****************************************************************************
+ *  \brief  Switch the RF to the poller mode of a technology
+ *
+ *  The initializations turn the field on only if it is off, else they
+ *  just start the guard time of the new mode.
+ *
+ *****************************************************************************
+ */
+static ReturnCode discoveryInitTech(uint8_t tech)
+{
+    switch (tech)
+    {
+        case DISCOVERY_TECH_NFCA:
+            return iso14443AInitialize();
+        case DISCOVERY_TECH_NFCB:
+        case DISCOVERY_TECH_ST25TB:
+            return iso14443BInitialize();
+        case DISCOVERY_TECH_FELICA:
+            return felicaInitialize();
+        case DISCOVERY_TECH_ISO15693:
+            return iso15693Initialize(false, false);
+        case DISCOVERY_TECH_KOVIO:
+            return kovioInitialize();
+        default:
+            return ERR_PARAM;
+    }
+}
+
+/*!
+ *****************************************************************************
+ *  \brief  Poll a technology once and add the PICCs found
+ *
+ *  \return number of PICCs added to \a devices
+ *
+ *****************************************************************************
+ */
+static uint8_t discoveryPollTech(uint8_t tech, discoveryDevice_t *devices, uint8_t maxDevices)
+{
+    uint8_t n = 0;
+    uint8_t cols;
+    uint8_t i;
+    bool colPending;
+
+    switch (tech)
+    {
+        case DISCOVERY_TECH_NFCA:
+            /* the PICCs found but the last are halted, WUPA wakes them again next time */
+            iso14443AResolveAll(ISO14443A_RESOLVE_OPT_WUPA, discoveryCards.a, MIN(maxDevices, ISO14443A_MAX_CARDS), &n);
+            for (i = 0; i < n; i++)
+            {
+                uint8_t info[3];
+                info[0] = discoveryCards.a[i].atqa[0];
+                info[1] = discoveryCards.a[i].atqa[1];
+                info[2] = discoveryCards.a[i].sak[0];
+                discoveryAdd(&devices[i], tech, discoveryCards.a[i].uid, discoveryCards.a[i].actlength, info, sizeof(info));
+            }
+            break;
+
+        case DISCOVERY_TECH_NFCB:
+            iso14443BResolveAll(0, ISO14443B_SLOT_COUNT_1, ISO14443B_SLOT_COUNT_16,
+                                discoveryCards.b, MIN(maxDevices, ISO14443B_MAX_CARDS), &n, &colPending);
+            for (i = 0; i < n; i++)
+            {
+                uint8_t info[ISO14443B_APPDATA_LENGTH + ISO14443B_PROTINFO_LENGTH];
+                ST_MEMCPY(&info[0], discoveryCards.b[i].applicationData, ISO14443B_APPDATA_LENGTH);
+                ST_MEMCPY(&info[ISO14443B_APPDATA_LENGTH], discoveryCards.b[i].protocolInfo, ISO14443B_PROTINFO_LENGTH);
+                discoveryAdd(&devices[i], tech, discoveryCards.b[i].pupi, ISO14443B_PUPI_LENGTH, info, sizeof(info));
+            }
+            break;
+
+        case DISCOVERY_TECH_FELICA:
+            n = MIN(maxDevices, DISCOVERY_FELICA_MAX_CARDS);
+            if (ERR_NONE != felicaPoll(FELICA_4_SLOTS, 0xff, 0xff, FELICA_REQ_NO_REQUEST, discoveryCards.f, &n, &cols))
+            {
+                n = 0;
+            }
+            for (i = 0; i < n; i++)
+            {
+                discoveryAdd(&devices[i], tech, discoveryCards.f[i].IDm, FELICA_MAX_ID_LENGTH,
+                             discoveryCards.f[i].PMm, sizeof(discoveryCards.f[i].PMm));
+            }
+            break;
+
+        case DISCOVERY_TECH_ISO15693:
+            /* a collision left unresolved still returns the PICCs seen */
+            iso15693Inventory(ISO15693_NUM_SLOTS_16, 0, NULL, discoveryCards.v,
+                              MIN(maxDevices, DISCOVERY_ISO15693_MAX_CARDS), &n);
+            for (i = 0; i < n; i++)
+            {
+                discoveryAdd(&devices[i], tech, discoveryCards.v[i].uid, ISO15693_UID_LENGTH,
+                             &discoveryCards.v[i].dsfid, 1);
+            }
+            break;
+
+        case DISCOVERY_TECH_ST25TB:
+            iso14443B_ST25TB_ResolveAll(discoveryCards.st, MIN(maxDevices, ISO14443B_ST25TB_MAX_TAGS), &n);
+            for (i = 0; i < n; i++)
+            {
+                discoveryAdd(&devices[i], tech, discoveryCards.st[i].uid, ISO14443B_ST25TB_UIDSIZE,
+                             &discoveryCards.st[i].Chip_ID, 1);
+            }
+            break;
+
+        case DISCOVERY_TECH_KOVIO:
+            if (ERR_NONE == kovioRead(&discoveryCards.k))
+            {
+                n = 1;
+                discoveryAdd(&devices[0], tech, discoveryCards.k.uid, discoveryCards.k.length, NULL, 0);
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return n;
+}
+
+/*!
+ *****************************************************************************
+ *  \brief  Fill in a PICC found
+ *
+ *****************************************************************************
+ */
+static void discoveryAdd(discoveryDevice_t *device, uint8_t tech, const uint8_t *id, uint8_t idLen, const uint8_t *info, uint8_t infoLen)
+{
+    device->tech = tech;
+    device->idLen = MIN(idLen, DISCOVERY_MAX_ID_LEN);
+    ST_MEMCPY(device->id, id, device->idLen);
+    device->infoLen = MIN(infoLen, DISCOVERY_MAX_INFO_LEN);
+    if (device->infoLen > 0)
+    {
+        ST_MEMCPY(device->info, info, device->infoLen);
+    }
+}
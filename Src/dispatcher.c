@@ -58,6 +58,9 @@
 #include "felica.h"
 #include "topaz.h"
 #include "kovio.h"
+#include "rfal_coroutine.h"
+#include "uid_set.h"
+#include "discovery.h"
 #ifdef HAS_MCC
 #include "mcc.h"
 #include "mcc_raw_request.h"
@@ -71,6 +74,8 @@
 #include "rfal_nfcDep.h"
 #include "rfal_analogConfig.h"
 #include "rfal_iso15693_2.h"
+#include "rfal_crc.h"
+#include "delay.h"
 
 /*
 ******************************************************************************
@@ -87,13 +92,100 @@
 /*! Timeout of mifare write command data transmission part in milliseconds. */
 #define MCC_WRITE_DATA_TIMEOUT       7
 
+/*! Options of #RFAL_CMD_TXRX_SEQUENCE */
+#define TXRX_SEQUENCE_OPT_CONTINUE_ON_ERR  0x01  /*!< Run remaining frames after a failed one */
+
+/*! Size of a frame header and of a frame result header of #RFAL_CMD_TXRX_SEQUENCE */
+#define TXRX_SEQUENCE_FRAME_HDR_LEN        14    /*!< txLen(2) flags(4) FWT(4) guard time(4) */
+#define TXRX_SEQUENCE_RESULT_HDR_LEN       7     /*!< status(1) time(4) rxLen(2)             */
+
+/*! Limits of the RF script interpreter, see #processScript() */
+#define SCRIPT_MAX_LEN                     512   /*!< Size of the script memory in bytes           */
+#define SCRIPT_TX_BUF_LEN                  64    /*!< Size of the frame built by TX_xxx opcodes    */
+#define SCRIPT_RX_BUF_LEN                  256   /*!< Size of the buffer for the last response     */
+#define SCRIPT_NUM_REGS                    4     /*!< Number of 16 bit registers                   */
+#define SCRIPT_MAX_STEPS                   4096  /*!< Opcodes executed per run before giving up    */
+#define SCRIPT_MAX_TIME_MS                 2000  /*!< Time a run may take, DELAY and FWTs included */
+
+/*! Offset in txData of the test data used by #RFAL_CMD_CRC_BENCHMARK, the response lies before */
+#define CRC_BENCHMARK_DATA_OFFSET          64
+
+/*! Departure reports of the UID seen-set, see #RFAL_CMD_UID_SET_CONFIG */
+#define UID_SET_SWEEP_SLOTS                64    /*!< Slots checked per applProcessCyclic() call  */
+#define UID_SET_REPORT_MAX_PICCS           16    /*!< Departed PICCs per packet                   */
+#define UID_SET_BENCHMARK_TTL_MS           1000  /*!< TTL used by #RFAL_CMD_UID_SET_BENCHMARK     */
+
+/*! Records streamed by the ISO15693 multi round inventory (0xd1), see #processIso15693() */
+#define ISO15693_STREAM_REC_TAGS           0x01  /*!< PICCs found by one round          */
+#define ISO15693_STREAM_REC_DONE           0x02  /*!< Summary after the last round      */
+#define ISO15693_STREAM_TAGS_HDR_LEN       4     /*!< type(1) round(2) num_cards(1)     */
+#define ISO15693_STREAM_SIM_SEED           0x15693UL /*!< UID seed of the simulated PICC population */
+
+/*! Records streamed by the ISO15693 memory dump (0xdc), see #processIso15693() */
+#define ISO15693_DUMP_REC_DATA             0x03  /*!< Blocks read by one request        */
+#define ISO15693_DUMP_REC_DONE             0x04  /*!< Summary after the last chunk      */
+#define ISO15693_DUMP_DATA_HDR_LEN         4     /*!< type(1) block(2) num_blocks(1)    */
+#define ISO15693_DUMP_OPT_FAST             0x01  /*!< use Fast Read Multiple Blocks on ST PICCs */
+
+/*! Records streamed by the NTAG/Ultralight whole tag read (0xa9), see #processIso14443a() */
+#define MIFARE_UL_DUMP_REC_DATA            0x01  /*!< Pages read by one request         */
+#define MIFARE_UL_DUMP_REC_DONE            0x02  /*!< Summary after the last chunk      */
+#define MIFARE_UL_DUMP_DATA_HDR_LEN        4     /*!< type(1) page(2) num_pages(1)      */
+#define MIFARE_UL_DUMP_OPT_NO_FAST         0x01  /*!< read with READ even if FAST_READ is supported */
+
+/*! Records streamed by the ST25TB memory dump (0x6a), see #processSt25tbDump() */
+#define ST25TB_DUMP_REC_DATA               0x01  /*!< Blocks of one tag read by one request */
+#define ST25TB_DUMP_REC_DONE               0x02  /*!< Summary after the last chunk      */
+#define ST25TB_DUMP_DATA_HDR_LEN           12    /*!< type(1) chip_id(1) uid(8) block(1) num_blocks(1) */
+#define ST25TB_DUMP_OPT_COMPLETE           0x01  /*!< send Completion to each tag read  */
+
+/*! Records streamed by the APDU pipe (0x65), see #processIsoDepPipe() */
+#define ISO_DEP_PIPE_REC_DATA              0x01  /*!< Next bytes of the response APDU   */
+#define ISO_DEP_PIPE_REC_DONE              0x02  /*!< Summary after the last bytes      */
+#define ISO_DEP_PIPE_DONE_LEN              17    /*!< type(1) tx(4) rx(4) latency(4) time(4) */
+#define ISO_DEP_PIPE_OPT_LAST              0x01  /*!< data ends the command APDU        */
+#define NFC_DEP_TX_PART_OPT_LAST           0x01  /*!< data ends the outgoing NFC-DEP data */
+#define FELICA_READ_MAX_RANGES             16    /*!< Block ranges of one FeliCa read command */
+#define PROTOCOL_SWITCH_OPT_KEEP_FIELD     0x01  /*!< keep the field on when the protocol nibble changes */
+#define DISCOVERY_HDR_LEN                  6     /*!< num devices(1) polls(1) ms(4) */
+#define DISCOVERY_DEVICE_MAX_LEN           (3 + DISCOVERY_MAX_ID_LEN + DISCOVERY_MAX_INFO_LEN) /*!< tech, id length, id, info length, info */
+#define KOVIO_CAPTURE_HDR_LEN              15    /*!< counters(8) ms(4) period(2) uid length(1) */
+#define TOPAZ_WRITE_OPT_NO_ERASE           0x01  /*!< OR the data to the memory (WRITE-NE8) */
+#define TOPAZ_WRITE_OPT_LOCK_OTP           0x02  /*!< allow writes to the UID, reserved, lock and OTP blocks */
+#define TOPAZ_MEM_HDR_LEN                  7     /*!< hr(2) frames(1) ms(4) in front of a whole memory read */
+#define FELICA_READ_HEADER_LEN             10    /*!< blocks(2) commands(1) failures(1) sf1(1) sf2(1) ms(4) */
+
+/*! Opcodes of the RF script interpreter, see #processScript() */
+enum scriptOpcode
+{
+    SCRIPT_OP_END                     = 0x00,
+    SCRIPT_OP_TX_LOAD                 = 0x01,
+    SCRIPT_OP_TX_APPEND               = 0x02,
+    SCRIPT_OP_TX_APPEND_ARG           = 0x03,
+    SCRIPT_OP_TX_APPEND_REG           = 0x04,
+    SCRIPT_OP_TXRX                    = 0x05,
+    SCRIPT_OP_REG_SET                 = 0x06,
+    SCRIPT_OP_REG_INC                 = 0x07,
+    SCRIPT_OP_LOOP                    = 0x08,
+    SCRIPT_OP_JMP                     = 0x09,
+    SCRIPT_OP_JMP_STATUS_NE           = 0x0A,
+    SCRIPT_OP_JMP_RX_NE               = 0x0B,
+    SCRIPT_OP_JMP_RX_EQ               = 0x0C,
+    SCRIPT_OP_DELAY                   = 0x0D,
+    SCRIPT_OP_FIELD                   = 0x0E,
+    SCRIPT_OP_SET_MODE                = 0x0F,
+    SCRIPT_OP_SET_BITRATE             = 0x10,
+    SCRIPT_OP_EMIT                    = 0x11,
+    SCRIPT_OP_FAIL                    = 0x12,
+};
+
 /*! Command codes for NFC protocol. */
 enum nfcCommand
 {
     NFC_CMD_INITIALIZE                    = 0xC0,
     NFC_CMD_TX_NBYTES                     = 0xC1,
     NFC_CMD_RX_NBYTES                     = 0xC2,
-    NFC_CMD_RFU1                          = 0xC3,
+    NFC_CMD_NFCDEP_TX_PART                = 0xC3,
     NFC_CMD_SET_TXBITRATE                 = 0xC4,
     NFC_CMD_SET_RXBITRATE                 = 0xC5,
     NFC_CMD_NFCDEP_TX                     = 0xC6,
@@ -137,6 +229,26 @@ enum rfalCommand
     RFAL_CMD_BLOCKING_TX                       = 0x57,
     RFAL_CMD_BLOCKING_RX                       = 0x58,
     RFAL_CMD_BLOCKING_TXRX                     = 0x59,
+    RFAL_CMD_CO_MIFARE_UL_READ                 = 0x5A,
+    RFAL_CMD_CO_ISO14443_L4_TXRX               = 0x5B,
+    RFAL_CMD_CO_GET_STATUS                     = 0x5C,
+    RFAL_CMD_CO_ABORT                          = 0x5D,
+    RFAL_CMD_TXRX_SEQUENCE                     = 0x5E,
+    RFAL_CMD_SCRIPT_LOAD                       = 0x5F,
+    RFAL_CMD_SCRIPT_RUN                        = 0x60,
+    RFAL_CMD_GET_FIFO_STATS                    = 0x61,
+    RFAL_CMD_CRC_BENCHMARK                     = 0x62,
+    RFAL_CMD_UID_SET_CONFIG                    = 0x63,
+    RFAL_CMD_UID_SET_BENCHMARK                 = 0x64,
+    RFAL_CMD_ISO_DEP_PIPE_WRITE                = 0x65,
+    RFAL_CMD_ISO_DEP_PIPE_ABORT                = 0x66,
+    RFAL_CMD_ISO_DEP_ACTIVATE                  = 0x67,
+    RFAL_CMD_ISO_DEP_BENCHMARK                 = 0x68,
+    RFAL_CMD_NFCB_RESOLVE_ALL                  = 0x69,
+    RFAL_CMD_ST25TB_DUMP                       = 0x6A,
+    RFAL_CMD_DISCOVER                          = 0x6B,
+    RFAL_CMD_PROTOCOL_SWITCH_CONFIG            = 0x6C,
+    RFAL_CMD_CO_TOPAZ_READ_ALL                 = 0x6D,
 };
 
 /*
@@ -163,9 +275,70 @@ static uint8_t nfc_lmMask;
 static uint8_t first_command_received;
 
 
-static uint8_t  gRxBuf[1024];   /* rx buffer used only for rfal non blocking TxRx */
+static uint8_t  gRxBuf[1024];   /* rx buffer used only for rfal non blocking TxRx and background operations */
 static uint16_t gRcvdLen;       /* rx length used only for rfal non blocking TxRx */
 
+static uint8_t  coCmd;          /* command which started the background operation */
+static uint8_t  coMfuActLen;    /* bytes read by background mifare UL read */
+static uint16_t coL4ActLen;     /* bytes received by background ISO14443-4 exchange */
+static uint16_t coTopazActLen;  /* bytes received by background topaz RALL */
+static topazProximityCard_t coTopazCard; /* PICC read by background topaz RALL */
+static union
+{
+    mifareUlReadContext_t mfu;
+    iso14443L4Context_t   l4;
+    topazReadAllContext_t topaz;
+} coCtx;                        /* context of the background operation */
+
+static uint8_t  scriptBuf[SCRIPT_MAX_LEN]; /* script uploaded by RFAL_CMD_SCRIPT_LOAD */
+static uint16_t scriptLen;                 /* number of valid bytes in scriptBuf */
+
+static uint8_t  cmdProtocol;               /* protocol byte of the command being processed */
+static uint8_t  protocolActive;            /* protocol nibble processProtocols() initialized, 0 if none */
+static uint8_t  protocolConfigured;        /* protocol nibble whose initialization the RF still has, 0 if unknown */
+static bool     protocolKeepField;         /* see #PROTOCOL_SWITCH_OPT_KEEP_FIELD */
+static uint16_t protocolSwitches;          /* protocol changes since RFAL_CMD_PROTOCOL_SWITCH_CONFIG */
+static uint16_t protocolFieldKept;         /* ... of which kept the field on */
+static uint16_t protocolInitSkipped;       /* ... of which found the RF configured already */
+static uint32_t protocolSwitchMs;          /* time spent in the protocol changes */
+
+static iso15693MultiInventory_t iso15693StreamInv; /* multi round inventory streamed by applProcessCyclic() */
+static bool     iso15693StreamRunning;     /* iso15693StreamInv has records to send */
+static bool     iso15693StreamSim;         /* iso15693StreamInv reads a simulated population */
+static uint8_t  iso15693StreamProtocol;    /* protocol byte of the command which started iso15693StreamInv or iso15693Dump */
+static uint32_t iso15693StreamStart;       /* system tick when iso15693StreamInv or iso15693Dump was started */
+
+static iso15693Dump_t iso15693Dump;        /* memory dump streamed by applProcessCyclic() */
+static bool     iso15693DumpRunning;       /* iso15693Dump has records to send */
+static ReturnCode iso15693DumpErr;         /* result of the dump, reported with its summary */
+
+static mifareUlDump_t mifareUlDump;       /* whole tag read streamed by applProcessCyclic() */
+static bool     mifareUlDumpRunning;       /* mifareUlDump has records to send */
+static ReturnCode mifareUlDumpErr;         /* result of the read, reported with its summary */
+static uint8_t  mifareUlDumpProtocol;      /* protocol byte of the command which started mifareUlDump */
+static uint32_t mifareUlDumpStart;         /* system tick when mifareUlDump was started */
+
+static iso14443B_ST25TB_Dump_t st25tbDump; /* memory dump of all ST25TB streamed by applProcessCyclic() */
+static bool     st25tbDumpRunning;         /* st25tbDump has records to send */
+static ReturnCode st25tbDumpErr;           /* result of the dump, reported with its summary */
+static uint8_t  st25tbDumpProtocol;        /* protocol byte of the command which started st25tbDump */
+static uint32_t st25tbDumpStart;           /* system tick when st25tbDump was started */
+
+static bool     uidSetEnabled;             /* scans report arrivals only, departures are streamed */
+static uint8_t  uidSetProtocol;            /* protocol byte of the command which enabled the seen-set */
+
+static bool     isoDepPipeRunning;         /* APDU pipe has records to send */
+static ReturnCode isoDepPipeErr;           /* ERR_BUSY while exchanging, then the result reported with the summary */
+static uint8_t  isoDepPipeProtocol;        /* protocol byte of the command which started the exchange */
+static uint32_t isoDepPipeStart;           /* system tick of the first write */
+static uint32_t isoDepPipeTxEnd;           /* system tick of the last write */
+static uint32_t isoDepPipeLatency;         /* ms from the last write to the first response byte */
+static uint32_t isoDepPipeTxBytes;         /* bytes of the command APDU */
+static uint32_t isoDepPipeRxBytes;         /* bytes of the response APDU streamed so far */
+
+static iso14443BProximityCard_t nfcbCards[ISO14443B_MAX_CARDS]; /* PICCs found by RFAL_CMD_NFCB_RESOLVE_ALL */
+static discoveryDevice_t discoveryDevices[DISCOVERY_MAX_DEVICES]; /* PICCs found by RFAL_CMD_DISCOVER */
+
 /*
 ******************************************************************************
 * GLOBAL CONSTANTS
@@ -189,6 +362,20 @@ static ReturnCode processIso15693(const uint8_t *rxData, uint16_t rxSize, uint8_
 static ReturnCode processMifare(const uint8_t *rxData, uint16_t rxSize, uint8_t *txData, uint16_t *txSize);
 #endif
 static ReturnCode processFeliCa(const uint8_t *rxData, uint16_t rxSize, uint8_t *txData, uint16_t *txSize);
+static ReturnCode processScript(const uint8_t *args, uint16_t argsLen, uint8_t *txData, uint16_t *txSize);
+static ReturnCode processIso15693Stream(uint8_t *txData, uint16_t *txSize, uint16_t remainingSize);
+static ReturnCode processIso15693Dump(uint8_t *txData, uint16_t *txSize, uint16_t remainingSize);
+static ReturnCode processUidSetExpire(uint8_t *txData, uint16_t *txSize, uint16_t remainingSize);
+static ReturnCode processMifareUlDump(uint8_t *txData, uint16_t *txSize, uint16_t remainingSize);
+static ReturnCode processSt25tbDump(uint8_t *txData, uint16_t *txSize, uint16_t remainingSize);
+static ReturnCode processIsoDepPipe(uint8_t *txData, uint16_t *txSize, uint16_t remainingSize);
+static bool streamChunkFits(uint16_t need, uint16_t remainingSize);
+static uint16_t streamPutValue(uint8_t *txData, uint16_t pos, uint32_t value, uint8_t len);
+static uint16_t streamDumpDone(uint8_t *txData, uint16_t pos, const char *name, uint32_t bytes, uint16_t frames, uint16_t retries, uint32_t start, bool *running);
+static void streamsStop(void);
+static bool protocolRfConfig(uint8_t prot, rfalMode *mode, rfalBitRate *txBR, rfalBitRate *rxBR);
+static bool protocolRfConfigured(uint8_t prot);
+static void uidSetBenchmarkUid(uint16_t n, uint8_t *tech, uint8_t *uid, uint8_t *uidLen);
 
 /*
 ******************************************************************************
@@ -214,51 +401,70 @@ static ReturnCode processFeliCa(const uint8_t *rxData, uint16_t rxSize, uint8_t
   */
 uint8_t processProtocols ( const uint8_t * rxData, uint16_t rxSize, uint8_t * txData, uint16_t *txSize)
 {
-    static uint8_t protocol = 0;
+    uint8_t protocol = protocolActive;
     uint8_t cmd = *rxData;
     ReturnCode err = ERR_REQUEST;
     uint8_t subcmd = cmd & 0x0f;
     uint8_t newprot = cmd & 0xf0;
+    uint8_t keepOn = protocolKeepField;
+    uint32_t start;
 
     if (newprot != protocol)
     {
+        start = platformGetSysTick();
+        protocolSwitches++;
+
         if ((protocol & 0xf0) == 0x80)
         { /* kovio barcode commands */
-            err = kovioDeinitialize(0);
+            err = kovioDeinitialize(keepOn);
         }
         else if ((protocol & 0xf0) == 0x90)
         { /* topaz commands */
-            err = topazDeinitialize(0);
+            err = topazDeinitialize(keepOn);
         }
         else if ((protocol & 0xf0) == 0xa0)
         { /* iso14443a+mifare UL commands */
-            err = iso14443ADeinitialize(0);
+            err = iso14443ADeinitialize(keepOn);
         }
         else if ((protocol & 0xf0) == 0xb0)
         { /* iso14443a+mifare UL commands */
-            err = iso14443BDeinitialize(0);
+            err = iso14443BDeinitialize(keepOn);
         }
         else if ((protocol & 0xf0) == 0xc0)
-        { /* nfc commands */
+        { /* nfc commands, the NFC-DEP modes do not leave the field as a poller needs it */
             err = nfcDeinitialize();
+            keepOn = false;
         }
         else if ((protocol & 0xf0) == 0xd0)
         { /* iso15693 commands */
-            err = iso15693Deinitialize(0);
+            err = iso15693Deinitialize(keepOn);
         }
 #ifdef HAS_MCC
         else if ((protocol & 0xf0) == 0xe0)
         { /* mifare commands */
-            err = mccDeinitialise(0);
+            err = mccDeinitialise(keepOn);
         }
 #endif
         else if ((protocol & 0xf0) == 0xf0)
         { /* mifare commands */
-            err = felicaDeinitialize(0);
+            err = felicaDeinitialize(keepOn);
+        }
+
+        if (keepOn && st25r3911IsTxEnabled())
+        { /* PICCs stay powered, no reset time needed */
+            protocolFieldKept++;
+        }
+        else
+        {
+            platformDelay(10);
+            keepOn = false;
         }
-        platformDelay(10);
 
-        if (subcmd != 0x0)
+        if (keepOn && (subcmd != 0x0) && protocolRfConfigured(newprot))
+        { /* mode and bit rates are set already, GT not needed either */
+            protocolInitSkipped++;
+        }
+        else if (subcmd != 0x0)
         { /* if not an initialize reuse last config */
             if ((cmd & 0xf0) == 0x80)
             { /* kovio commands */
@@ -294,7 +500,9 @@ uint8_t processProtocols ( const uint8_t * rxData, uint16_t rxSize, uint8_t * tx
             { /* FeliCa commands */
                 err = felicaInitialize();
             }
+            protocolConfigured = newprot;
         }
+        protocolSwitchMs += (platformGetSysTick() - start);
     }
 
     /* call more specific dispatcher */
@@ -333,10 +541,10 @@ uint8_t processProtocols ( const uint8_t * rxData, uint16_t rxSize, uint8_t * tx
        err = processFeliCa(rxData, rxSize, txData, txSize);
     }
 
-    protocol = newprot;
+    protocolActive = newprot;
 
     if (subcmd == 0xf)
-        protocol = 0;
+        protocolActive = 0;
 
     return err;
 }
@@ -634,6 +842,304 @@ uint8_t processProtocols ( const uint8_t * rxData, uint16_t rxSize, uint8_t * tx
       <tr><th>Content</th><td>rxLen</td><td>rxData</td></tr>
     </table>
 
+  Background operations: the following commands start a protocol operation
+  and return immediately. The operation advances from the main loop via
+  #rfalCoroutineWorker() while further packets are being processed. As long
+  as it runs every command except 0x5C and 0x5D is refused with ERR_BUSY.
+  Starting one stops the running streams, dumps and pipes as they share the
+  RF, so neither can be started while the other runs.
+
+  -  Background #mifareUlReadNBytes(), PICC must have been selected using 0xA1
+    <table>
+      <tr><th>   Byte</th> <th>0</th> <th>1</th> <th>2</th> </tr>
+      <tr><th>Content</th><td>0x5A(ID)</td> <td>start</td> <td>length</td> </tr>
+    </table>
+     returns status ERR_NONE if the operation was started.
+
+  -  Background #iso14443TransmitAndReceiveL4(), PICC must be in protocol mode
+    <table>
+      <tr><th>   Byte</th> <th>0</th> <th>1..txLen</th> </tr>
+      <tr><th>Content</th><td>0x5B(ID)</td> <td>APDU</td> </tr>
+    </table>
+     returns status ERR_NONE if the operation was started.
+
+  -  Background #topazReadAll(), PICC must be in READY state and RF in topaz mode (e.g. after 0x91)
+    <table>
+      <tr><th>   Byte</th> <th>0</th> <th>1..4</th> </tr>
+      <tr><th>Content</th><td>0x6D(ID)</td> <td>UID</td> </tr>
+    </table>
+     returns status ERR_NONE if the operation was started.
+
+  -  Get status of background operation
+    <table>
+      <tr><th>   Byte</th> <th>0</th> </tr>
+      <tr><th>Content</th><td>0x5C(ID)</td> </tr>
+    </table>
+     returns status ERR_BUSY while running, else the result of the operation and response is:
+    <table>
+      <tr><th>   Byte</th><th>    0..1  </th><th> 2..2+rxLen </th></tr>
+      <tr><th>Content</th><td>rxLen</td><td>rxData</td></tr>
+    </table>
+
+  -  Abort background operation
+    <table>
+      <tr><th>   Byte</th> <th>0</th> </tr>
+      <tr><th>Content</th><td>0x5D(ID)</td> </tr>
+    </table>
+     returns status ERR_NONE.
+
+  -  RFAL Transceive Sequence: runs frames back to back like 0x59 and returns all responses at once
+    <table>
+      <tr><th>   Byte</th> <th>0</th> <th>1</th> <th>2</th> <th>3..</th> </tr>
+      <tr><th>Content</th><td>0x5E(ID)</td> <td>number of frames</td> <td>options</td> <td>frames</td> </tr>
+    </table>
+     options: bit 0 set = continue with the next frame after a failed one, else stop.
+     Each frame is:
+    <table>
+      <tr><th>   Byte</th> <th>0..1</th> <th>2..2+txLen-1</th> <th>2+txLen .. 2+txLen+3</th> <th>2+txLen+4 .. 2+txLen+7</th> <th>2+txLen+8 .. 2+txLen+11</th> </tr>
+      <tr><th>Content</th><td>txLen</td> <td>txData</td> <td>flags</td> <td>FWT</td> <td>guard time</td> </tr>
+    </table>
+     guard time: minimum time in 1/fc between the response of the previous frame and this frame,
+     applied by #rfalSetFDTPoll(). 0 uses the FDT poll set before the sequence, which is restored
+     afterwards.
+     returns ERR_NONE if all frames succeeded, else the status of the first failed frame and response is:
+    <table>
+      <tr><th>   Byte</th><th>    0  </th><th> 1.. </th></tr>
+      <tr><th>Content</th><td>number of frames executed</td><td>frame results</td></tr>
+    </table>
+     Each frame result is:
+    <table>
+      <tr><th>   Byte</th><th>0</th><th>1..4</th><th>5..6</th><th>7..7+rxLen-1</th></tr>
+      <tr><th>Content</th><td>status</td><td>time in us of this frame's transceive</td><td>rxLen</td><td>rxData</td></tr>
+    </table>
+
+  -  RFAL Script Load: stores (a part of) an RF script, see #processScript()
+    <table>
+      <tr><th>   Byte</th> <th>0</th> <th>1..2</th> <th>3..</th> </tr>
+      <tr><th>Content</th><td>0x5F(ID)</td> <td>offset</td> <td>script bytes</td> </tr>
+    </table>
+     offset 0 starts a new script, following parts must continue at the current script length.
+     returns ERR_NOMEM if the script does not fit, ERR_PARAM on a wrong offset.
+
+  -  RFAL Script Run: executes the stored script, see #processScript()
+    <table>
+      <tr><th>   Byte</th> <th>0</th> <th>1..</th> </tr>
+      <tr><th>Content</th><td>0x60(ID)</td> <td>arguments</td> </tr>
+    </table>
+     returns the result of the script and, if it is ERR_NONE, response is:
+    <table>
+      <tr><th>   Byte</th><th>0..1</th><th> 2.. </th></tr>
+      <tr><th>Content</th><td>script position where execution stopped</td><td>emitted records</td></tr>
+    </table>
+
+  -  RFAL Get FIFO Statistics, see #rfalGetFIFOStats()
+    <table>
+      <tr><th>   Byte</th> <th>0</th> <th>1</th> </tr>
+      <tr><th>Content</th><td>0x61(ID)</td> <td>clear(1: reset counters after reading)</td> </tr>
+    </table>
+     txSize must be >=14, returns status ERR_NONE and response is (each value 2 bytes):
+    <table>
+      <tr><th>   Byte</th><th>0..1</th><th>2..3</th><th>4..5</th><th>6..7</th><th>8..9</th><th>10..11</th><th>12..13</th></tr>
+      <tr><th>Content</th><td>tx reloads</td><td>tx near misses</td><td>tx underflows</td><td>rx reads</td><td>rx near misses</td><td>rx overflows</td><td>max latency in us</td></tr>
+    </table>
+
+  -  RFAL CRC Benchmark: verifies #rfalCrcCalculateCcitt() against #rfalCrcCalculateCcittBitwise()
+     on pseudo random data for every length from 1 up to 1024 bytes, then times both
+    <table>
+      <tr><th>   Byte</th> <th>0</th> <th>1..2</th> </tr>
+      <tr><th>Content</th><td>0x62(ID)</td> <td>iterations per buffer size</td> </tr>
+    </table>
+     returns ERR_CRC if a result differs, else ERR_NONE and response is:
+    <table>
+      <tr><th>   Byte</th><th>0</th><th>1..2</th><th>3..</th></tr>
+      <tr><th>Content</th><td>#RFAL_CRC_ENGINE</td><td>longest verified length</td><td>results</td></tr>
+    </table>
+     with a result for each buffer size 1, 16, 64, 256, 1024 (as far as the buffer allows):
+    <table>
+      <tr><th>   Byte</th><th>0..1</th><th>2..5</th><th>6..9</th></tr>
+      <tr><th>Content</th><td>buffer size</td><td>ms taken by reference</td><td>ms taken by engine</td></tr>
+    </table>
+
+  -  RFAL UID Set Config: duplicate suppression of continuous scans, see uid_set.h
+    <table>
+      <tr><th>   Byte</th> <th>0</th> <th>1..4</th> </tr>
+      <tr><th>Content</th><td>0x63(ID)</td> <td>TTL in ms, 0 disables</td> </tr>
+    </table>
+     clears the set and returns ERR_PARAM if the TTL exceeds #UID_SET_MAX_TTL_MS, else ERR_NONE.
+     While enabled, the multi round inventory (0xd1) and the discovery (0x6B) return arriving
+     PICCs only and applProcessCyclic() streams the departed PICCs with the protocol byte of
+     this command:
+    <table>
+      <tr><th>   Byte</th><th>0</th><th>1..</th></tr>
+      <tr><th>Content</th><td>num_piccs</td><td>PICCs</td></tr>
+    </table>
+     Each PICC is coded by the fingerprint it is stored by, see #uidSetFingerprint():
+    <table>
+      <tr><th>   Byte</th><th>0..3</th></tr>
+      <tr><th>Content</th><td>fingerprint</td></tr>
+    </table>
+     Its top 3 bits are the technology: 1 ISO15693, 2 NFC-A, 3 NFC-B, 4 FeliCa, 5 ST25TB.
+     The host maps it back to the UID reported on arrival.
+
+  -  RFAL UID Set Benchmark: feeds synthetic UIDs of all technologies through the seen-set
+    <table>
+      <tr><th>   Byte</th> <th>0</th> <th>1..2</th> <th>3..4</th> </tr>
+      <tr><th>Content</th><td>0x64(ID)</td> <td>number of PICCs</td> <td>rounds seeing all again</td> </tr>
+    </table>
+     The PICCs arrive, are seen again for the given rounds within their TTL and finally depart.
+     Clears and disables the set. Returns ERR_PARAM if more than #UID_SET_MAX_ENTRIES PICCs are
+     asked, ERR_INTERNAL if arrivals or departures were miscounted, else ERR_NONE and response is:
+    <table>
+      <tr><th>   Byte</th><th>0..1</th><th>2..3</th><th>4..5</th><th>6..9</th><th>10..13</th><th>14..17</th><th>18..21</th></tr>
+      <tr><th>Content</th><td>arrivals</td><td>arrivals while present</td><td>departures</td><td>ms generating UIDs</td><td>ms inserting</td><td>ms seeing again</td><td>ms expiring</td></tr>
+    </table>
+     The generation time is included in the insert and seen again times, subtract it once per round.
+
+  -  RFAL ISO-DEP Pipe Write: streams a command APDU of any length, see #iso14443L4PipeWrite()
+    <table>
+      <tr><th>   Byte</th> <th>0</th> <th>1</th> <th>2..</th> </tr>
+      <tr><th>Content</th><td>0x65(ID)</td> <td>options</td> <td>next bytes of the APDU</td> </tr>
+    </table>
+     options: bit 0 set = these bytes end the APDU.
+     The PICC must be in protocol mode (0xA3 or 0xB3). The first write starts the exchange, each
+     I-block is sent as soon as it is complete. Returns ERR_BUSY if the bytes do not fit right now:
+     nothing was taken, send them again. Else ERR_NONE and response is:
+    <table>
+      <tr><th>   Byte</th><th>0..1</th></tr>
+      <tr><th>Content</th><td>bytes the next write can take</td></tr>
+    </table>
+     While the exchange runs, commands other than 0x65 and 0x66 are refused with ERR_BUSY.
+     The response APDU is streamed by applProcessCyclic() with the protocol byte of the first
+     write, I-block by I-block as received:
+    <table>
+      <tr><th>   Byte</th><th>0</th><th>1..</th></tr>
+      <tr><th>Content</th><td>0x01</td><td>next bytes of the response</td></tr>
+    </table>
+     followed by a summary with the result of the exchange as status:
+    <table>
+      <tr><th>   Byte</th><th>0</th><th>1..4</th><th>5..8</th><th>9..12</th><th>13..16</th></tr>
+      <tr><th>Content</th><td>0x02</td><td>command bytes</td><td>response bytes</td><td>ms from last write to first response byte</td><td>ms from first write to end</td></tr>
+    </table>
+
+  -  RFAL ISO-DEP Pipe Abort: stops the exchange of 0x65 without summary
+    <table>
+      <tr><th>   Byte</th> <th>0</th> </tr>
+      <tr><th>Content</th><td>0x66(ID)</td> </tr>
+    </table>
+     returns status ERR_NONE. The PICC should be deselected afterwards.
+
+  -  RFAL ISO-DEP Activate: enters protocol mode at the highest common bit rate and frame size,
+     see #iso14443AActivate() and #iso14443BActivate()
+    <table>
+      <tr><th>   Byte</th> <th>0</th> <th>1</th> <th>2</th> <th>3..14</th> </tr>
+      <tr><th>Content</th><td>0x67(ID)</td> <td>max bit rate</td> <td>did</td> <td>ATQB (NFC-B only)</td> </tr>
+    </table>
+     max bit rate: highest rfalBitRate to negotiate, 0: 106 .. 3: 848kbps.
+     did: card id to assign, ignored if the PICC does not support it.
+     In NFC-A mode the PICC must be selected (0xA1), RATS and PPS are sent. In NFC-B mode the
+     ATQB is bytes 0..11 of the response of 0xB1, ATTRIB is sent. FSD is the largest the I-block
+     buffer takes. Returns ERR_WRONG_STATE outside NFC-A/NFC-B mode, else the result and response is:
+    <table>
+      <tr><th>   Byte</th><th>0</th><th>1</th><th>2..3</th><th>4..5</th><th>6</th><th>7</th><th>8</th><th>9</th><th>10..</th></tr>
+      <tr><th>Content</th><td>dsi</td><td>dri</td><td>fsc</td><td>fsd</td><td>fwi</td><td>sfgi</td><td>did</td><td>answer_len</td><td>ATS or ATTRIB response</td></tr>
+    </table>
+     dsi and dri are the agreed rfalBitRate PICC to PCD and PCD to PICC.
+
+  -  RFAL ISO-DEP Benchmark: exchanges the same APDU repeatedly to measure the throughput
+    <table>
+      <tr><th>   Byte</th> <th>0</th> <th>1..2</th> <th>3..</th> </tr>
+      <tr><th>Content</th><td>0x68(ID)</td> <td>rounds</td> <td>APDU</td> </tr>
+    </table>
+     PICC must be in protocol mode (0xA4, 0xB3 or 0x67). Stops at the first failed exchange,
+     returns its status and response is:
+    <table>
+      <tr><th>   Byte</th><th>0..1</th><th>2..5</th><th>6..9</th><th>10..</th></tr>
+      <tr><th>Content</th><td>rounds done</td><td>ms taken</td><td>APDU bytes per s, both directions</td><td>last response</td></tr>
+    </table>
+
+  -  RFAL NFC-B Resolve All: slotted anticollision returning all PICCs at once, see #iso14443BResolveAll()
+    <table>
+      <tr><th>   Byte</th> <th>0</th> <th>1</th> <th>2</th> <th>3</th> <th>4</th> </tr>
+      <tr><th>Content</th><td>0x69(ID)</td> <td>afi</td> <td>init slots</td> <td>end slots</td> <td>max cards</td> </tr>
+    </table>
+     Slots are coded as N of REQB (0=1,1=2,2=4,3=8,4=16), max cards 1..#ISO14443B_MAX_CARDS,
+     0 takes the maximum. Returns ERR_WRONG_STATE outside NFC-B mode. *txSize must allow
+     2 + 12 * max cards return values. The PICCs found are returned also if the resolution
+     broke off with an error. Response is:
+    <table>
+      <tr><th>   Byte</th><th>0</th><th>1</th><th>2..</th></tr>
+      <tr><th>Content</th><td>num cards</td><td>collisions pending</td><td>one ATQB per card</td></tr>
+    </table>
+     Each ATQB is as bytes 0..11 of the response of 0xB1: atqb, pupi, app data, protocol info.
+     The last PICC is not halted and can be activated with 0x67 right away.
+
+  -  RFAL ST25TB Dump: resolves all ST25TB tags and streams the same block range of each,
+     see #iso14443B_ST25TB_DumpInit()
+    <table>
+      <tr><th>   Byte</th> <th>0</th> <th>1</th> <th>2</th> <th>3</th> <th>4</th> </tr>
+      <tr><th>Content</th><td>0x6A(ID)</td> <td>first block</td> <td>last block</td> <td>options</td> <td>max tags</td> </tr>
+    </table>
+     options: bit0 sends Completion to each tag once read, it keeps silent until the field is reset.
+     max tags 1..#ISO14443B_ST25TB_MAX_TAGS, 0 or missing takes the maximum. The block range must
+     exist on all tags (0..15 on ST25TB512). Returns ERR_WRONG_STATE outside NFC-B mode (0xb0),
+     ERR_NOTFOUND without tags, else the number of tags found:
+    <table>
+      <tr><th>   Byte</th><th>0</th></tr>
+      <tr><th>Content</th><td>num tags</td></tr>
+    </table>
+     The blocks follow as records streamed by applProcessCyclic(), chunks of one tag at a time:
+    <table>
+      <tr><th>   Byte</th><th>0</th><th>1</th><th>2..9</th><th>10</th><th>11</th><th>12..</th></tr>
+      <tr><th>Content</th><td>0x01</td><td>chip id</td><td>uid</td><td>first block</td><td>num blocks</td><td>4 bytes per block</td></tr>
+    </table>
+     A tag failing 3 times on a block is skipped; its chunk may hold 0 blocks. Summary, status of
+     the last chunk:
+    <table>
+      <tr><th>   Byte</th><th>0</th><th>1</th><th>2</th><th>3..6</th><th>7..8</th><th>9..10</th><th>11..14</th><th>15..18</th></tr>
+      <tr><th>Content</th><td>0x02</td><td>tags</td><td>tags skipped</td><td>bytes</td><td>frames</td><td>retries</td><td>ms</td><td>bytes per s</td></tr>
+    </table>
+
+  -  RFAL Discover: polls several technologies in the order given and returns all PICCs found,
+     see #discoveryRun()
+    <table>
+      <tr><th>   Byte</th> <th>0</th> <th>1</th> <th>2</th> <th>3..</th> </tr>
+      <tr><th>Content</th><td>0x6B(ID)</td> <td>options</td> <td>max devices</td> <td>technology, budget ms (per step)</td></tr>
+    </table>
+     Technologies: 1 ISO15693, 2 NFC-A, 3 NFC-B, 4 FeliCa, 5 ST25TB, 6 Kovio, up to
+     #DISCOVERY_MAX_STEPS steps. A technology is polled again until a PICC answers or its budget
+     is over, budget 0 polls once. options: bit0 stops after the first technology which found
+     PICCs. max devices 1..#DISCOVERY_MAX_DEVICES, 0 takes the maximum. The field stays on
+     between the technologies; the next protocol command initializes its technology again.
+     While the UID seen-set is enabled (0x63) only arriving PICCs are returned.
+     *txSize must allow 6 + 43 * max devices return values. Response is:
+    <table>
+      <tr><th>   Byte</th><th>0</th><th>1</th><th>2..5</th><th>6..</th></tr>
+      <tr><th>Content</th><td>num devices</td><td>polls</td><td>ms</td><td>devices</td></tr>
+    </table>
+     Each device is coded as:
+    <table>
+      <tr><th>   Byte</th><th>0</th><th>1</th><th>2..</th><th>..</th><th>..</th></tr>
+      <tr><th>Content</th><td>technology</td><td>id length</td><td>id</td><td>info length</td><td>info</td></tr>
+    </table>
+     id and info as of #DISCOVERY_TECH_NFCA and the other DISCOVERY_TECH_xxx.
+
+  -  RFAL Protocol Switch Config: how #processProtocols() changes between the protocols
+    <table>
+      <tr><th>   Byte</th> <th>0</th> <th>1</th> </tr>
+      <tr><th>Content</th><td>0x6C(ID)</td> <td>options</td> </tr>
+    </table>
+     options: bit0 keeps the field on when a command of another protocol comes in. The old
+     protocol is deinitialized without field off and the 10 ms reset pause is left out, so the
+     PICCs keep their state. If the RF still has the mode and bit rates of the new protocol's
+     initialization (e.g. kovio and ISO14443A, or the same protocol again after its deinitialize
+     command) the initialization and its guard time are skipped, otherwise only the mode is set.
+     Changes from NFC-DEP always switch the field off. Default is off. Returns the counters
+     since the last config command and clears them:
+    <table>
+      <tr><th>   Byte</th><th>0..1</th><th>2..3</th><th>4..5</th><th>6..9</th></tr>
+      <tr><th>Content</th><td>protocol changes</td><td>field kept</td><td>initializations skipped</td><td>ms spent</td></tr>
+    </table>
+
   */
 static uint8_t processCmd ( const uint8_t * rxData, uint16_t rxSize, uint8_t * txData, uint16_t *txSize)
 {
@@ -653,6 +1159,25 @@ static uint8_t processCmd ( const uint8_t * rxData, uint16_t rxSize, uint8_t * t
       first_command_received = 41;
     }
 
+    if ((ERR_BUSY == rfalCoroutineGetStatus()) && (cmd != RFAL_CMD_CO_GET_STATUS) && (cmd != RFAL_CMD_CO_ABORT))
+    { /* RF is owned by the background operation */
+        if (*txSize) *txSize = 0;
+        return (uint8_t)ERR_BUSY;
+    }
+
+    if (iso14443L4PipeIsActive() && (cmd != RFAL_CMD_ISO_DEP_PIPE_WRITE) && (cmd != RFAL_CMD_ISO_DEP_PIPE_ABORT))
+    { /* RF is owned by the APDU pipe */
+        if (*txSize) *txSize = 0;
+        return (uint8_t)ERR_BUSY;
+    }
+
+    if (nfcDepPipeIsActive() && (cmd != NFC_CMD_NFCDEP_TX_PART) && (cmd != NFC_CMD_NFCDEP_TX)
+        && (cmd != NFC_CMD_NFCDEP_RX) && (cmd != NFC_CMD_DEINITIALIZE))
+    { /* RF is owned by the NFC-DEP pipe */
+        if (*txSize) *txSize = 0;
+        return (uint8_t)ERR_BUSY;
+    }
+
     if (cmd == 0x15)
     {
        err = processDirectCommand(buf, bufSize, txData, txSize);
@@ -864,7 +1389,7 @@ static uint8_t processCmd ( const uint8_t * rxData, uint16_t rxSize, uint8_t * t
         err = rfalTransceiveBlockingRx();
 
         if( err != ERR_BUSY )
-        {
+        { /* the only copy, the response is transmitted by DMA in place */
             ST_MEMCPY( (uint8_t*)&txData[2], gRxBuf, rfalConvBitsToBytes(gRcvdLen) );
         }
         txData[0] = ((gRcvdLen>>8)&0xFF);
@@ -899,7 +1424,7 @@ static uint8_t processCmd ( const uint8_t * rxData, uint16_t rxSize, uint8_t * t
         err = rfalGetTransceiveStatus();
 
         if( err != ERR_BUSY )
-        {
+        { /* the only copy, the response is transmitted by DMA in place */
             ST_MEMCPY( (uint8_t*)&txData[2], gRxBuf, rfalConvBitsToBytes(gRcvdLen) );
         }
         txData[0] = ((gRcvdLen>>8)&0xFF);
@@ -977,88 +1502,751 @@ static uint8_t processCmd ( const uint8_t * rxData, uint16_t rxSize, uint8_t * t
 
         if (*txSize) *txSize = (2 + MIN( rcvdLen, (*txSize - 2)) );
     }
+    if (cmd == RFAL_CMD_CO_MIFARE_UL_READ)
+    {
+        if (bufSize < 2) return (uint8_t)ERR_PARAM;
 
+        coMfuActLen = 0;
+        coCtx.mfu.startAddr = buf[0];
+        coCtx.mfu.readbuf   = gRxBuf;
+        coCtx.mfu.length    = buf[1];
+        coCtx.mfu.actLength = &coMfuActLen;
 
-    if ((cmd>>4) >= 0x8)
-        err = processProtocols(rxData, rxSize, txData, txSize);
+        streamsStop();
+        coCmd = cmd;
+        err = rfalCoroutineStart( mifareUlReadNBytesCo, &coCtx.mfu );
+        if (*txSize) *txSize = 0;
+    }
+    if (cmd == RFAL_CMD_CO_ISO14443_L4_TXRX)
+    {
+        coL4ActLen = 0;
+        coCtx.l4.txbuf       = buf;
+        coCtx.l4.txlen       = bufSize;
+        coCtx.l4.rxbuf       = gRxBuf;
+        coCtx.l4.rxlen       = sizeof(gRxBuf);
+        coCtx.l4.actrxlength = &coL4ActLen;
+
+        streamsStop();
+        coCmd = cmd;
+        err = rfalCoroutineStart( iso14443TransmitAndReceiveL4Co, &coCtx.l4 );
+        if (ERR_NONE == err)
+        { /* run up to the first transceive while buf is still valid */
+            rfalCoroutineWorker();
+        }
+        if (*txSize) *txSize = 0;
+    }
+    if (cmd == RFAL_CMD_CO_TOPAZ_READ_ALL)
+    {
+        if (bufSize < TOPAZ_UID_LENGTH) return (uint8_t)ERR_PARAM;
+
+        coTopazActLen = 0;
+        ST_MEMCPY(coTopazCard.uid, buf, TOPAZ_UID_LENGTH);
+        coCtx.topaz.card    = &coTopazCard;
+        coCtx.topaz.buf     = gRxBuf;
+        coCtx.topaz.bufSize = sizeof(gRxBuf);
+        coCtx.topaz.actSize = &coTopazActLen;
+
+        streamsStop();
+        coCmd = cmd;
+        err = rfalCoroutineStart( topazReadAllCo, &coCtx.topaz );
+        if (*txSize) *txSize = 0;
+    }
+    if (cmd == RFAL_CMD_CO_GET_STATUS)
+    {
+        uint16_t len = 0;
 
-    return err;
-}
+        err = rfalCoroutineGetStatus();
 
-uint8_t applProcessCmd( uint8_t protocol, uint16_t rxSize, const uint8_t * rxData, uint16_t * txSize, uint8_t * txData )
-{ /* forward to different function to have place for doxygen documentation
-     because applProcessCmd is already documented in usb_hid_stream_driver.h*/
-    return processCmd( rxData, rxSize, txData, txSize);
-}
+        if( err != ERR_BUSY )
+        {
+            if (coCmd == RFAL_CMD_CO_MIFARE_UL_READ)
+                len = coMfuActLen;
+            else if (coCmd == RFAL_CMD_CO_TOPAZ_READ_ALL)
+                len = coTopazActLen;
+            else
+                len = coL4ActLen;
+        }
+        len = MIN( len, ((*txSize > 2) ? (*txSize - 2) : 0) );
 
+        if (*txSize >= 2)
+        {
+            ST_MEMCPY( (uint8_t*)&txData[2], gRxBuf, len );
+            txData[0] = ((len>>8)&0xFF);
+            txData[1] = ((len>>0)&0xFF);
+            *txSize = 2 + len;
+        }
+    }
+    if (cmd == RFAL_CMD_CO_ABORT)
+    {
+        rfalCoroutineAbort();
+        err = ERR_NONE;
+        if (*txSize) *txSize = 0;
+    }
+    if (cmd == RFAL_CMD_SCRIPT_LOAD)
+    {
+        uint16_t offset;
 
-/*!
-  This function processes certain interrupts and stores results retrieved for
-  later transmission over USB */
-void dispatcherInterruptHandler()
-{
-    int i;
-    uint8_t val;
-    uint16_t isrs;
+        if (*txSize) *txSize = 0;
+        if (bufSize < 2) return (uint8_t)ERR_PARAM;
+        offset = ((buf[0]<<8) | buf[1]);
+        if (offset == 0)
+        {
+            scriptLen = 0;
+        }
+        if (offset != scriptLen) return (uint8_t)ERR_PARAM;
+        if ((bufSize - 2) > (sizeof(scriptBuf) - scriptLen)) return (uint8_t)ERR_NOMEM;
 
-    for (i=0; i<24; i++)
+        ST_MEMCPY( &scriptBuf[scriptLen], &buf[2], (bufSize - 2) );
+        scriptLen += (bufSize - 2);
+        err = ERR_NONE;
+    }
+    if (cmd == RFAL_CMD_SCRIPT_RUN)
     {
-        if(dispatcherInterruptResultRegs[i] >= 0x40) continue;
-        if(!st25r3911GetInterrupt(1UL<<i)) continue;
-
-        isrs = dispatcherInterruptResults[i] >> 8;
-        if (isrs < 255) isrs++;
+        err = processScript( buf, bufSize, txData, txSize );
+    }
+    if (cmd == RFAL_CMD_GET_FIFO_STATS)
+    {
+        rfalFIFOStats stats;
+        uint16_t      values[7];
+        uint8_t       i;
 
-        st25r3911ReadRegister(dispatcherInterruptResultRegs[i], &val);
+        if (*txSize < sizeof(values)) return (uint8_t)ERR_PARAM;
 
-        dispatcherInterruptResults[i] = (isrs<<8) | val;
+        rfalGetFIFOStats( &stats );
+        if ((bufSize > 0) && (buf[0] != 0))
+        {
+            rfalClearFIFOStats();
+        }
+        values[0] = stats.txReloads;
+        values[1] = stats.txNearMiss;
+        values[2] = stats.txUnderflow;
+        values[3] = stats.rxReads;
+        values[4] = stats.rxNearMiss;
+        values[5] = stats.rxOverflow;
+        values[6] = stats.latencyMaxUs;
+        for (i = 0; i < 7; i++)
+        {
+            txData[2*i + 0] = ((values[i]>>8)&0xFF);
+            txData[2*i + 1] = ((values[i]>>0)&0xFF);
+        }
+        err = ERR_NONE;
+        if (*txSize) *txSize = sizeof(values);
     }
-}
-
-/*
-******************************************************************************
-* LOCAL FUNCTIONS
-******************************************************************************
-*/
+    if (cmd == RFAL_CMD_CRC_BENCHMARK)
+    {
+        static const uint16_t sizes[] = { 1, 16, 64, 256, 1024 };
+        uint8_t  *data   = &txData[CRC_BENCHMARK_DATA_OFFSET];
+        uint16_t  maxLen;
+        uint16_t  iterations;
+        uint16_t  len;
+        uint16_t  n;
+        uint16_t  txPos  = 3;
+        uint32_t  seed   = 0x12345678;
+        uint32_t  ms[2];
+        uint8_t   i;
+
+        if ((bufSize < 2) || (*txSize <= CRC_BENCHMARK_DATA_OFFSET)) return (uint8_t)ERR_PARAM;
+        iterations = ((buf[0]<<8) | buf[1]);
+        maxLen     = MIN( (*txSize - CRC_BENCHMARK_DATA_OFFSET), 1024 );
+
+        for (len = 0; len < maxLen; len++)
+        {
+            seed      = (seed * 1103515245) + 12345;
+            data[len] = (uint8_t)(seed >> 16);
+        }
 
-/*!
-  Return the interrupt results stored from dispatcherInterruptHandler() via USB to GUI.
-  \param rxData : forward from applProcessCmd()
-  \param rxSize : forward from applProcessCmd()
-  \param txData : forward from applProcessCmd()
-  \param txSize : forward from applProcessCmd()
+        err = ERR_NONE;
+        for (len = 1; len <= maxLen; len++)
+        {
+            if (rfalCrcCalculateCcitt( 0xFFFF, data, len ) != rfalCrcCalculateCcittBitwise( 0xFFFF, data, len ))
+            {
+                err = ERR_CRC;
+                break;
+            }
+        }
+        txData[0] = RFAL_CRC_ENGINE;
+        txData[1] = (((len - 1)>>8)&0xFF);
+        txData[2] = (((len - 1)>>0)&0xFF);
 
-  Implemented commands:
+        for (i = 0; (err == ERR_NONE) && (i < (sizeof(sizes)/sizeof(sizes[0]))) && (sizes[i] <= maxLen); i++)
+        {
+            timerStopwatchStart();
+            for (n = 0; n < iterations; n++)
+            {
+                rfalCrcCalculateCcittBitwise( 0xFFFF, data, sizes[i] );
+            }
+            ms[0] = timerStopwatchMeasure();
 
-  - Get interrupt result:
-  <table>
-    <tr><th>   Byte</th><th>       0</th><th>       1</th></tr>
-    <tr><th>Content</th><td>0x21(ID)</td><td>0..23:irq in question</td></tr>
-  </table>
-  txSize needs to accomodate 2 bytes of response:
-  <table>
-    <tr><th>   Byte</th><th>       0</th><th>           1</th></tr>
-    <tr><th>Content</th><td>num of isrs occurred</td><td>last result</td></tr>
-  </table>
-    Currently supported interrups and corresponding results are:
-    - Wakeup Capacitive IRQ(16): ST25R3911_REG_CAPACITANCE_MEASURE_RESULT
-    - Wakeup Phase IRQ(17)     : ST25R3911_REG_PHASE_MEASURE_RESULT
-    - Wakeup Amplituted IRQ(18): ST25R3911_REG_AMPLITUDE_MEASURE_RESULT
-  */
-static ReturnCode processInterruptResult(const uint8_t *rxData, uint16_t rxSize, uint8_t *txData, uint16_t *txSize)
-{
-    if(rxSize < 1) return ERR_REQUEST;
-    if(rxData[0] > 23) return ERR_PARAM;
-    if(dispatcherInterruptResultRegs[rxData[0]] > 0x3f) return ERR_PARAM;
-    if(*txSize < 2) return ERR_PARAM;
+            timerStopwatchStart();
+            for (n = 0; n < iterations; n++)
+            {
+                rfalCrcCalculateCcitt( 0xFFFF, data, sizes[i] );
+            }
+            ms[1] = timerStopwatchMeasure();
 
-    *txSize = 2;
-    txData[0] =  dispatcherInterruptResults[rxData[0]] >> 8;
-    txData[1] =  dispatcherInterruptResults[rxData[0]] & 0xff;
+            txData[txPos++] = ((sizes[i]>>8)&0xFF);
+            txData[txPos++] = ((sizes[i]>>0)&0xFF);
+            for (n = 0; n < 2; n++)
+            {
+                txData[txPos++] = ((ms[n]>>24)&0xFF);
+                txData[txPos++] = ((ms[n]>>16)&0xFF);
+                txData[txPos++] = ((ms[n]>>8)&0xFF);
+                txData[txPos++] = ((ms[n]>>0)&0xFF);
+            }
+        }
+        if (*txSize) *txSize = txPos;
+    }
+    if (cmd == RFAL_CMD_UID_SET_CONFIG)
+    {
+        uint32_t ttl;
 
-    dispatcherInterruptResults[rxData[0]] = 0; /* clear value */
+        if (bufSize < 4) return (uint8_t)ERR_PARAM;
+        ttl = ((uint32_t)buf[0]<<24) | ((uint32_t)buf[1]<<16) | ((uint32_t)buf[2]<<8) | buf[3];
 
-    return ERR_NONE;
+        uidSetEnabled = false;
+        err = uidSetInit(ttl);
+        if ((ERR_NONE == err) && (ttl > 0))
+        {
+            uidSetEnabled  = true;
+            uidSetProtocol = cmdProtocol;
+        }
+        if (*txSize) *txSize = 0;
+    }
+    if (cmd == RFAL_CMD_UID_SET_BENCHMARK)
+    {
+        uint8_t   uid[UID_SET_MAX_UID_LEN];
+        uint32_t  departed[UID_SET_REPORT_MAX_PICCS];
+        uint16_t  counts[3] = { 0, 0, 0 };
+        uint32_t  ms[4];
+        uint16_t  entries;
+        uint16_t  rounds;
+        uint16_t  n;
+        uint16_t  r;
+        uint16_t  cnt;
+        uint32_t  now   = 0;
+        uint8_t   tech;
+        uint8_t   uidLen;
+        bool      arrived;
+        uint8_t   i;
+
+        if ((bufSize < 4) || (*txSize < 22)) return (uint8_t)ERR_PARAM;
+        entries = ((buf[0]<<8) | buf[1]);
+        rounds  = ((buf[2]<<8) | buf[3]);
+        if (entries > UID_SET_MAX_ENTRIES) return (uint8_t)ERR_PARAM;
+
+        uidSetEnabled = false;
+        uidSetInit(UID_SET_BENCHMARK_TTL_MS);
+
+        timerStopwatchStart();
+        for (n = 0; n < entries; n++)
+        {
+            uidSetBenchmarkUid(n, &tech, uid, &uidLen);
+        }
+        ms[0] = timerStopwatchMeasure();
+
+        timerStopwatchStart();
+        for (n = 0; n < entries; n++)
+        {
+            uidSetBenchmarkUid(n, &tech, uid, &uidLen);
+            uidSetSeen(tech, uid, uidLen, now, &arrived);
+            counts[0] += arrived;
+        }
+        ms[1] = timerStopwatchMeasure();
+
+        timerStopwatchStart();
+        for (r = 0; r < rounds; r++)
+        {
+            /* stay within the TTL of the previous round */
+            now += (UID_SET_BENCHMARK_TTL_MS / 2);
+            for (n = 0; n < entries; n++)
+            {
+                uidSetBenchmarkUid(n, &tech, uid, &uidLen);
+                uidSetSeen(tech, uid, uidLen, now, &arrived);
+                counts[1] += arrived;
+            }
+        }
+        ms[2] = timerStopwatchMeasure();
+
+        now += (2 * UID_SET_BENCHMARK_TTL_MS);
+        timerStopwatchStart();
+        do
+        {
+            cnt = uidSetExpire(now, UID_SET_SIZE, departed, UID_SET_REPORT_MAX_PICCS);
+            counts[2] += cnt;
+        } while (cnt == UID_SET_REPORT_MAX_PICCS);
+        ms[3] = timerStopwatchMeasure();
+
+        err = (((counts[0] == entries) && (counts[1] == 0) && (counts[2] == entries)) ? ERR_NONE : ERR_INTERNAL);
+        for (i = 0; i < 3; i++)
+        {
+            txData[2*i + 0] = ((counts[i]>>8)&0xFF);
+            txData[2*i + 1] = ((counts[i]>>0)&0xFF);
+        }
+        for (i = 0; i < 4; i++)
+        {
+            txData[6 + 4*i + 0] = ((ms[i]>>24)&0xFF);
+            txData[6 + 4*i + 1] = ((ms[i]>>16)&0xFF);
+            txData[6 + 4*i + 2] = ((ms[i]>>8)&0xFF);
+            txData[6 + 4*i + 3] = ((ms[i]>>0)&0xFF);
+        }
+        *txSize = 22;
+    }
+    if (cmd == RFAL_CMD_ISO_DEP_PIPE_WRITE)
+    {
+        uint16_t free;
+        bool last;
+
+        if ((bufSize < 1) || (*txSize < 2)) return (uint8_t)ERR_PARAM;
+        last = ((buf[0] & ISO_DEP_PIPE_OPT_LAST) != 0);
+
+        if (!iso14443L4PipeIsActive())
+        {
+            if (isoDepPipeRunning)
+            { /* summary of the previous APDU not sent yet */
+                if (*txSize) *txSize = 0;
+                return (uint8_t)ERR_BUSY;
+            }
+            if ((rfalGetMode() != RFAL_MODE_POLL_NFCA) && (rfalGetMode() != RFAL_MODE_POLL_NFCB))
+            {
+                if (*txSize) *txSize = 0;
+                return (uint8_t)ERR_WRONG_STATE;
+            }
+            streamsStop();
+            isoDepPipeProtocol = cmdProtocol;
+            isoDepPipeStart    = platformGetSysTick();
+            isoDepPipeTxBytes  = 0;
+            isoDepPipeRxBytes  = 0;
+            isoDepPipeLatency  = 0;
+        }
+
+        err = iso14443L4PipeWrite(&buf[1], bufSize - 1, last);
+        if (iso14443L4PipeIsActive())
+        {
+            isoDepPipeErr     = ERR_BUSY;
+            isoDepPipeRunning = true;
+        }
+        if ((ERR_NONE != err) && (ERR_BUSY != err) && isoDepPipeRunning)
+        { /* failure to send is reported with the summary */
+            iso14443L4PipeAbort();
+            isoDepPipeErr = err;
+            err = ERR_NONE;
+        }
+        if (ERR_NONE == err)
+        {
+            isoDepPipeTxBytes += (bufSize - 1);
+            isoDepPipeTxEnd = platformGetSysTick();
+        }
+
+        free = iso14443L4PipeTxFree();
+        txData[0] = ((free>>8)&0xFF);
+        txData[1] = ((free>>0)&0xFF);
+        *txSize = ((ERR_NONE == err) ? 2 : 0);
+    }
+    if (cmd == RFAL_CMD_ISO_DEP_PIPE_ABORT)
+    {
+        iso14443L4PipeAbort();
+        isoDepPipeRunning = false;
+        err = ERR_NONE;
+        if (*txSize) *txSize = 0;
+    }
+    if (cmd == RFAL_CMD_ISO_DEP_ACTIVATE)
+    {
+        iso14443L4Activation_t act;
+        iso14443BProximityCard_t card;
+
+        if ((bufSize < 2) || (*txSize < (10 + ISO14443_L4_ANSWER_MAX_LEN))) return (uint8_t)ERR_PARAM;
+
+        if (rfalGetMode() == RFAL_MODE_POLL_NFCA)
+        {
+            err = iso14443AActivate(buf[0], buf[1], &act);
+        }
+        else if (rfalGetMode() == RFAL_MODE_POLL_NFCB)
+        {
+            if (bufSize < (2 + RFAL_NFCB_SENSB_RES_LEN)) return (uint8_t)ERR_PARAM;
+            ST_MEMCPY(&card, &buf[2], RFAL_NFCB_SENSB_RES_LEN);
+            err = iso14443BActivate(&card, buf[0], buf[1], &act);
+        }
+        else
+        {
+            err = ERR_WRONG_STATE;
+        }
+
+        *txSize = 0;
+        if (ERR_NONE == err)
+        {
+            txData[0] = act.dsi;
+            txData[1] = act.dri;
+            txData[2] = ((act.fsc>>8)&0xFF);
+            txData[3] = ((act.fsc>>0)&0xFF);
+            txData[4] = ((act.fsd>>8)&0xFF);
+            txData[5] = ((act.fsd>>0)&0xFF);
+            txData[6] = act.fwi;
+            txData[7] = act.sfgi;
+            txData[8] = act.did;
+            txData[9] = act.answerLen;
+            ST_MEMCPY(&txData[10], act.answer, act.answerLen);
+            *txSize = 10 + act.answerLen;
+            logUsart("ISO-DEP activated: DSI %d DRI %d FSC %d FSD %d\n", act.dsi, act.dri, act.fsc, act.fsd);
+        }
+    }
+    if (cmd == RFAL_CMD_ISO_DEP_BENCHMARK)
+    {
+        uint16_t rounds;
+        uint16_t n;
+        uint16_t rxLen = 0;
+        uint32_t bytes = 0;
+        uint32_t ms;
+        uint32_t rate;
+
+        if ((bufSize < 3) || (*txSize < 10)) return (uint8_t)ERR_PARAM;
+        rounds = ((buf[0]<<8) | buf[1]);
+
+        err = ERR_NONE;
+        timerStopwatchStart();
+        for (n = 0; (n < rounds) && (ERR_NONE == err); n++)
+        {
+            err = iso14443TransmitAndReceiveL4(&buf[2], bufSize - 2, &txData[10], *txSize - 10, &rxLen);
+            if (ERR_NONE == err)
+            {
+                bytes += (bufSize - 2) + rxLen;
+            }
+        }
+        ms = timerStopwatchMeasure();
+        if (ERR_NONE != err)
+        {
+            n--;
+        }
+        rate = (ms ? ((bytes * 1000UL) / ms) : 0);
+
+        txData[0] = ((n>>8)&0xFF);
+        txData[1] = ((n>>0)&0xFF);
+        txData[2] = ((ms>>24)&0xFF);
+        txData[3] = ((ms>>16)&0xFF);
+        txData[4] = ((ms>>8)&0xFF);
+        txData[5] = ((ms>>0)&0xFF);
+        txData[6] = ((rate>>24)&0xFF);
+        txData[7] = ((rate>>16)&0xFF);
+        txData[8] = ((rate>>8)&0xFF);
+        txData[9] = ((rate>>0)&0xFF);
+        *txSize = 10 + ((ERR_NONE == err) ? rxLen : 0);
+    }
+    if (cmd == RFAL_CMD_NFCB_RESOLVE_ALL)
+    {
+        uint8_t maxCards = ISO14443B_MAX_CARDS;
+        uint8_t cnt = 0;
+        bool colPending = false;
+        uint8_t i;
+
+        if (bufSize < 3) return (uint8_t)ERR_PARAM;
+        if ((bufSize > 3) && (buf[3] > 0)) maxCards = MIN(buf[3], ISO14443B_MAX_CARDS);
+        if (*txSize < (2 + maxCards * ISO14443B_ATQB_LENGTH)) return (uint8_t)ERR_PARAM;
+
+        *txSize = 0;
+        if (rfalGetMode() != RFAL_MODE_POLL_NFCB)
+        {
+            return (uint8_t)ERR_WRONG_STATE;
+        }
+
+        err = iso14443BResolveAll(buf[0], (iso14443BSlotCount_t)buf[1], (iso14443BSlotCount_t)buf[2],
+                                  nfcbCards, maxCards, &cnt, &colPending);
+        txData[0] = cnt;
+        txData[1] = (colPending ? 1 : 0);
+        for (i = 0; i < cnt; i++)
+        {
+            ST_MEMCPY(&txData[2 + i * ISO14443B_ATQB_LENGTH], &nfcbCards[i], ISO14443B_ATQB_LENGTH);
+            logUsart("ISO14443B/NFC-B card found. UID: %s\n", hex2Str(nfcbCards[i].pupi, ISO14443B_PUPI_LENGTH));
+        }
+        *txSize = 2 + cnt * ISO14443B_ATQB_LENGTH;
+    }
+    if (cmd == RFAL_CMD_ST25TB_DUMP)
+    {
+        uint8_t maxTags = ISO14443B_ST25TB_MAX_TAGS;
+
+        if ((bufSize < 3) || (*txSize < 1)) return (uint8_t)ERR_PARAM;
+        if ((bufSize > 3) && (buf[3] > 0)) maxTags = MIN(buf[3], ISO14443B_ST25TB_MAX_TAGS);
+
+        *txSize = 0;
+        if (rfalGetMode() != RFAL_MODE_POLL_NFCB)
+        {
+            return (uint8_t)ERR_WRONG_STATE;
+        }
+
+        streamsStop();
+        err = iso14443B_ST25TB_DumpInit(&st25tbDump, buf[0], buf[1], maxTags, ((buf[2] & ST25TB_DUMP_OPT_COMPLETE) != 0));
+        st25tbDumpErr      = ERR_NONE;
+        st25tbDumpProtocol = cmdProtocol;
+        st25tbDumpStart    = platformGetSysTick();
+        st25tbDumpRunning  = (ERR_NONE == err);
+        if (ERR_NONE == err)
+        {
+            txData[0] = st25tbDump.numTags;
+            *txSize = 1;
+        }
+    }
+    if (cmd == RFAL_CMD_PROTOCOL_SWITCH_CONFIG)
+    {
+        if (bufSize < 1) return (uint8_t)ERR_PARAM;
+        if (*txSize < 10) return (uint8_t)ERR_PARAM;
+
+        txData[0] = ((protocolSwitches>>8)&0xFF);
+        txData[1] = ((protocolSwitches>>0)&0xFF);
+        txData[2] = ((protocolFieldKept>>8)&0xFF);
+        txData[3] = ((protocolFieldKept>>0)&0xFF);
+        txData[4] = ((protocolInitSkipped>>8)&0xFF);
+        txData[5] = ((protocolInitSkipped>>0)&0xFF);
+        txData[6] = ((protocolSwitchMs>>24)&0xFF);
+        txData[7] = ((protocolSwitchMs>>16)&0xFF);
+        txData[8] = ((protocolSwitchMs>>8)&0xFF);
+        txData[9] = ((protocolSwitchMs>>0)&0xFF);
+        *txSize = 10;
+
+        protocolKeepField   = ((buf[0] & PROTOCOL_SWITCH_OPT_KEEP_FIELD) != 0);
+        protocolSwitches    = 0;
+        protocolFieldKept   = 0;
+        protocolInitSkipped = 0;
+        protocolSwitchMs    = 0;
+    }
+    if (cmd == RFAL_CMD_DISCOVER)
+    {
+        discoveryStep_t steps[DISCOVERY_MAX_STEPS];
+        uint8_t maxDevices = DISCOVERY_MAX_DEVICES;
+        uint8_t numSteps;
+        uint8_t numDevices = 0;
+        uint16_t polls = 0;
+        uint16_t pos;
+        uint32_t ms;
+        uint8_t i;
+
+        if ((bufSize < 4) || (((bufSize - 2) % 2) != 0)) return (uint8_t)ERR_PARAM;
+        numSteps = (uint8_t)MIN((bufSize - 2) / 2, DISCOVERY_MAX_STEPS + 1);
+        if (buf[1] > 0) maxDevices = MIN(buf[1], DISCOVERY_MAX_DEVICES);
+        if (*txSize < (DISCOVERY_HDR_LEN + maxDevices * DISCOVERY_DEVICE_MAX_LEN)) return (uint8_t)ERR_PARAM;
+        *txSize = 0;
+        if (numSteps > DISCOVERY_MAX_STEPS) return (uint8_t)ERR_PARAM;
+
+        for (i = 0; i < numSteps; i++)
+        {
+            steps[i].tech     = buf[2 + 2 * i];
+            steps[i].budgetMs = buf[3 + 2 * i];
+        }
+
+        /* the technologies share the RF with the streams */
+        streamsStop();
+        timerStopwatchStart();
+        err = discoveryRun(steps, numSteps, buf[0], discoveryDevices, maxDevices, &numDevices, &polls);
+        ms = timerStopwatchMeasure();
+        /* RF is in the mode of the last technology polled now */
+        protocolActive = 0;
+
+        if (uidSetEnabled)
+        { /* report arrivals only; a full set or kovio cannot tell, so report those too */
+            uint8_t arrivals = 0;
+            bool arrived;
+
+            for (i = 0; i < numDevices; i++)
+            {
+                if ((ERR_NONE != uidSetSeen(discoveryDevices[i].tech, discoveryDevices[i].id, discoveryDevices[i].idLen, platformGetSysTick(), &arrived)) || arrived)
+                {
+                    discoveryDevices[arrivals++] = discoveryDevices[i];
+                }
+            }
+            numDevices = arrivals;
+        }
+
+        txData[0] = numDevices;
+        txData[1] = (uint8_t)MIN(polls, 0xFF);
+        txData[2] = ((ms>>24)&0xFF);
+        txData[3] = ((ms>>16)&0xFF);
+        txData[4] = ((ms>>8)&0xFF);
+        txData[5] = ((ms>>0)&0xFF);
+        pos = DISCOVERY_HDR_LEN;
+        for (i = 0; i < numDevices; i++)
+        {
+            txData[pos++] = discoveryDevices[i].tech;
+            txData[pos++] = discoveryDevices[i].idLen;
+            ST_MEMCPY(&txData[pos], discoveryDevices[i].id, discoveryDevices[i].idLen);
+            pos += discoveryDevices[i].idLen;
+            txData[pos++] = discoveryDevices[i].infoLen;
+            ST_MEMCPY(&txData[pos], discoveryDevices[i].info, discoveryDevices[i].infoLen);
+            pos += discoveryDevices[i].infoLen;
+        }
+        *txSize = pos;
+        logUsart("Discovery: %d devices, %d polls, %d ms\n", numDevices, polls, ms);
+    }
+    if (cmd == RFAL_CMD_TXRX_SEQUENCE)
+    {
+        uint8_t  nFrames;
+        uint8_t  options;
+        uint8_t  nDone   = 0;
+        uint16_t rxPos   = 2;   /* read position in buf  */
+        uint16_t txPos   = 1;   /* write position in txData */
+        uint32_t fdtPoll = rfalGetFDTPoll();
+
+        if ((bufSize < 2) || (*txSize < 1))
+        {
+            if (*txSize) *txSize = 0;
+            return (uint8_t)ERR_PARAM;
+        }
+        nFrames = buf[0];
+        options = buf[1];
+        err     = ERR_NONE;
+
+        while (nDone < nFrames)
+        {
+            const uint8_t *frame = &buf[rxPos];
+            uint16_t txLen;
+            uint32_t flags;
+            uint32_t fwt;
+            uint32_t gt;
+            uint16_t rcvdLen = 0;
+            uint32_t us;
+            ReturnCode ret;
+
+            if ((bufSize - rxPos) < TXRX_SEQUENCE_FRAME_HDR_LEN)
+            {
+                err = ERR_PARAM;
+                break;
+            }
+            txLen = ((frame[0]<<8) | frame[1]);
+            if ((bufSize - rxPos - TXRX_SEQUENCE_FRAME_HDR_LEN) < txLen)
+            {
+                err = ERR_PARAM;
+                break;
+            }
+            if ((*txSize - txPos) < TXRX_SEQUENCE_RESULT_HDR_LEN)
+            {
+                err = ERR_NOMEM;
+                break;
+            }
+            flags = ((frame[2+txLen+0]<<24) | (frame[2+txLen+1]<<16) | (frame[2+txLen+2]<<8) | (frame[2+txLen+3]) );
+            fwt   = ((frame[2+txLen+4+0]<<24) | (frame[2+txLen+4+1]<<16) | (frame[2+txLen+4+2]<<8) | (frame[2+txLen+4+3]) );
+            gt    = ((frame[2+txLen+8+0]<<24) | (frame[2+txLen+8+1]<<16) | (frame[2+txLen+8+2]<<8) | (frame[2+txLen+8+3]) );
+            rxPos += TXRX_SEQUENCE_FRAME_HDR_LEN + txLen;
+
+            /* inter frame guard time is enforced by the chip's GP timer */
+            rfalSetFDTPoll( (gt != 0) ? gt : fdtPoll );
+
+            /* response goes straight behind its result header */
+            us  = getUs();
+            ret = rfalTransceiveBlockingTxRx( (uint8_t*)&frame[2], txLen,
+                                              &txData[txPos + TXRX_SEQUENCE_RESULT_HDR_LEN],
+                                              (*txSize - txPos - TXRX_SEQUENCE_RESULT_HDR_LEN),
+                                              &rcvdLen, flags, fwt );
+            us      = getUs() - us;
+            rcvdLen = MIN( rcvdLen, (*txSize - txPos - TXRX_SEQUENCE_RESULT_HDR_LEN) );
+
+            txData[txPos + 0] = (uint8_t)ret;
+            txData[txPos + 1] = ((us>>24)&0xFF);
+            txData[txPos + 2] = ((us>>16)&0xFF);
+            txData[txPos + 3] = ((us>>8)&0xFF);
+            txData[txPos + 4] = ((us>>0)&0xFF);
+            txData[txPos + 5] = ((rcvdLen>>8)&0xFF);
+            txData[txPos + 6] = ((rcvdLen>>0)&0xFF);
+            txPos += TXRX_SEQUENCE_RESULT_HDR_LEN + rcvdLen;
+            nDone++;
+
+            if (ret != ERR_NONE)
+            {
+                if (err == ERR_NONE)
+                {
+                    err = ret;
+                }
+                if (!(options & TXRX_SEQUENCE_OPT_CONTINUE_ON_ERR))
+                {
+                    break;
+                }
+            }
+        }
+        rfalSetFDTPoll( fdtPoll );
+
+        txData[0] = nDone;
+        if (*txSize) *txSize = txPos;
+    }
+
+
+    if ((cmd>>4) >= 0x8)
+        err = processProtocols(rxData, rxSize, txData, txSize);
+    else /* register and RFAL commands may have changed the RF configuration */
+        protocolConfigured = 0;
+
+    return err;
+}
+
+uint8_t applProcessCmd( uint8_t protocol, uint16_t rxSize, const uint8_t * rxData, uint16_t * txSize, uint8_t * txData )
+{ /* forward to different function to have place for doxygen documentation
+     because applProcessCmd is already documented in usb_hid_stream_driver.h*/
+    cmdProtocol = protocol;
+    return processCmd( rxData, rxSize, txData, txSize);
+}
+
+
+/*!
+  This function processes certain interrupts and stores results retrieved for
+  later transmission over USB */
+void dispatcherInterruptHandler()
+{
+    int i;
+    uint8_t val;
+    uint16_t isrs;
+
+    for (i=0; i<24; i++)
+    {
+        if(dispatcherInterruptResultRegs[i] >= 0x40) continue;
+        if(!st25r3911GetInterrupt(1UL<<i)) continue;
+
+        isrs = dispatcherInterruptResults[i] >> 8;
+        if (isrs < 255) isrs++;
+
+        st25r3911ReadRegister(dispatcherInterruptResultRegs[i], &val);
+
+        dispatcherInterruptResults[i] = (isrs<<8) | val;
+    }
+}
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*!
+  Return the interrupt results stored from dispatcherInterruptHandler() via USB to GUI.
+  \param rxData : forward from applProcessCmd()
+  \param rxSize : forward from applProcessCmd()
+  \param txData : forward from applProcessCmd()
+  \param txSize : forward from applProcessCmd()
+
+  Implemented commands:
+
+  - Get interrupt result:
+  <table>
+    <tr><th>   Byte</th><th>       0</th><th>       1</th></tr>
+    <tr><th>Content</th><td>0x21(ID)</td><td>0..23:irq in question</td></tr>
+  </table>
+  txSize needs to accomodate 2 bytes of response:
+  <table>
+    <tr><th>   Byte</th><th>       0</th><th>           1</th></tr>
+    <tr><th>Content</th><td>num of isrs occurred</td><td>last result</td></tr>
+  </table>
+    Currently supported interrups and corresponding results are:
+    - Wakeup Capacitive IRQ(16): ST25R3911_REG_CAPACITANCE_MEASURE_RESULT
+    - Wakeup Phase IRQ(17)     : ST25R3911_REG_PHASE_MEASURE_RESULT
+    - Wakeup Amplituted IRQ(18): ST25R3911_REG_AMPLITUDE_MEASURE_RESULT
+  */
+static ReturnCode processInterruptResult(const uint8_t *rxData, uint16_t rxSize, uint8_t *txData, uint16_t *txSize)
+{
+    if(rxSize < 1) return ERR_REQUEST;
+    if(rxData[0] > 23) return ERR_PARAM;
+    if(dispatcherInterruptResultRegs[rxData[0]] > 0x3f) return ERR_PARAM;
+    if(*txSize < 2) return ERR_PARAM;
+
+    *txSize = 2;
+    txData[0] =  dispatcherInterruptResults[rxData[0]] >> 8;
+    txData[1] =  dispatcherInterruptResults[rxData[0]] & 0xff;
+
+    dispatcherInterruptResults[rxData[0]] = 0; /* clear value */
+
+    return ERR_NONE;
 }
 
 /*!
@@ -1093,6 +2281,47 @@ static ReturnCode processInterruptResult(const uint8_t *rxData, uint16_t rxSize,
       <tr><th>   Byte</th><th> 1..2</th><th>3..6</th></tr>
       <tr><th>Content</th><td>atqa </td><td> uid</td></tr>
     </table>
+  - #topazReadSegment(): RSEG, dynamic memory tags only
+    <table>
+      <tr><th>   Byte</th><th>       0</th><th>1..4</th><th>5</th></tr>
+      <tr><th>Content</th><td>0x96(ID)</td><td>uid</td><td>segment</td></tr>
+    </table>
+    returns the 128 bytes of the segment.
+  - #topazReadBlock(): READ8, dynamic memory tags only
+    <table>
+      <tr><th>   Byte</th><th>       0</th><th>1..4</th><th>5</th></tr>
+      <tr><th>Content</th><td>0x97(ID)</td><td>uid</td><td>block</td></tr>
+    </table>
+    returns the 8 bytes of the block.
+  - #topazWriteBlock(): WRITE-E8 or WRITE-NE8, dynamic memory tags only
+    <table>
+      <tr><th>   Byte</th><th>       0</th><th>1..4</th><th>5</th><th>6</th><th>7..14</th></tr>
+      <tr><th>Content</th><td>0x98(ID)</td><td>uid</td><td>block</td><td>options</td><td>data</td></tr>
+    </table>
+    options: bit0 ORs the data to the block without erasing it (WRITE-NE8).
+    no return value only status
+  - #topazReadMemory(): whole memory by RALL or RSEG, whichever the tag supports
+    <table>
+      <tr><th>   Byte</th><th>       0</th><th>1..4</th></tr>
+      <tr><th>Content</th><td>0x99(ID)</td><td>uid</td></tr>
+    </table>
+    *txSize must allow 7 + memory size (up to 2048) return values. The bytes read are returned also on error:
+    <table>
+      <tr><th>   Byte</th><th>0..1</th><th>2</th><th>3..6</th><th>7..</th></tr>
+      <tr><th>Content</th><td>hr</td><td>frames</td><td>ms</td><td>memory from byte 0</td></tr>
+    </table>
+  - #topazWriteMemory(): consecutive blocks, a block per frame on dynamic memory tags
+    <table>
+      <tr><th>   Byte</th><th>       0</th><th>1..4</th><th>5</th><th>6</th><th>7..</th></tr>
+      <tr><th>Content</th><td>0x9A(ID)</td><td>uid</td><td>first block</td><td>options</td><td>data, n * 8 bytes</td></tr>
+    </table>
+    options: bit0 as 0x98, bit1 allows writing the UID, reserved, lock and OTP blocks 0x0, 0xD..0xF.
+    Static memory tags are written a byte per frame and need erase. Returns ERR_PARAM if the blocks
+    go past the memory or are protected.
+    <table>
+      <tr><th>   Byte</th><th>0</th><th>1..4</th></tr>
+      <tr><th>Content</th><td>frames</td><td>ms</td></tr>
+    </table>
 */
 static ReturnCode processTopaz(const uint8_t *rxData, uint16_t rxSize, uint8_t *txData, uint16_t *txSize)
 {
@@ -1164,6 +2393,70 @@ static ReturnCode processTopaz(const uint8_t *rxData, uint16_t rxSize, uint8_t *
                 err = topazWriteByte(&card, addr, data);
             }
             break;
+        case 0x96:
+            if ((bufSize < 5) || (*txSize < TOPAZ_SEGMENT_LENGTH)) { *txSize = 0; return ERR_PARAM; }
+            ST_MEMCPY(card.uid, buf, TOPAZ_UID_LENGTH);
+            err = topazReadSegment(&card, buf[4], txData);
+            *txSize = ((ERR_NONE == err) ? TOPAZ_SEGMENT_LENGTH : 0);
+            break;
+        case 0x97:
+            if ((bufSize < 5) || (*txSize < TOPAZ_BLOCK_LENGTH)) { *txSize = 0; return ERR_PARAM; }
+            ST_MEMCPY(card.uid, buf, TOPAZ_UID_LENGTH);
+            err = topazReadBlock(&card, buf[4], txData);
+            *txSize = ((ERR_NONE == err) ? TOPAZ_BLOCK_LENGTH : 0);
+            break;
+        case 0x98:
+            *txSize = 0;
+            if (bufSize < (6 + TOPAZ_BLOCK_LENGTH)) return ERR_PARAM;
+            ST_MEMCPY(card.uid, buf, TOPAZ_UID_LENGTH);
+            err = topazWriteBlock(&card, buf[4], &buf[6], ((buf[5] & TOPAZ_WRITE_OPT_NO_ERASE) == 0));
+            break;
+        case 0x99:
+            {
+                uint16_t actSize;
+                uint8_t frames;
+                uint32_t ms;
+
+                if ((bufSize < 4) || (*txSize < TOPAZ_MEM_HDR_LEN)) { *txSize = 0; return ERR_PARAM; }
+                ST_MEMCPY(card.uid, buf, TOPAZ_UID_LENGTH);
+                ST_MEMSET(card.hr, 0, TOPAZ_HR_LENGTH);
+
+                timerStopwatchStart();
+                err = topazReadMemory(&card, &txData[TOPAZ_MEM_HDR_LEN], *txSize - TOPAZ_MEM_HDR_LEN, &actSize, &frames);
+                ms = timerStopwatchMeasure();
+
+                txData[0] = card.hr[0];
+                txData[1] = card.hr[1];
+                txData[2] = frames;
+                txData[3] = ((ms>>24)&0xFF);
+                txData[4] = ((ms>>16)&0xFF);
+                txData[5] = ((ms>>8)&0xFF);
+                txData[6] = ((ms>>0)&0xFF);
+                *txSize = TOPAZ_MEM_HDR_LEN + actSize;
+                logUsart("Topaz memory read: %d bytes, %d frames, %d ms\n", actSize, frames, ms);
+            }
+            break;
+        case 0x9a:
+            {
+                uint8_t frames;
+                uint32_t ms;
+
+                if ((bufSize < 6) || (*txSize < 5)) { *txSize = 0; return ERR_PARAM; }
+                ST_MEMCPY(card.uid, buf, TOPAZ_UID_LENGTH);
+
+                timerStopwatchStart();
+                err = topazWriteMemory(&card, buf[4], &buf[6], bufSize - 6, ((buf[5] & TOPAZ_WRITE_OPT_NO_ERASE) == 0),
+                                       ((buf[5] & TOPAZ_WRITE_OPT_LOCK_OTP) != 0), &frames);
+                ms = timerStopwatchMeasure();
+
+                txData[0] = frames;
+                txData[1] = ((ms>>24)&0xFF);
+                txData[2] = ((ms>>16)&0xFF);
+                txData[3] = ((ms>>8)&0xFF);
+                txData[4] = ((ms>>0)&0xFF);
+                *txSize = 5;
+            }
+            break;
         default:
             err = ERR_PARAM;
             *txSize = 0;
@@ -1203,6 +2496,17 @@ static ReturnCode processTopaz(const uint8_t *rxData, uint16_t rxSize, uint8_t *
       <tr><th>   Byte</th><th> 0..15</th></tr>
       <tr><th>Content</th><td>  uid </td></tr>
     </table>
+  - #kovioCaptureRead() repeated: reads continuously in sync with the bursts of the tag
+    <table>
+      <tr><th>   Byte</th><th>       0</th><th>1..2</th><th>3..4</th></tr>
+      <tr><th>Content</th><td>0x82(ID)</td><td>reads</td><td>max ms</td></tr>
+    </table>
+    Stops after the given number of good reads or the time, the field stays on.
+    Status is ERR_NONE if one read succeeded. *txsize must allow 15 + 32 return values.
+    <table>
+      <tr><th>   Byte</th><th>0..1</th><th>2..3</th><th>4..5</th><th>6..7</th><th>8..11</th><th>12..13</th><th>14</th><th>15..</th></tr>
+      <tr><th>Content</th><td>reads</td><td>CRC errors</td><td>bursts joined late</td><td>windows missed</td><td>ms</td><td>period in us</td><td>uid length</td><td>last uid</td></tr>
+    </table>
 */
 static ReturnCode processKovio(const uint8_t *rxData, uint16_t rxSize, uint8_t *txData, uint16_t *txSize)
 {
@@ -1237,6 +2541,55 @@ static ReturnCode processKovio(const uint8_t *rxData, uint16_t rxSize, uint8_t *
                 *txSize = card.length;
             }
             break;
+        case 0x82:
+            {
+                kovioCapture_t cap;
+                uint16_t count;
+                uint16_t maxMs;
+                uint32_t ms = 0;
+                uint8_t len = 0;
+
+                if ((bufSize < 4) || (*txSize < (KOVIO_CAPTURE_HDR_LEN + KOVIO_UID_LENGTH))) { *txSize = 0; return ERR_PARAM; }
+                count = ((uint16_t)buf[0] << 8) | buf[1];
+                maxMs = ((uint16_t)buf[2] << 8) | buf[3];
+                if (count == 0) { *txSize = 0; return ERR_PARAM; }
+
+                kovioCaptureInit(&cap);
+                timerStopwatchStart();
+                while ((cap.reads < count) && (ms < maxMs))
+                {
+                    err = kovioCaptureRead(&cap, &card);
+                    if (ERR_NONE == err)
+                    {
+                        len = card.length;
+                        ST_MEMCPY(&txData[KOVIO_CAPTURE_HDR_LEN], card.uid, len);
+                    }
+                    ms = timerStopwatchMeasure();
+                }
+                if (cap.reads > 0)
+                {
+                    err = ERR_NONE;
+                }
+
+                txData[0]  = ((cap.reads>>8)&0xFF);
+                txData[1]  = ((cap.reads>>0)&0xFF);
+                txData[2]  = ((cap.crcErrors>>8)&0xFF);
+                txData[3]  = ((cap.crcErrors>>0)&0xFF);
+                txData[4]  = ((cap.partial>>8)&0xFF);
+                txData[5]  = ((cap.partial>>0)&0xFF);
+                txData[6]  = ((cap.misses>>8)&0xFF);
+                txData[7]  = ((cap.misses>>0)&0xFF);
+                txData[8]  = ((ms>>24)&0xFF);
+                txData[9]  = ((ms>>16)&0xFF);
+                txData[10] = ((ms>>8)&0xFF);
+                txData[11] = ((ms>>0)&0xFF);
+                txData[12] = ((cap.periodUs>>8)&0xFF);
+                txData[13] = ((cap.periodUs>>0)&0xFF);
+                txData[14] = len;
+                *txSize = KOVIO_CAPTURE_HDR_LEN + len;
+                logUsart("Kovio capture: %d reads, %d CRC errors, %d ms\n", cap.reads, cap.crcErrors, ms);
+            }
+            break;
         default:
             err = ERR_PARAM;
             *txSize = 0;
@@ -1281,6 +2634,23 @@ static ReturnCode processKovio(const uint8_t *rxData, uint16_t rxSize, uint8_t *
       - 1: sak is one byte long, \e uid is 4 bytes long
       - 2: sak is two bytes long, \e uid is 7 bytes long
       - 3: sak is three bytes long, \e uid is 10 bytes long
+  - #iso14443AResolveAll() resolves all PICCs in the field at once
+    <table>
+      <tr><th>   Byte</th><th>       0</th><th>      1</th><th>        2</th></tr>
+      <tr><th>Content</th><td>0xa2(ID)</td><td>options</td><td>max_cards</td></tr>
+    </table>
+    \e options are ISO14443A_RESOLVE_OPT_xxx, \e max_cards 1..#ISO14443A_MAX_CARDS, 0 takes the maximum.
+    *txSize must allow 1 + 14 * max_cards return values. The PICCs found are returned also if
+    the resolution broke off with an error. Response is:
+    <table>
+      <tr><th>   Byte</th><th>    0    </th><th>1..</th></tr>
+      <tr><th>Content</th><td>num_cards</td><td>one record per card</td></tr>
+    </table>
+    with each record:
+    <table>
+      <tr><th>   Byte</th><th>0..1</th><th> 2 </th><th>   3   </th><th>4..3+uid_len</th></tr>
+      <tr><th>Content</th><td>atqa</td><td>sak</td><td>uid_len</td><td>uid</td></tr>
+    </table>
   - #iso14443ASendHlta()
     <table>
       <tr><th>   Byte</th><th>       0</th></tr>
@@ -1337,7 +2707,31 @@ static ReturnCode processKovio(const uint8_t *rxData, uint16_t rxSize, uint8_t *
       <tr><th>Content</th><td>0xa8(ID)</td><td>start</td><td>data</td></tr>
     </table>
     no return value only status
+  - #mifareUlDumpChunk() reads a whole NTAG/Ultralight, PICC must have been selected using 0xa1
+    <table>
+      <tr><th>   Byte</th><th>       0</th><th>      1</th></tr>
+      <tr><th>Content</th><td>0xa9(ID)</td><td>options</td></tr>
+    </table>
+    Bit 0 of \e options forces READ instead of FAST_READ. The memory size is taken from GET_VERSION.
+    FAST_READ asks as many pages as the stream buffer allows, so a tag takes a few frames.
+    No response data only status, the memory is streamed to the host by applProcessCyclic() with
+    the protocol byte of this command, one record per packet:
+    <table>
+      <tr><th>   Byte</th><th>   0    </th><th> 1..2 </th><th>    3    </th><th>4..3+4*num_pages</th></tr>
+      <tr><th>Content</th><td>0x01    </td><td> page </td><td>num_pages</td><td>data            </td></tr>
+    </table>
+    for every chunk read and finally, with the status of the read:
+    <table>
+      <tr><th>   Byte</th><th>   0    </th><th> 1..8  </th><th>  9..10 </th><th>11..14</th><th>15..16</th><th>17..18 </th><th>19..22</th><th>23..26     </th></tr>
+      <tr><th>Content</th><td>0x02    </td><td>version</td><td>num_pages</td><td>bytes</td><td>frames</td><td>retries</td><td>  ms  </td><td>bytes_per_s</td></tr>
+    </table>
+    All values MSB first, \e version is the GET_VERSION response, all 0 for PICCs without.
+    A failed chunk is retried with half the pages after a WUPA and a SELECT of the UID read from
+    page 0 and 1 at the start, so another PICC in the field is never read instead. The read stops
+    after 3 failed attempts.
+    Each chunk read doubles the pages again.
   */
+static iso14443AProximityCard_t nfcaCards[ISO14443A_MAX_CARDS];
 static ReturnCode processIso14443a(const uint8_t *rxData, uint16_t rxSize, uint8_t *txData, uint16_t *txSize)
 {
     ReturnCode err;
@@ -1389,6 +2783,34 @@ static ReturnCode processIso14443a(const uint8_t *rxData, uint16_t rxSize, uint8
             if(*txSize > 0) *txSize = 17;
             break;
 
+        case 0xa2:
+            {
+                uint8_t maxCards = ISO14443A_MAX_CARDS;
+                uint8_t cnt = 0;
+                uint16_t pos = 1;
+                uint8_t i;
+
+                if (bufSize < 1) return ERR_PARAM;
+                if ((bufSize > 1) && (buf[1] > 0)) maxCards = MIN(buf[1], ISO14443A_MAX_CARDS);
+                /* the largest record for every card */
+                if (*txSize < (1 + maxCards * (4 + ISO14443A_MAX_UID_LENGTH))) return ERR_PARAM;
+
+                err = iso14443AResolveAll(buf[0], nfcaCards, maxCards, &cnt);
+                txData[0] = cnt;
+                for (i = 0; i < cnt; i++)
+                {
+                    txData[pos++] = nfcaCards[i].atqa[0];
+                    txData[pos++] = nfcaCards[i].atqa[1];
+                    txData[pos++] = nfcaCards[i].sak[0];
+                    txData[pos++] = nfcaCards[i].actlength;
+                    ST_MEMCPY(&txData[pos], nfcaCards[i].uid, nfcaCards[i].actlength);
+                    pos += nfcaCards[i].actlength;
+                    logUsart("ISO14443A/NFC-A card found. SAK: %s UID: %s\n", hex2Str(&nfcaCards[i].sak[0], 1), hex2Str(nfcaCards[i].uid, nfcaCards[i].actlength));
+                }
+                *txSize = pos;
+            }
+            break;
+
         case 0xa3:
             err = iso14443ASendHlta();
             *txSize = 0;
@@ -1440,6 +2862,18 @@ static ReturnCode processIso14443a(const uint8_t *rxData, uint16_t rxSize, uint8
             *txSize = 0;
             break;
 
+        case 0xa9:
+            streamsStop();
+            *txSize = 0;
+            if (bufSize < 1) return ERR_PARAM;
+
+            err = mifareUlDumpInit(&mifareUlDump, (buf[0] & MIFARE_UL_DUMP_OPT_NO_FAST) ? false : true);
+            mifareUlDumpErr      = ERR_NONE;
+            mifareUlDumpProtocol = cmdProtocol;
+            mifareUlDumpStart    = platformGetSysTick();
+            mifareUlDumpRunning  = (ERR_NONE == err);
+            break;
+
         default:
             err = ERR_PARAM;
             *txSize = 0;
@@ -1756,6 +3190,53 @@ static ReturnCode processIso14443b(const uint8_t *rxData, uint16_t rxSize, uint8
       <tr><th>Content</th><td>0xc5(ID)</td><td>bitrate</td>
     </table>
     no return value only status
+  - #nfcDepTx() sends data of up to #NFC_DEP_PIPE_LEN bytes, chained over
+    several DEP frames if it does not fit into one
+    <table>
+      <tr><th>   Byte</th><th>       0</th><th>1..rxSize-1</th></tr>
+      <tr><th>Content</th><td>0xc6(ID)</td><td>       data</td></tr>
+    </table>
+    no return value only status
+  - #nfcDepPipeWrite() sends data too long for one command in parts. Each
+    DEP frame is sent as soon as it is complete, so the peer receives while
+    the host is still writing. The first part starts a new exchange.
+    <table>
+      <tr><th>   Byte</th><th>       0</th><th>      1</th><th>2..rxSize-1</th></tr>
+      <tr><th>Content</th><td>0xc3(ID)</td><td>options</td><td>       data</td></tr>
+    </table>
+    options bit 0: data ends the outgoing data.
+    response: bytes which can be written now, MSB first. ERR_BUSY (nothing
+    written) if there is not enough room, write again after reading.
+    Until the answer is read completely, commands other than 0xc3, 0xc6,
+    0xc7 and 0xcf are refused with ERR_BUSY. 0xc6 drops the exchange and
+    starts a new one, 0xcf drops it.
+    <table>
+      <tr><th>   Byte</th><th>      0</th><th>      1</th></tr>
+      <tr><th>Content</th><td>free</td><td>free</td></tr>
+    </table>
+  - #nfcDepRx() receives at most *txSize bytes of the answer. A chained
+    answer is returned in parts with status ERR_AGAIN as it is received,
+    the last part with ERR_NONE. ERR_BUSY if nothing was received yet.
+    <table>
+      <tr><th>   Byte</th><th>       0</th></tr>
+      <tr><th>Content</th><td>0xc7(ID)</td></tr>
+    </table>
+    response:
+    <table>
+      <tr><th>   Byte</th><th>0..actlength</th></tr>
+      <tr><th>Content</th><td>        data</td></tr>
+    </table>
+  - #nfcDepInitiatorHandleActivation() activates the target, bitrate
+    #NFC_DEP_BR_HIGHEST switches to the highest one every target supports
+    <table>
+      <tr><th>   Byte</th><th>       0</th><th>1..10  </th><th>     11</th><th>   12</th><th>13..</th></tr>
+      <tr><th>Content</th><td>0xc8(ID)</td><td>nfcid3</td><td>bitrate</td><td>gbLen</td><td>  gb</td></tr>
+    </table>
+    response:
+    <table>
+      <tr><th>   Byte</th><th>      0</th><th>        1</th><th>     2..</th></tr>
+      <tr><th>Content</th><td>bitrate</td><td>atrResLen</td><td>ATR_RES</td></tr>
+    </table>
 */
 static ReturnCode processNfc(const uint8_t *rxData, uint16_t rxSize, uint8_t *txData, uint16_t *txSize)
 {
@@ -1779,6 +3260,7 @@ static ReturnCode processNfc(const uint8_t *rxData, uint16_t rxSize, uint8_t *tx
             return err;
 
         case NFC_CMD_DEINITIALIZE:
+            nfcDepPipeAbort();
             err = nfcDeinitialize();
             return err;
 
@@ -1794,7 +3276,24 @@ static ReturnCode processNfc(const uint8_t *rxData, uint16_t rxSize, uint8_t *tx
             *txSize = actlength + 1;
             break;
 
-        case NFC_CMD_RFU1:
+        case NFC_CMD_NFCDEP_TX_PART:
+            if ((bufSize < 1) || (*txSize < 2)) return ERR_PARAM;
+            {
+                uint16_t free;
+
+                if (!nfcDepPipeIsActive())
+                {
+                    streamsStop();
+                }
+                err = nfcDepPipeWrite(&buf[1], bufSize - 1, ((buf[0] & NFC_DEP_TX_PART_OPT_LAST) != 0));
+
+                free = nfcDepPipeTxFree();
+                txData[0] = ((free>>8)&0xFF);
+                txData[1] = ((free>>0)&0xFF);
+                *txSize = ((ERR_NONE == err) ? 2 : 0);
+            }
+            break;
+
         case NFC_CMD_RFU2:
             return ERR_REQUEST;
 
@@ -1807,6 +3306,7 @@ static ReturnCode processNfc(const uint8_t *rxData, uint16_t rxSize, uint8_t *tx
             break;
 
         case NFC_CMD_NFCDEP_TX:
+            streamsStop();
             err = nfcDepTx( buf, bufSize );
             break;
 
@@ -1897,6 +3397,25 @@ static ReturnCode processNfc(const uint8_t *rxData, uint16_t rxSize, uint8_t *tx
       <tr><th>   Byte</th><th>   0     </th><th>                1..8 </th><th>..</th><th>1+(num_cards*8)..8*(num_cards+1)</th></tr>
       <tr><th>Content</th><td>num_cards</td><td>flags_0,dsfid_0,uid_0</td><td>..</td><td>flags,dsfid,uid_num_cards</td></tr>
     </table>
+  - #iso15693MultiInventoryRound() multi round inventory of large PICC populations
+    <table>
+      <tr><th>   Byte</th><th>   0    </th><th>   1   </th><th> 2 </th><th>  3..4  </th></tr>
+      <tr><th>Content</th><td>0xd1(ID)</td><td>options</td><td>afi</td><td>sim_tags</td></tr>
+    </table>
+    \e options are ISO15693_MULTI_INV_OPT_xxx. Optional \e sim_tags (MSB first) lets a simulated
+    population of that size answer instead of the RF, for benchmarking. Sending only the ID stops
+    a running multi round inventory. No response data only status, the results are streamed to the
+    host by applProcessCyclic() with the protocol byte of this command, one record per packet:
+    <table>
+      <tr><th>   Byte</th><th>   0    </th><th>  1..2  </th><th>    3    </th><th>4..3+10*num_cards</th></tr>
+      <tr><th>Content</th><td>0x01    </td><td> round  </td><td>num_cards</td><td>flags,dsfid,uid per card</td></tr>
+    </table>
+    for every round which found PICCs and finally, with the status of the inventory:
+    <table>
+      <tr><th>   Byte</th><th>   0    </th><th>  1..2  </th><th> 3..4 </th><th> 5..8 </th><th> 9..10</th><th>  11  </th><th>12..15</th><th>16..17</th></tr>
+      <tr><th>Content</th><td>0x02    </td><td> found  </td><td>rounds</td><td>frames</td><td>quiets</td><td>errors</td><td>  ms  </td><td>tags_per_s</td></tr>
+    </table>
+    All values MSB first. \e ms is the modelled air time when a simulated population is used.
   - #iso15693SendStayQuiet()
     <table>
       <tr><th>   Byte</th><th>   0    </th><th>  1  </th><th>2..9</th></tr>
@@ -1942,6 +3461,27 @@ static ReturnCode processNfc(const uint8_t *rxData, uint16_t rxSize, uint8_t *tx
     If SELECT flag(0x10) is set in \e flags, then UID can be omitted, operations works on selected flag.
     No response data only status is returned.
 
+  - #iso15693DumpChunk() dump of the whole PICC memory
+    <table>
+      <tr><th>   Byte</th><th>   0    </th><th>   1   </th><th>2..9</th></tr>
+      <tr><th>Content</th><td>0xdc(ID)</td><td>options</td><td> UID</td></tr>
+    </table>
+    Bit 0 of \e options enables Fast Read Multiple Blocks on ST PICCs. The memory size is taken from
+    the system information, the blocks are read in chunks as large as the stream buffer allows.
+    No response data only status, the memory is streamed to the host by applProcessCyclic() with
+    the protocol byte of this command, one record per packet:
+    <table>
+      <tr><th>   Byte</th><th>   0    </th><th>  1..2  </th><th>    3     </th><th>4..3+num_blocks*block_size</th></tr>
+      <tr><th>Content</th><td>0x03    </td><td> block  </td><td>num_blocks</td><td>data                      </td></tr>
+    </table>
+    for every chunk read and finally, with the status of the dump:
+    <table>
+      <tr><th>   Byte</th><th>   0    </th><th>  1..2   </th><th>     3    </th><th>4..7 </th><th> 8..9 </th><th>10..11 </th><th>12..15</th><th>16..19     </th></tr>
+      <tr><th>Content</th><td>0x04    </td><td>num_blocks</td><td>block_size</td><td>bytes</td><td>frames</td><td>retries</td><td>  ms  </td><td>bytes_per_s</td></tr>
+    </table>
+    All values MSB first. A failed chunk is retried with half the blocks, the dump stops after
+    3 failed attempts. Each chunk read doubles the blocks again. Starting a multi round inventory (0xd1) or another dump stops a running one.
+
   - #iso15693TxRxNBytes() generic sending of a byte stream, receives at most txSize
     <table>
       <tr><th>   Byte</th><th>   0    </th><th>1..rxSize</th></tr>
@@ -1992,6 +3532,25 @@ static ReturnCode processIso15693(const uint8_t *rxData, uint16_t rxSize, uint8_
             }
             return err;
 
+        case 0xd1:
+            {
+                uint16_t simTags = 0;
+
+                streamsStop();
+                *txSize = 0;
+                if (bufSize == 0) return ERR_NONE;
+                if (bufSize < 2) return ERR_PARAM;
+                if (bufSize >= 4) simTags = ((buf[2] << 8) | buf[3]);
+
+                iso15693SetSimulation(simTags, ISO15693_STREAM_SIM_SEED);
+                err = iso15693MultiInventoryInit(&iso15693StreamInv, buf[0], buf[1]);
+                iso15693StreamSim      = (simTags > 0);
+                iso15693StreamProtocol = cmdProtocol;
+                iso15693StreamStart    = platformGetSysTick();
+                iso15693StreamRunning  = (ERR_NONE == err);
+            }
+            break;
+
         case 0xd2:
         case 0xd3:
             err = iso15693Inventory((0xd2 == cmd) ?
@@ -2002,39 +3561,6 @@ static ReturnCode processIso15693(const uint8_t *rxData, uint16_t rxSize, uint8_
                     cards,
                     sizeof(cards)/sizeof(iso15693ProximityCard_t),
                     &actcnt);
-#if 0
-            /* This code automatically sends stay_quiet to all tags and repeats anticol */
-            {
-                uint8_t i, currcnt = actcnt;
-
-                for (i = 0 ; i<actcnt ; i++)
-                {
-                    iso15693SendStayQuiet(cards + i);
-                }
-#if 1
-
-                /* Disable this here for easy testing from GUI on tags found by additional rounds */
-                while (currcnt && actcnt < sizeof(cards)/sizeof(iso15693ProximityCard_t))
-                {
-                    uint8_t i;
-                    iso15693Inventory((0xd2 == cmd) ?
-                            ISO15693_NUM_SLOTS_1 :
-                            ISO15693_NUM_SLOTS_16,
-                            0,
-                            NULL,
-                            cards + actcnt,
-                            sizeof(cards)/sizeof(iso15693ProximityCard_t) - actcnt,
-                            &currcnt);
-
-                    for (i = actcnt ; i<actcnt+currcnt ; i++)
-                    {
-                        iso15693SendStayQuiet(cards + i);
-                    }
-                    actcnt += currcnt;
-                }
-#endif
-            }
-#endif
             if (actcnt > 0)
             {
                 uint8_t i, *tx = txData;
@@ -2197,47 +3723,622 @@ static ReturnCode processIso15693(const uint8_t *rxData, uint16_t rxSize, uint8_
             }
             else
             {
-              *txSize = 0;
+              *txSize = 0;
+            }
+            break;
+
+        case 0xdc:
+            streamsStop();
+            *txSize = 0;
+            if (bufSize < 1 + ISO15693_UID_LENGTH) return ERR_PARAM;
+
+            err = iso15693DumpInit(&iso15693Dump, &buf[1], (buf[0] & ISO15693_DUMP_OPT_FAST) ? true : false);
+            iso15693DumpErr        = ERR_NONE;
+            iso15693StreamProtocol = cmdProtocol;
+            iso15693StreamStart    = platformGetSysTick();
+            iso15693DumpRunning    = (ERR_NONE == err);
+            break;
+
+        case 0xdd:
+            {
+                uint16_t actlength = 0;
+                uint16_t response_wait_time_ms = buf[0] | (buf[1] << 8);
+
+                if (bufSize < 2) return ERR_PARAM;
+
+                /* Generic command iso15693_2 command, i.e. no flag and crc handling */
+                /* Relax settings of mask receive timer for protocols which answer earlier */
+                rfalSetFDTListen( 1 ); /* a low value, RFAL will adapt it to the allowed minimum */
+                err = rfalTransceiveBlockingTxRx( (uint8_t*)(buf + 2), (bufSize - 2), txData, *txSize, &actlength,
+                                            (RFAL_TXRX_FLAGS_CRC_TX_MANUAL | RFAL_TXRX_FLAGS_CRC_RX_KEEP | RFAL_TXRX_FLAGS_NFCIP1_OFF | RFAL_TXRX_FLAGS_AGC_ON | RFAL_TXRX_FLAGS_PAR_RX_REMV | RFAL_TXRX_FLAGS_NFCV_FLAG_MANUAL),
+                                             rfalConvMsTo1fc(response_wait_time_ms)  );
+                *txSize = actlength;
+            }
+            break;
+
+        case 0xde:
+            {
+                uint16_t actlength = 0;
+                if (bufSize < 2) return ERR_PARAM;
+                uint16_t response_wait_time_ms = buf[0] | (buf[1] << 8);
+                /* Generic command */
+                err = iso15693TxRxNBytes((uint8_t*)buf + 2, bufSize - 2, txData, *txSize, &actlength, response_wait_time_ms);
+                *txSize = actlength;
+            }
+            break;
+
+        default:
+            err = ERR_REQUEST;
+    }
+
+    if (ERR_NONE == err){
+      platformLedOnOff(LED_V_GPIO_Port, LED_V_Pin, VISUAL_FEEDBACK_DELAY);
+    }
+
+    return err;
+}
+
+/*!
+  Run the multi round inventory started by 0xd1 one round further and stream
+  its result, see #processIso15693(). Called by applProcessCyclic().
+  \param txData : forward from applProcessCyclic()
+  \param txSize : forward from applProcessCyclic(), 0 if nothing to send
+  \param remainingSize : forward from applProcessCyclic()
+  */
+static ReturnCode processIso15693Stream(uint8_t *txData, uint16_t *txSize, uint16_t remainingSize)
+{
+    const uint8_t maxCards = sizeof(cards)/sizeof(iso15693ProximityCard_t);
+    ReturnCode err = ERR_NONE;
+    uint8_t cnt = 0;
+    uint8_t i;
+    uint32_t ms;
+    uint32_t rate;
+
+    *txSize = 0;
+
+    /* a full round has to fit, otherwise wait for an empty buffer */
+    if (remainingSize < (ISO15693_STREAM_TAGS_HDR_LEN + maxCards * (ISO15693_UID_LENGTH + 2)))
+    {
+        return ERR_NONE;
+    }
+
+    if (!iso15693StreamSim && (rfalGetMode() != RFAL_MODE_POLL_NFCV))
+    { /* another protocol took over the RF */
+        iso15693StreamInv.done = true;
+        err = ERR_WRONG_STATE;
+    }
+    else
+    {
+        iso15693MultiInventoryRound(&iso15693StreamInv, cards, maxCards, &cnt);
+    }
+
+    if (uidSetEnabled && (cnt > 0))
+    { /* report arrivals only; a full set cannot tell, so report those too */
+        uint8_t arrivals = 0;
+        bool arrived;
+
+        for (i = 0; i < cnt; i++)
+        {
+            if ((ERR_NONE != uidSetSeen(UID_SET_TECH_ISO15693, cards[i].uid, ISO15693_UID_LENGTH, platformGetSysTick(), &arrived)) || arrived)
+            {
+                cards[arrivals++] = cards[i];
+            }
+        }
+        cnt = arrivals;
+    }
+
+    if (cnt > 0)
+    {
+        txData[0] = ISO15693_STREAM_REC_TAGS;
+        txData[1] = ((iso15693StreamInv.rounds>>8)&0xFF);
+        txData[2] = ((iso15693StreamInv.rounds>>0)&0xFF);
+        txData[3] = cnt;
+        for (i = 0; i < cnt; i++)
+        {
+            /* flags, dsfid, uid */
+            ST_MEMCPY(&txData[ISO15693_STREAM_TAGS_HDR_LEN + i * (ISO15693_UID_LENGTH + 2)], &cards[i].flags, ISO15693_UID_LENGTH + 2);
+        }
+        *txSize = ISO15693_STREAM_TAGS_HDR_LEN + cnt * (ISO15693_UID_LENGTH + 2);
+        /* summary follows with the next call */
+        return ERR_NONE;
+    }
+    if (!iso15693StreamInv.done)
+    {
+        return ERR_NONE;
+    }
+
+    ms = (iso15693StreamSim ? (iso15693GetSimulationAirTime() / 1000) : (platformGetSysTick() - iso15693StreamStart));
+    rate = (ms ? MIN((iso15693StreamInv.found * 1000UL) / ms, 0xFFFF) : 0);
+
+    txData[0]  = ISO15693_STREAM_REC_DONE;
+    txData[1]  = ((iso15693StreamInv.found>>8)&0xFF);
+    txData[2]  = ((iso15693StreamInv.found>>0)&0xFF);
+    txData[3]  = ((iso15693StreamInv.rounds>>8)&0xFF);
+    txData[4]  = ((iso15693StreamInv.rounds>>0)&0xFF);
+    txData[5]  = ((iso15693StreamInv.frames>>24)&0xFF);
+    txData[6]  = ((iso15693StreamInv.frames>>16)&0xFF);
+    txData[7]  = ((iso15693StreamInv.frames>>8)&0xFF);
+    txData[8]  = ((iso15693StreamInv.frames>>0)&0xFF);
+    txData[9]  = ((iso15693StreamInv.quiets>>8)&0xFF);
+    txData[10] = ((iso15693StreamInv.quiets>>0)&0xFF);
+    txData[11] = iso15693StreamInv.errors;
+    txData[12] = ((ms>>24)&0xFF);
+    txData[13] = ((ms>>16)&0xFF);
+    txData[14] = ((ms>>8)&0xFF);
+    txData[15] = ((ms>>0)&0xFF);
+    txData[16] = ((rate>>8)&0xFF);
+    txData[17] = ((rate>>0)&0xFF);
+    *txSize = 18;
+
+    logUsart("ISO15693 multi round inventory: %d cards, %d rounds, %d ms\n", iso15693StreamInv.found, iso15693StreamInv.rounds, ms);
+
+    iso15693StreamRunning = false;
+    iso15693SetSimulation(0, 0);
+
+    return err;
+}
+
+/*!
+  Check whether the next chunk of a dump can be streamed now. It waits for an
+  empty buffer unless even that cannot take the chunk.
+  \param need : bytes of the chunk record
+  \param remainingSize : forward from applProcessCyclic()
+  */
+static bool streamChunkFits(uint16_t need, uint16_t remainingSize)
+{
+    return (remainingSize >= MIN(need, ST_STREAM_MAX_DATA_SIZE));
+}
+
+/*!
+  Write the \a len lower bytes of \a value MSB first.
+  \param txData : record written
+  \param pos : position in \a txData
+  \param value : value to write
+  \param len : 1..4
+  \return position behind the value
+  */
+static uint16_t streamPutValue(uint8_t *txData, uint16_t pos, uint32_t value, uint8_t len)
+{
+    while (len > 0)
+    {
+        len--;
+        txData[pos++] = ((value>>(8*len))&0xFF);
+    }
+    return pos;
+}
+
+/*!
+  Finish a dump: append the statistics every dump reports to its summary
+  record, log them and stop the dump.
+  <table>
+    <tr><th>   Byte</th><th>0..pos-1</th><th>pos..+3</th><th>+4..+5</th><th>+6..+7</th><th>+8..+11</th><th>+12..+15</th></tr>
+    <tr><th>Content</th><td>dump specific</td><td>bytes</td><td>frames</td><td>retries</td><td>ms</td><td>bytes/s</td></tr>
+  </table>
+  \param txData : summary record, its first \a pos bytes are written already
+  \param pos : bytes written already
+  \param name : dump in the log
+  \param bytes : bytes read
+  \param frames : read requests sent
+  \param retries : read requests repeated
+  \param start : system tick the dump started at
+  \param running : running flag of the dump, cleared
+  \return size of the summary record
+  */
+static uint16_t streamDumpDone(uint8_t *txData, uint16_t pos, const char *name, uint32_t bytes, uint16_t frames, uint16_t retries, uint32_t start, bool *running)
+{
+    uint32_t ms = platformGetSysTick() - start;
+    uint32_t rate = (ms ? ((bytes * 1000UL) / ms) : 0);
+
+    pos = streamPutValue(txData, pos, bytes, 4);
+    pos = streamPutValue(txData, pos, frames, 2);
+    pos = streamPutValue(txData, pos, retries, 2);
+    pos = streamPutValue(txData, pos, ms, 4);
+    pos = streamPutValue(txData, pos, rate, 4);
+
+    logUsart("%s: %d bytes, %d frames, %d ms\n", name, bytes, frames, ms);
+
+    *running = false;
+
+    return pos;
+}
+
+/*!
+  Read the next chunk of the memory dump started by 0xdc and stream it,
+  see #processIso15693(). Called by applProcessCyclic().
+  \param txData : forward from applProcessCyclic()
+  \param txSize : forward from applProcessCyclic(), 0 if nothing to send
+  \param remainingSize : forward from applProcessCyclic()
+  */
+static ReturnCode processIso15693Dump(uint8_t *txData, uint16_t *txSize, uint16_t remainingSize)
+{
+    ReturnCode err;
+    uint16_t need;
+    uint16_t block;
+    uint8_t num;
+
+    *txSize = 0;
+
+    if ((ERR_NONE == iso15693DumpErr) && (iso15693Dump.nextBlock < iso15693Dump.numBlocks))
+    {
+        /* record header, response flags, chunk and CRC */
+        need = MIN(iso15693Dump.chunkBlocks, iso15693Dump.numBlocks - iso15693Dump.nextBlock);
+        need = ISO15693_DUMP_DATA_HDR_LEN + 2 + need * iso15693Dump.blockSize;
+        if (!streamChunkFits(need, remainingSize))
+        {
+            return ERR_NONE;
+        }
+
+        if (rfalGetMode() != RFAL_MODE_POLL_NFCV)
+        { /* another protocol took over the RF */
+            iso15693DumpErr = ERR_WRONG_STATE;
+        }
+        else
+        {
+            /* response flags land on num_blocks, data right behind the record header */
+            err = iso15693DumpChunk(&iso15693Dump, &txData[ISO15693_DUMP_DATA_HDR_LEN - 1],
+                    remainingSize - (ISO15693_DUMP_DATA_HDR_LEN - 1), &block, &num);
+            if (num > 0)
+            {
+                txData[0] = ISO15693_DUMP_REC_DATA;
+                txData[1] = ((block>>8)&0xFF);
+                txData[2] = ((block>>0)&0xFF);
+                txData[3] = num;
+                *txSize = ISO15693_DUMP_DATA_HDR_LEN + num * iso15693Dump.blockSize;
+                /* summary follows after the last chunk */
+                return ERR_NONE;
+            }
+            iso15693DumpErr = err;
+        }
+    }
+
+    txData[0]  = ISO15693_DUMP_REC_DONE;
+    txData[1]  = ((iso15693Dump.numBlocks>>8)&0xFF);
+    txData[2]  = ((iso15693Dump.numBlocks>>0)&0xFF);
+    txData[3]  = iso15693Dump.blockSize;
+    *txSize = streamDumpDone(txData, 4, "ISO15693 dump", iso15693Dump.bytes, iso15693Dump.frames,
+            iso15693Dump.retries, iso15693StreamStart, &iso15693DumpRunning);
+
+    return iso15693DumpErr;
+}
+
+/*!
+  Read the next chunk of the NTAG/Ultralight started by 0xa9 and stream it,
+  see #processIso14443a(). Called by applProcessCyclic().
+  \param txData : forward from applProcessCyclic()
+  \param txSize : forward from applProcessCyclic(), 0 if nothing to send
+  \param remainingSize : forward from applProcessCyclic()
+  */
+static ReturnCode processMifareUlDump(uint8_t *txData, uint16_t *txSize, uint16_t remainingSize)
+{
+    ReturnCode err;
+    uint16_t need;
+    uint16_t page;
+    uint8_t num;
+
+    *txSize = 0;
+
+    if ((ERR_NONE == mifareUlDumpErr) && (mifareUlDump.nextPage < mifareUlDump.numPages))
+    {
+        /* record header, chunk and CRC */
+        need = MIN(mifareUlDump.chunkPages, mifareUlDump.numPages - mifareUlDump.nextPage);
+        need = MIFARE_UL_DUMP_DATA_HDR_LEN + 2 + MAX(need, 4) * MIFARE_UL_PAGE_SIZE;
+        if (!streamChunkFits(need, remainingSize))
+        {
+            return ERR_NONE;
+        }
+
+        if (rfalGetMode() != RFAL_MODE_POLL_NFCA)
+        { /* another protocol took over the RF */
+            mifareUlDumpErr = ERR_WRONG_STATE;
+        }
+        else
+        {
+            err = mifareUlDumpChunk(&mifareUlDump, &txData[MIFARE_UL_DUMP_DATA_HDR_LEN],
+                    remainingSize - MIFARE_UL_DUMP_DATA_HDR_LEN, &page, &num);
+            if (num > 0)
+            {
+                txData[0] = MIFARE_UL_DUMP_REC_DATA;
+                txData[1] = ((page>>8)&0xFF);
+                txData[2] = ((page>>0)&0xFF);
+                txData[3] = num;
+                *txSize = MIFARE_UL_DUMP_DATA_HDR_LEN + num * MIFARE_UL_PAGE_SIZE;
+                /* summary follows after the last chunk */
+                return ERR_NONE;
+            }
+            mifareUlDumpErr = err;
+        }
+    }
+
+    txData[0]  = MIFARE_UL_DUMP_REC_DONE;
+    ST_MEMCPY(&txData[1], mifareUlDump.version, MIFARE_UL_VERSION_LEN);
+    txData[9]  = ((mifareUlDump.numPages>>8)&0xFF);
+    txData[10] = ((mifareUlDump.numPages>>0)&0xFF);
+    *txSize = streamDumpDone(txData, 11, "NTAG/UL read", mifareUlDump.bytes, mifareUlDump.frames,
+            mifareUlDump.retries, mifareUlDumpStart, &mifareUlDumpRunning);
+
+    return mifareUlDumpErr;
+}
+
+/*!
+  Read the next chunk of the ST25TB dump started by #RFAL_CMD_ST25TB_DUMP and
+  stream it. Called by applProcessCyclic().
+  \param txData : forward from applProcessCyclic()
+  \param txSize : forward from applProcessCyclic(), 0 if nothing to send
+  \param remainingSize : forward from applProcessCyclic()
+  */
+static ReturnCode processSt25tbDump(uint8_t *txData, uint16_t *txSize, uint16_t remainingSize)
+{
+    ReturnCode err;
+    uint16_t need;
+    uint8_t tag;
+    uint8_t block;
+    uint8_t num;
+
+    *txSize = 0;
+
+    if ((ERR_NONE == st25tbDumpErr) && (st25tbDump.tag < st25tbDump.numTags))
+    {
+        /* rest of the current tag */
+        need = st25tbDump.lastBlock + 1 - st25tbDump.nextBlock;
+        need = ST25TB_DUMP_DATA_HDR_LEN + need * ISO14443B_ST25TB_BLOCKSIZE;
+        if (!streamChunkFits(need, remainingSize))
+        {
+            return ERR_NONE;
+        }
+
+        if (rfalGetMode() != RFAL_MODE_POLL_NFCB)
+        { /* another protocol took over the RF */
+            st25tbDumpErr = ERR_WRONG_STATE;
+        }
+        else
+        {
+            err = iso14443B_ST25TB_DumpChunk(&st25tbDump, &txData[ST25TB_DUMP_DATA_HDR_LEN],
+                    remainingSize - ST25TB_DUMP_DATA_HDR_LEN, &tag, &block, &num);
+            if (ERR_NOMEM != err)
+            {
+                txData[0]  = ST25TB_DUMP_REC_DATA;
+                txData[1]  = st25tbDump.tags[tag].Chip_ID;
+                ST_MEMCPY(&txData[2], st25tbDump.tags[tag].uid, ISO14443B_ST25TB_UIDSIZE);
+                txData[10] = block;
+                txData[11] = num;
+                *txSize = ST25TB_DUMP_DATA_HDR_LEN + num * ISO14443B_ST25TB_BLOCKSIZE;
+                /* summary follows after the last chunk */
+                return ERR_NONE;
             }
-            break;
+            st25tbDumpErr = err;
+        }
+    }
 
-        case 0xdd:
-            {
-                uint16_t actlength = 0;
-                uint16_t response_wait_time_ms = buf[0] | (buf[1] << 8);
+    txData[0]  = ST25TB_DUMP_REC_DONE;
+    txData[1]  = st25tbDump.numTags;
+    txData[2]  = st25tbDump.tagsFailed;
+    *txSize = streamDumpDone(txData, 3, "ST25TB dump", st25tbDump.bytes, st25tbDump.frames,
+            st25tbDump.retries, st25tbDumpStart, &st25tbDumpRunning);
 
-                if (bufSize < 2) return ERR_PARAM;
+    return st25tbDumpErr;
+}
 
-                /* Generic command iso15693_2 command, i.e. no flag and crc handling */
-                /* Relax settings of mask receive timer for protocols which answer earlier */
-                rfalSetFDTListen( 1 ); /* a low value, RFAL will adapt it to the allowed minimum */
-                err = rfalTransceiveBlockingTxRx( (uint8_t*)(buf + 2), (bufSize - 2), txData, *txSize, &actlength,
-                                            (RFAL_TXRX_FLAGS_CRC_TX_MANUAL | RFAL_TXRX_FLAGS_CRC_RX_KEEP | RFAL_TXRX_FLAGS_NFCIP1_OFF | RFAL_TXRX_FLAGS_AGC_ON | RFAL_TXRX_FLAGS_PAR_RX_REMV | RFAL_TXRX_FLAGS_NFCV_FLAG_MANUAL),
-                                             rfalConvMsTo1fc(response_wait_time_ms)  );
-                *txSize = actlength;
-            }
-            break;
+/*!
+  Advance the exchange of the APDU pipe and stream the response as it is
+  received, see #RFAL_CMD_ISO_DEP_PIPE_WRITE. Called by applProcessCyclic().
+  \param txData : forward from applProcessCyclic()
+  \param txSize : forward from applProcessCyclic(), 0 if nothing to send
+  \param remainingSize : forward from applProcessCyclic()
+  */
+static ReturnCode processIsoDepPipe(uint8_t *txData, uint16_t *txSize, uint16_t remainingSize)
+{
+    uint16_t len;
+    uint32_t ms;
 
-        case 0xde:
+    *txSize = 0;
+
+    /* room for the summary keeps the logic simple */
+    if (remainingSize < ISO_DEP_PIPE_DONE_LEN)
+    {
+        return ERR_NONE;
+    }
+
+    if (ERR_BUSY == isoDepPipeErr)
+    {
+        isoDepPipeErr = iso14443L4PipeRead(&txData[1], remainingSize - 1, &len);
+        if (len > 0)
+        {
+            if (isoDepPipeRxBytes == 0)
             {
-                uint16_t actlength = 0;
-                if (bufSize < 2) return ERR_PARAM;
-                uint16_t response_wait_time_ms = buf[0] | (buf[1] << 8);
-                /* Generic command */
-                err = iso15693TxRxNBytes((uint8_t*)buf + 2, bufSize - 2, txData, *txSize, &actlength, response_wait_time_ms);
-                *txSize = actlength;
+                isoDepPipeLatency = platformGetSysTick() - isoDepPipeTxEnd;
             }
-            break;
+            isoDepPipeRxBytes += len;
+            txData[0] = ISO_DEP_PIPE_REC_DATA;
+            *txSize = 1 + len;
+            /* summary follows with the next call */
+            return ERR_NONE;
+        }
+        if (ERR_BUSY == isoDepPipeErr)
+        {
+            return ERR_NONE;
+        }
+    }
+
+    ms = platformGetSysTick() - isoDepPipeStart;
+
+    txData[0] = ISO_DEP_PIPE_REC_DONE;
+    len = streamPutValue(txData, 1, isoDepPipeTxBytes, 4);
+    len = streamPutValue(txData, len, isoDepPipeRxBytes, 4);
+    len = streamPutValue(txData, len, isoDepPipeLatency, 4);
+    *txSize = streamPutValue(txData, len, ms, 4);
+
+    logUsart("APDU pipe: %d bytes out, %d bytes in, %d ms\n", isoDepPipeTxBytes, isoDepPipeRxBytes, ms);
+
+    isoDepPipeRunning = false;
+
+    return isoDepPipeErr;
+}
 
+/*!
+  Stop all streams running in applProcessCyclic(), done before one is started
+  as they share the RF.
+  */
+static void streamsStop(void)
+{
+    iso15693StreamRunning = false;
+    iso15693DumpRunning   = false;
+    mifareUlDumpRunning   = false;
+    st25tbDumpRunning     = false;
+    isoDepPipeRunning     = false;
+    iso14443L4PipeAbort();
+    nfcDepPipeAbort();
+    iso15693SetSimulation(0, 0);
+}
+
+/*!
+  Get the mode and bit rates the initialization of a protocol sets.
+  \param prot : protocol nibble as used by #processProtocols()
+  \param mode : mode set
+  \param txBR : transmit bit rate set
+  \param rxBR : receive bit rate set
+  \return false if the protocol has no fixed poller configuration
+  */
+static bool protocolRfConfig(uint8_t prot, rfalMode *mode, rfalBitRate *txBR, rfalBitRate *rxBR)
+{
+    *txBR = RFAL_BR_106;
+    *rxBR = RFAL_BR_106;
+
+    switch (prot)
+    {
+        case 0x80: /* kovio uses the NFC-A poller setup */
+        case 0xa0:
+            *mode = RFAL_MODE_POLL_NFCA;
+            break;
+        case 0x90:
+            *mode = RFAL_MODE_POLL_NFCA_T1T;
+            break;
+        case 0xb0:
+            *mode = RFAL_MODE_POLL_NFCB;
+            break;
+        case 0xd0:
+            *mode = RFAL_MODE_POLL_NFCV;
+            *txBR = RFAL_BR_26p48;
+            *rxBR = RFAL_BR_26p48;
+            break;
+        case 0xf0:
+            *mode = RFAL_MODE_POLL_NFCF;
+            *txBR = RFAL_BR_212;
+            *rxBR = RFAL_BR_212;
+            break;
         default:
-            err = ERR_REQUEST;
+            return false;
     }
 
-    if (ERR_NONE == err){
-      platformLedOnOff(LED_V_GPIO_Port, LED_V_Pin, VISUAL_FEEDBACK_DELAY);
+    return true;
+}
+
+/*!
+  Check if the RF is configured as the initialization of a protocol would do.
+  Timings are only known to match if the last initialization was one of the
+  same poller setup, mode and bit rates must not have been changed since.
+  \param prot : protocol nibble as used by #processProtocols()
+  \return true if the initialization can be skipped
+  */
+static bool protocolRfConfigured(uint8_t prot)
+{
+    rfalMode    mode, lastMode;
+    rfalBitRate txBR, rxBR, lastTxBR, lastRxBR, curTxBR, curRxBR;
+
+    if (!protocolRfConfig(prot, &mode, &txBR, &rxBR) ||
+        !protocolRfConfig(protocolConfigured, &lastMode, &lastTxBR, &lastRxBR))
+    {
+        return false;
+    }
+    if ((mode != lastMode) || (txBR != lastTxBR) || (rxBR != lastRxBR))
+    {
+        return false;
+    }
+    if (ERR_NONE != rfalGetBitRate(&curTxBR, &curRxBR))
+    {
+        return false;
     }
 
-    return err;
+    return ((rfalGetMode() == mode) && (curTxBR == txBR) && (curRxBR == rxBR));
+}
+
+/*!
+  Remove the PICCs of the seen-set which were not seen within the TTL and
+  stream their fingerprints, see #RFAL_CMD_UID_SET_CONFIG. Called by applProcessCyclic().
+  \param txData : forward from applProcessCyclic()
+  \param txSize : forward from applProcessCyclic(), 0 if nothing to send
+  \param remainingSize : forward from applProcessCyclic()
+  */
+static ReturnCode processUidSetExpire(uint8_t *txData, uint16_t *txSize, uint16_t remainingSize)
+{
+    uint32_t departed[UID_SET_REPORT_MAX_PICCS];
+    uint16_t maxPiccs;
+    uint16_t pos;
+    uint8_t cnt;
+    uint8_t i;
+
+    *txSize = 0;
+
+    maxPiccs = ((remainingSize > 1) ? MIN((remainingSize - 1) / 4, UID_SET_REPORT_MAX_PICCS) : 0);
+    if (maxPiccs == 0)
+    {
+        return ERR_NONE;
+    }
+
+    cnt = (uint8_t)uidSetExpire(platformGetSysTick(), UID_SET_SWEEP_SLOTS, departed, maxPiccs);
+    if (cnt == 0)
+    {
+        return ERR_NONE;
+    }
+
+    txData[0] = cnt;
+    pos = 1;
+    for (i = 0; i < cnt; i++)
+    {
+        txData[pos++] = ((departed[i]>>24)&0xFF);
+        txData[pos++] = ((departed[i]>>16)&0xFF);
+        txData[pos++] = ((departed[i]>>8)&0xFF);
+        txData[pos++] = ((departed[i]>>0)&0xFF);
+    }
+    *txSize = pos;
+
+    return ERR_NONE;
+}
+
+/*!
+  Create the \a n th synthetic PICC of #RFAL_CMD_UID_SET_BENCHMARK. The
+  technologies take turns, NFC-A cycles through the three UID sizes.
+  \param n : number of the PICC
+  \param tech : UID_SET_TECH_xxx of the PICC
+  \param uid : UID of the PICC, #UID_SET_MAX_UID_LEN bytes
+  \param uidLen : length of \a uid
+  */
+static void uidSetBenchmarkUid(uint16_t n, uint8_t *tech, uint8_t *uid, uint8_t *uidLen)
+{
+    static const uint8_t nfcaLen[3] = { 4, 7, 10 };
+    uint32_t seed = (n * 2654435761UL) + 0x12345678UL;
+    uint8_t i;
+
+    *tech = UID_SET_TECH_ISO15693 + (n % 5);
+    switch (*tech)
+    {
+        case UID_SET_TECH_NFCA:
+            *uidLen = nfcaLen[(n / 5) % 3];
+            break;
+        case UID_SET_TECH_NFCB:
+            *uidLen = 4;
+            break;
+        default:
+            *uidLen = 8;
+            break;
+    }
+    for (i = 0; i < *uidLen; i++)
+    {
+        seed = (seed * 1103515245) + 12345;
+        uid[i] = (uint8_t)(seed >> 16);
+    }
+    /* unique no matter how the random bytes turned out */
+    uid[0] = (uint8_t)(n >> 8);
+    uid[1] = (uint8_t)n;
 }
 
 /*!
@@ -2581,6 +4682,34 @@ static ReturnCode processMifare(const uint8_t *rxData, uint16_t rxSize, uint8_t
       <li> \e num_cols: the number of collisions detected in responses to POLL command
       <li> \e card: felica Proximity card response according to layout of struct #felicaProximityCard.
     </ul>
+  - #felicaReadBlocks() reads the blocks of several services with as few commands as possible
+    <table>
+      <tr><th>   Byte</th><th>       0</th><th>1..8</th><th>9..16</th><th>        17</th><th>        18</th><th>19..</th></tr>
+      <tr><th>Content</th><td>0xf3(ID)</td><td> IDm</td><td>  PMm</td><td>max_blocks</td><td>num_ranges</td><td>ranges</td></tr>
+    </table>
+    with each of the up to #FELICA_READ_MAX_RANGES ranges:
+    <table>
+      <tr><th>   Byte</th><th>   0..1     </th><th>   2..3    </th><th>    4    </th></tr>
+      <tr><th>Content</th><td>service code</td><td>first block</td><td>num_blocks</td></tr>
+    </table>
+    <ul>
+      <li> \e IDm, \e PMm : as returned by the POLL command
+      <li> \e max_blocks : most blocks per Read Without Encryption, 0 chooses by the IC type of the PMm
+      <li> \e service code, \e first block : MSB first like all values of this interface, e.g. 0x00 0x0B
+           for service 0x000B. #felicaReadBlocks() puts the service code LSB first into the frame.
+    </ul>
+    Response is:
+    <table>
+      <tr><th>   Byte</th><th>0..1  </th><th>      2 </th><th>      3 </th><th>  4</th><th>  5</th><th>6..9</th><th>10..</th></tr>
+      <tr><th>Content</th><td>blocks</td><td>commands</td><td>failures</td><td>sf1</td><td>sf2</td><td>  ms</td><td>block data</td></tr>
+    </table>
+    <ul>
+      <li> \e blocks : number of blocks read, their data follows in the order of the ranges
+      <li> \e commands : Read Without Encryption commands sent successfully
+      <li> \e failures : commands repeated with less blocks after a failure
+      <li> \e sf1, \e sf2 : status flags of the last response
+      <li> \e ms : time taken, MSB first
+    </ul>
     */
 static ReturnCode processFeliCa(const uint8_t *rxData, uint16_t rxSize, uint8_t *txData, uint16_t *txSize)
 {
@@ -2631,6 +4760,49 @@ static ReturnCode processFeliCa(const uint8_t *rxData, uint16_t rxSize, uint8_t
 
 
 
+            break;
+            }
+
+        case 0xF3:
+            {
+            struct felicaBlockRange ranges[FELICA_READ_MAX_RANGES];
+            struct felicaReadResult result;
+            uint8_t numRanges;
+            uint8_t i;
+            uint32_t ms;
+
+            if (bufSize < 18) return ERR_PARAM;
+            numRanges = buf[17];
+            if ((numRanges > FELICA_READ_MAX_RANGES) || (bufSize < (18 + 5 * numRanges))) return ERR_PARAM;
+            if (*txSize < FELICA_READ_HEADER_LEN) return ERR_PARAM;
+            for (i = 0; i < numRanges; i++)
+            {
+                ranges[i].serviceCode = ((buf[18 + 5*i + 0] << 8) | buf[18 + 5*i + 1]);
+                ranges[i].firstBlock  = ((buf[18 + 5*i + 2] << 8) | buf[18 + 5*i + 3]);
+                ranges[i].numBlocks   = buf[18 + 5*i + 4];
+            }
+
+            timerStopwatchStart();
+            err = felicaReadBlocks(&buf[0], &buf[8], ranges, numRanges, buf[16],
+                    &txData[FELICA_READ_HEADER_LEN], *txSize - FELICA_READ_HEADER_LEN, &result);
+            ms = timerStopwatchMeasure();
+
+            txData[0] = ((result.blocks>>8)&0xFF);
+            txData[1] = ((result.blocks>>0)&0xFF);
+            txData[2] = result.commands;
+            txData[3] = result.failures;
+            txData[4] = result.statusFlag1;
+            txData[5] = result.statusFlag2;
+            txData[6] = ((ms>>24)&0xFF);
+            txData[7] = ((ms>>16)&0xFF);
+            txData[8] = ((ms>>8)&0xFF);
+            txData[9] = ((ms>>0)&0xFF);
+            *txSize = FELICA_READ_HEADER_LEN + result.blocks * FELICA_BLOCK_LENGTH;
+
+            logUsart("FeliCa read: %d blocks, %d commands, %d ms\n", result.blocks, result.commands, ms);
+            if (ERR_NONE == err){
+              platformLedOnOff(LED_F_GPIO_Port, LED_F_Pin, VISUAL_FEEDBACK_DELAY);
+            }
             break;
             }
 
@@ -2655,12 +4827,329 @@ static ReturnCode processFeliCa(const uint8_t *rxData, uint16_t rxSize, uint8_t
     return err;
 }
 
+/*!
+  Run the RF script uploaded with RFAL_CMD_SCRIPT_LOAD.
+
+  \param args    : arguments of RFAL_CMD_SCRIPT_RUN, usable by TX_APPEND_ARG
+  \param argsLen : number of bytes in \a args
+  \param txData  : forward from applProcessCmd()
+  \param txSize  : forward from applProcessCmd()
+
+  A script is a sequence of opcodes with big endian operands. Frames are
+  built in a tx buffer by the TX_xxx opcodes and sent by TXRX; its status
+  and response are kept for the JMP_xxx and EMIT opcodes. A failing TXRX
+  does not stop the script, the script has to check the status itself.
+  Registers r0..r3 are 16 bit wide and start at 0 on each run.
+
+  <table>
+    <tr><th>Opcode</th><th>Name</th><th>Operands</th><th>Description</th></tr>
+    <tr><td>0x00</td><td>END</td><td>-</td><td>stop, status ERR_NONE</td></tr>
+    <tr><td>0x01</td><td>TX_LOAD</td><td>len, data[len]</td><td>tx buffer = data</td></tr>
+    <tr><td>0x02</td><td>TX_APPEND</td><td>len, data[len]</td><td>append data to tx buffer</td></tr>
+    <tr><td>0x03</td><td>TX_APPEND_ARG</td><td>offset, len</td><td>append run arguments [offset..offset+len-1]</td></tr>
+    <tr><td>0x04</td><td>TX_APPEND_REG</td><td>reg</td><td>append low byte of register</td></tr>
+    <tr><td>0x05</td><td>TXRX</td><td>flags(4), FWT(4)</td><td>transceive tx buffer, keep status and response</td></tr>
+    <tr><td>0x06</td><td>REG_SET</td><td>reg, value(2)</td><td>register = value</td></tr>
+    <tr><td>0x07</td><td>REG_INC</td><td>reg</td><td>register += 1</td></tr>
+    <tr><td>0x08</td><td>LOOP</td><td>reg, target(2)</td><td>register -= 1, jump to target if not 0</td></tr>
+    <tr><td>0x09</td><td>JMP</td><td>target(2)</td><td>jump to target</td></tr>
+    <tr><td>0x0A</td><td>JMP_STATUS_NE</td><td>status, target(2)</td><td>jump if status of last TXRX differs</td></tr>
+    <tr><td>0x0B</td><td>JMP_RX_NE</td><td>offset, mask, value, target(2)</td><td>jump if (response[offset] & mask) != value or response too short</td></tr>
+    <tr><td>0x0C</td><td>JMP_RX_EQ</td><td>offset, mask, value, target(2)</td><td>jump if (response[offset] & mask) == value</td></tr>
+    <tr><td>0x0D</td><td>DELAY</td><td>ms(2)</td><td>wait</td></tr>
+    <tr><td>0x0E</td><td>FIELD</td><td>on</td><td>field on (and start GT) or off</td></tr>
+    <tr><td>0x0F</td><td>SET_MODE</td><td>mode, tx bit rate, rx bit rate</td><td>#rfalSetMode()</td></tr>
+    <tr><td>0x10</td><td>SET_BITRATE</td><td>tx bit rate, rx bit rate</td><td>#rfalSetBitRate()</td></tr>
+    <tr><td>0x11</td><td>EMIT</td><td>offset, len</td><td>emit record of up to len response bytes starting at offset</td></tr>
+    <tr><td>0x12</td><td>FAIL</td><td>status</td><td>stop with the given status</td></tr>
+  </table>
+
+  An emitted record is:
+  <table>
+    <tr><th>   Byte</th><th>0</th><th>1</th><th>2..2+len-1</th></tr>
+    <tr><th>Content</th><td>status of last TXRX</td><td>len</td><td>response bytes</td></tr>
+  </table>
+
+  Returns ERR_PARAM on malformed scripts, ERR_NOMEM if records do not fit in the
+  response and ERR_TIMEOUT if #SCRIPT_MAX_STEPS opcodes did not reach END or the
+  run would take longer than #SCRIPT_MAX_TIME_MS: a DELAY or a TXRX whose FWT
+  does not fit in the time left stops the script before waiting. On an error
+  nothing is returned in \a txData.
+  */
+static ReturnCode processScript(const uint8_t *args, uint16_t argsLen, uint8_t *txData, uint16_t *txSize)
+{
+    /* number of operand bytes per opcode, TX_LOAD/TX_APPEND are followed by len data bytes */
+    static const uint8_t opLen[] = { 0, 1, 1, 2, 1, 8, 3, 1, 3, 2, 3, 5, 5, 2, 1, 3, 2, 2, 1 };
+    static uint8_t scriptTx[SCRIPT_TX_BUF_LEN];
+    static uint8_t scriptRx[SCRIPT_RX_BUF_LEN];
+    uint16_t   regs[SCRIPT_NUM_REGS] = {0};
+    uint16_t   pc       = 0;
+    uint16_t   txLen    = 0;
+    uint16_t   rxLen    = 0;
+    uint16_t   outPos   = 2;
+    uint16_t   steps    = 0;
+    uint32_t   start    = platformGetSysTick();
+    uint32_t   left;
+    ReturnCode rxStatus = ERR_NONE;
+    ReturnCode err      = ERR_BUSY;
+    uint8_t    opcode;
+    const uint8_t *op;
+
+    if (*txSize < 2)
+    {
+        *txSize = 0;
+        return ERR_PARAM;
+    }
+
+    while (err == ERR_BUSY)
+    {
+        if ((pc >= scriptLen) || (scriptBuf[pc] >= sizeof(opLen)) || ((scriptLen - pc - 1) < opLen[scriptBuf[pc]]))
+        {
+            err = ERR_PARAM;
+            break;
+        }
+        /* a LOOP must not keep the dispatcher busy for longer than the budget */
+        left = (platformGetSysTick() - start);
+        if ((++steps > SCRIPT_MAX_STEPS) || (left >= SCRIPT_MAX_TIME_MS))
+        {
+            err = ERR_TIMEOUT;
+            break;
+        }
+        left = (SCRIPT_MAX_TIME_MS - left);
+        opcode = scriptBuf[pc];
+        op     = &scriptBuf[pc + 1];
+        pc    += 1 + opLen[opcode];
+
+        switch (opcode)
+        {
+            case SCRIPT_OP_END:
+                err = ERR_NONE;
+                break;
+
+            case SCRIPT_OP_TX_LOAD:
+            case SCRIPT_OP_TX_APPEND:
+                if (opcode == SCRIPT_OP_TX_LOAD)
+                {
+                    txLen = 0;
+                }
+                if (((scriptLen - pc) < op[0]) || ((sizeof(scriptTx) - txLen) < op[0]))
+                {
+                    err = ERR_PARAM;
+                    break;
+                }
+                ST_MEMCPY( &scriptTx[txLen], &op[1], op[0] );
+                txLen += op[0];
+                pc    += op[0];
+                break;
+
+            case SCRIPT_OP_TX_APPEND_ARG:
+                if (((op[0] + op[1]) > argsLen) || ((sizeof(scriptTx) - txLen) < op[1]))
+                {
+                    err = ERR_PARAM;
+                    break;
+                }
+                ST_MEMCPY( &scriptTx[txLen], &args[op[0]], op[1] );
+                txLen += op[1];
+                break;
+
+            case SCRIPT_OP_TX_APPEND_REG:
+                if ((op[0] >= SCRIPT_NUM_REGS) || (txLen >= sizeof(scriptTx)))
+                {
+                    err = ERR_PARAM;
+                    break;
+                }
+                scriptTx[txLen++] = (uint8_t)regs[op[0]];
+                break;
+
+            case SCRIPT_OP_TXRX:
+                if (rfalConv1fcToMs( (((uint32_t)op[4]<<24) | ((uint32_t)op[5]<<16) | ((uint32_t)op[6]<<8) | op[7]) ) >= left)
+                { /* also catches RFAL_FWT_NONE */
+                    err = ERR_TIMEOUT;
+                    break;
+                }
+                rxLen    = 0;
+                rxStatus = rfalTransceiveBlockingTxRx( scriptTx, txLen, scriptRx, sizeof(scriptRx), &rxLen,
+                                                       ((op[0]<<24) | (op[1]<<16) | (op[2]<<8) | op[3]),
+                                                       ((op[4]<<24) | (op[5]<<16) | (op[6]<<8) | op[7]) );
+                rxLen    = MIN( rxLen, sizeof(scriptRx) );
+                break;
+
+            case SCRIPT_OP_REG_SET:
+            case SCRIPT_OP_REG_INC:
+            case SCRIPT_OP_LOOP:
+                if (op[0] >= SCRIPT_NUM_REGS)
+                {
+                    err = ERR_PARAM;
+                    break;
+                }
+                if (opcode == SCRIPT_OP_REG_SET)
+                {
+                    regs[op[0]] = ((op[1]<<8) | op[2]);
+                }
+                else if (opcode == SCRIPT_OP_REG_INC)
+                {
+                    regs[op[0]]++;
+                }
+                else if (--regs[op[0]] != 0)
+                {
+                    pc = ((op[1]<<8) | op[2]);
+                }
+                break;
+
+            case SCRIPT_OP_JMP:
+                pc = ((op[0]<<8) | op[1]);
+                break;
+
+            case SCRIPT_OP_JMP_STATUS_NE:
+                if (rxStatus != op[0])
+                {
+                    pc = ((op[1]<<8) | op[2]);
+                }
+                break;
+
+            case SCRIPT_OP_JMP_RX_NE:
+                if ((op[0] >= rxLen) || ((scriptRx[op[0]] & op[1]) != op[2]))
+                {
+                    pc = ((op[3]<<8) | op[4]);
+                }
+                break;
+
+            case SCRIPT_OP_JMP_RX_EQ:
+                if ((op[0] < rxLen) && ((scriptRx[op[0]] & op[1]) == op[2]))
+                {
+                    pc = ((op[3]<<8) | op[4]);
+                }
+                break;
+
+            case SCRIPT_OP_DELAY:
+                if ((uint32_t)((op[0]<<8) | op[1]) >= left)
+                {
+                    err = ERR_TIMEOUT;
+                    break;
+                }
+                platformDelay( ((op[0]<<8) | op[1]) );
+                break;
+
+            case SCRIPT_OP_FIELD:
+                if (op[0] != 0x00)
+                {
+                    rfalSetGT( RFAL_TIMING_NONE );
+                    rfalFieldOnAndStartGT();
+                }
+                else
+                {
+                    rfalFieldOff();
+                }
+                break;
+
+            case SCRIPT_OP_SET_MODE:
+                err = rfalSetMode( (rfalMode)op[0], (rfalBitRate)op[1], (rfalBitRate)op[2] );
+                if (err == ERR_NONE)
+                {
+                    err = ERR_BUSY;
+                }
+                break;
+
+            case SCRIPT_OP_SET_BITRATE:
+                err = rfalSetBitRate( (rfalBitRate)op[0], (rfalBitRate)op[1] );
+                if (err == ERR_NONE)
+                {
+                    err = ERR_BUSY;
+                }
+                break;
+
+            case SCRIPT_OP_EMIT:
+                {
+                uint16_t len = (op[0] < rxLen) ? (rxLen - op[0]) : 0;
+
+                len = MIN( len, op[1] );
+                if ((*txSize - outPos) < (2 + len))
+                {
+                    err = ERR_NOMEM;
+                    break;
+                }
+                txData[outPos + 0] = (uint8_t)rxStatus;
+                txData[outPos + 1] = (uint8_t)len;
+                ST_MEMCPY( &txData[outPos + 2], &scriptRx[op[0]], len );
+                outPos += 2 + len;
+                break;
+                }
+
+            case SCRIPT_OP_FAIL:
+                err = (ReturnCode)op[0];
+                if (err == ERR_BUSY)
+                {
+                    err = ERR_REQUEST;
+                }
+                break;
+
+            default:
+                err = ERR_PARAM;
+                break;
+        }
+    }
+
+    if (err != ERR_NONE)
+    {
+        *txSize = 0;
+        return err;
+    }
+
+    txData[0] = ((pc>>8)&0xFF);
+    txData[1] = ((pc>>0)&0xFF);
+    *txSize   = outPos;
+
+    return err;
+}
+
 uint8_t applProcessCyclic ( uint8_t * protocol, uint16_t * txSize, uint8_t * txData, uint16_t remainingSize )
 {
   if ( counter == 0 ){ /* do not log this every time : is called cyclic */
   }
   counter++;
   *txSize = 0;
+  if (uidSetEnabled)
+  {
+      processUidSetExpire(txData, txSize, remainingSize);
+      if (*txSize > 0)
+      {
+          *protocol = uidSetProtocol;
+          return ST_STREAM_NO_ERROR;
+      }
+  }
+  if (ERR_BUSY == rfalCoroutineGetStatus())
+  { /* RF is owned by the background operation */
+      return ST_STREAM_NO_ERROR;
+  }
+  if (iso15693StreamRunning)
+  {
+      *protocol = iso15693StreamProtocol;
+      return (uint8_t)processIso15693Stream(txData, txSize, remainingSize);
+  }
+  if (iso15693DumpRunning)
+  {
+      *protocol = iso15693StreamProtocol;
+      return (uint8_t)processIso15693Dump(txData, txSize, remainingSize);
+  }
+  if (mifareUlDumpRunning)
+  {
+      *protocol = mifareUlDumpProtocol;
+      return (uint8_t)processMifareUlDump(txData, txSize, remainingSize);
+  }
+  if (st25tbDumpRunning)
+  {
+      *protocol = st25tbDumpProtocol;
+      return (uint8_t)processSt25tbDump(txData, txSize, remainingSize);
+  }
+  if (isoDepPipeRunning)
+  {
+      *protocol = isoDepPipeProtocol;
+      return (uint8_t)processIsoDepPipe(txData, txSize, remainingSize);
+  }
+  if (nfcDepPipeIsActive())
+  { /* nothing streamed, the host reads with NFC_CMD_NFCDEP_RX */
+      nfcDepPipeWorker();
+  }
   return ST_STREAM_NO_ERROR; /* cyclic is always called, so it is no error
                                    if there is no function */
 }
@@ -62,11 +62,28 @@
    communication. Limit to 10ms = 21186 * 64/fc. */
 #define FELICA_FRAME_WAIT_TIME  21186
 
+/* PMm byte holding the maximum response time parameters of Read */
+#define FELICA_PMM_READ_POS 5
+
+/* unit of the maximum response time: T = 256 * 16/fc */
+#define FELICA_RESPONSE_TIME_T0 4096
+
+/* IC types of FeliCa Lite (0xF0) and Lite-S (0xF1) in PMm byte 1 */
+#define FELICA_PMM_IC_TYPE_POS 1
+#define FELICA_IC_TYPE_LITE_MASK 0xFE
+#define FELICA_IC_TYPE_LITE 0xF0
+
+#define FELICA_READ_MAX_FAILS 3
+
+/* LEN, response code, IDm, status flags, number of blocks */
+#define FELICA_READ_RES_HEADER_LEN (1 + 1 + FELICA_MAX_ID_LENGTH + 2 + 1)
+
 /*
 ******************************************************************************
 * LOCAL FUNCTION PROTOTYPES
 ******************************************************************************
 */
+static uint32_t felicaReadFwt(const uint8_t *pmm, uint8_t numBlocks);
 
 /*
 ******************************************************************************
@@ -110,3 +127,194 @@ ReturnCode felicaPoll(enum felicaSlots slots, uint8_t sysCode1, uint8_t sysCode2
                             num_cols );
 
 }
+
+ReturnCode felicaReadBlocks(const uint8_t *idm, const uint8_t *pmm,
+                     const struct felicaBlockRange *ranges, uint8_t numRanges, uint8_t maxPerCmd,
+                     uint8_t *data, uint16_t dataSize, struct felicaReadResult *result)
+{
+    uint8_t  txBuf[1 + 1 + FELICA_MAX_ID_LENGTH + 1 + (2 * FELICA_MAX_SERVICES_PER_READ) + 1 + (3 * FELICA_MAX_BLOCKS_PER_READ)];
+    uint8_t  rxBuf[FELICA_READ_RES_HEADER_LEN + (FELICA_BLOCK_LENGTH * FELICA_MAX_BLOCKS_PER_READ)];
+    uint8_t  blkList[3 * FELICA_MAX_BLOCKS_PER_READ];
+    uint16_t services[FELICA_MAX_SERVICES_PER_READ];
+    uint8_t  range = 0;      /* position of the next block to read */
+    uint8_t  offset = 0;
+    uint8_t  chunk;
+    uint8_t  fails = 0;
+    uint8_t  numSvc;
+    uint8_t  numBlk;
+    uint8_t  blkLen;
+    uint8_t  r;
+    uint8_t  o;
+    uint8_t  s;
+    uint16_t block;
+    uint16_t total = 0;
+    uint16_t rxLen;
+    uint16_t pos;
+    ReturnCode err = ERR_NONE;
+
+    ST_MEMSET(result, 0, sizeof(struct felicaReadResult));
+
+    if (maxPerCmd > FELICA_MAX_BLOCKS_PER_READ)
+    {
+        return ERR_PARAM;
+    }
+    for (r = 0; r < numRanges; r++)
+    {
+        if (ranges[r].numBlocks == 0)
+        {
+            return ERR_PARAM;
+        }
+        total += ranges[r].numBlocks;
+    }
+    if (((uint32_t)total * FELICA_BLOCK_LENGTH) > dataSize)
+    {
+        return ERR_NOMEM;
+    }
+
+    if (maxPerCmd == 0)
+    {
+        maxPerCmd = (((pmm[FELICA_PMM_IC_TYPE_POS] & FELICA_IC_TYPE_LITE_MASK) == FELICA_IC_TYPE_LITE) ?
+                     FELICA_LITE_BLOCKS_PER_READ : FELICA_MAX_BLOCKS_PER_READ);
+    }
+    chunk = maxPerCmd;
+
+    while (range < numRanges)
+    {
+        /* take the next blocks, adding their services to the service list */
+        numSvc = 0;
+        numBlk = 0;
+        blkLen = 0;
+        r = range;
+        o = offset;
+        while ((numBlk < chunk) && (r < numRanges))
+        {
+            for (s = 0; (s < numSvc) && (services[s] != ranges[r].serviceCode); s++)
+            {
+            }
+            if (s == numSvc)
+            {
+                if (numSvc == FELICA_MAX_SERVICES_PER_READ)
+                {
+                    break;
+                }
+                services[numSvc++] = ranges[r].serviceCode;
+            }
+
+            block = ranges[r].firstBlock + o;
+            if (block <= 0xFF)
+            { /* 2 byte block list element */
+                blkList[blkLen++] = 0x80 | s;
+                blkList[blkLen++] = (uint8_t)block;
+            }
+            else
+            {
+                blkList[blkLen++] = s;
+                blkList[blkLen++] = (uint8_t)(block & 0xFF);
+                blkList[blkLen++] = (uint8_t)(block >> 8);
+            }
+            numBlk++;
+
+            if (++o == ranges[r].numBlocks)
+            {
+                r++;
+                o = 0;
+            }
+        }
+
+        pos = 1;
+        txBuf[pos++] = FELICA_CMD_READ_WITHOUT_ENCRYPTION;
+        ST_MEMCPY(&txBuf[pos], idm, FELICA_MAX_ID_LENGTH);
+        pos += FELICA_MAX_ID_LENGTH;
+        txBuf[pos++] = numSvc;
+        for (s = 0; s < numSvc; s++)
+        { /* service codes go LSB first into the frame */
+            txBuf[pos++] = (uint8_t)(services[s] & 0xFF);
+            txBuf[pos++] = (uint8_t)(services[s] >> 8);
+        }
+        txBuf[pos++] = numBlk;
+        ST_MEMCPY(&txBuf[pos], blkList, blkLen);
+        pos += blkLen;
+        txBuf[0] = (uint8_t)pos;
+
+        /* status flags are those of the last command */
+        result->statusFlag1 = 0;
+        result->statusFlag2 = 0;
+        err = rfalTransceiveBlockingTxRx(txBuf, pos, rxBuf, sizeof(rxBuf), &rxLen, RFAL_TXRX_FLAGS_DEFAULT, felicaReadFwt(pmm, numBlk));
+        if ((ERR_NONE == err) &&
+            ((rxLen < (FELICA_READ_RES_HEADER_LEN - 1)) || (rxBuf[1] != (FELICA_CMD_READ_WITHOUT_ENCRYPTION + 1)) ||
+             (ST_BYTECMP(&rxBuf[2], idm, FELICA_MAX_ID_LENGTH) != 0)))
+        {
+            err = ERR_PROTO;
+        }
+        if (ERR_NONE == err)
+        {
+            result->statusFlag1 = rxBuf[10];
+            result->statusFlag2 = rxBuf[11];
+            if (result->statusFlag1 != 0)
+            {
+                err = ERR_PROTO;
+            }
+            else if ((rxLen < (FELICA_READ_RES_HEADER_LEN + (numBlk * FELICA_BLOCK_LENGTH))) || (rxBuf[12] != numBlk))
+            {
+                err = ERR_PROTO;
+            }
+        }
+
+        if (ERR_NONE != err)
+        {
+            result->failures++;
+            /* a single block rejected by the card will not succeed on retry */
+            if ((++fails >= FELICA_READ_MAX_FAILS) || ((numBlk == 1) && (result->statusFlag1 != 0)))
+            {
+                break;
+            }
+            chunk = MAX(numBlk / 2, 1);
+            if (result->statusFlag1 != 0)
+            { /* the card takes less blocks at once than assumed, do not try more again */
+                maxPerCmd = chunk;
+            }
+            continue;
+        }
+
+        ST_MEMCPY(&data[result->blocks * FELICA_BLOCK_LENGTH], &rxBuf[FELICA_READ_RES_HEADER_LEN], numBlk * FELICA_BLOCK_LENGTH);
+        result->blocks += numBlk;
+        result->commands++;
+        /* a frame lost to noise must not slow down the rest of the read */
+        chunk = MIN(2 * chunk, maxPerCmd);
+        fails = 0;
+        range = r;
+        offset = o;
+    }
+
+    return err;
+}
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+/*!
+ *****************************************************************************
+ *  \brief  Get the FWT of a Read command
+ *
+ *  The Read parameter of the PMm codes the maximum response time as
+ *  T0 * ((B + 1) * n + (A + 1)) * 4^E with A in bits 0..2, B in bits 3..5
+ *  and E in bits 6..7, n being the number of blocks.
+ *
+ *  \return FWT in 1/fc, limited to FELICA_FRAME_WAIT_TIME
+ *
+ *****************************************************************************
+ */
+static uint32_t felicaReadFwt(const uint8_t *pmm, uint8_t numBlocks)
+{
+    uint8_t param = pmm[FELICA_PMM_READ_POS];
+    uint32_t a = (param & 0x07) + 1;
+    uint32_t b = ((param >> 3) & 0x07) + 1;
+    uint32_t e = (param >> 6);
+    uint32_t fwt;
+
+    fwt = (FELICA_RESPONSE_TIME_T0 * ((b * numBlocks) + a)) << (2 * e);
+
+    return MIN(fwt, rfalConv64fcTo1fc(FELICA_FRAME_WAIT_TIME));
+}
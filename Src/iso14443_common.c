@@ -41,6 +41,7 @@
 #include "utils.h"
 #include "rfal_rf.h"
 #include "rfal_isoDep.h"
+#include "rf_pipe.h"
 
 /*
 ******************************************************************************
@@ -49,45 +50,90 @@
 */
 #define ISO14443_CMD_DESELECT  0xca /*!< command DESELECT */
 
+#define ISO14443_PIPE_INF_LEN  sizeof(iso14443TmpBuf.inf) /*!< longest INF of an I-block        */
+
 rfalIsoDepApduTxRxParam iso14443L4TxRxParams;
 rfalIsoDepApduBufFormat iso14443TxBuf;
 rfalIsoDepApduBufFormat iso14443RxBuf;
 rfalIsoDepBufFormat     iso14443TmpBuf;          /*!< Temp buffer for Rx I-Blocks (internal)   */
 
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+/*! APDU pipe, the command APDU is staged in iso14443TxBuf.apdu, the
+    response is queued in iso14443RxBuf.apdu */
+static rfPipe_t iso14443Pipe = { .txBuf = iso14443TxBuf.apdu, .txSize = sizeof(iso14443TxBuf.apdu),
+                                 .rxBuf = iso14443RxBuf.apdu, .rxSize = sizeof(iso14443RxBuf.apdu) };
+static bool     iso14443PipeRxChaining;  /*!< set by ISO-DEP, more I-blocks follow      */
+static uint16_t iso14443PipeRxLen;       /*!< set by ISO-DEP, INF length of the I-block */
+static uint16_t iso14443PipeTxBlockLen;  /*!< bytes of the running I-block              */
+
+/*
+******************************************************************************
+* LOCAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+static ReturnCode iso14443L4PipeSend(void);
+static ReturnCode iso14443L4PipeRun(void);
+
 /*
 ******************************************************************************
 * GLOBAL FUNCTIONS
 ******************************************************************************
 */
 
-ReturnCode iso14443TransmitAndReceiveL4(const uint8_t* txbuf,
-                                    uint16_t txlen,
-                                    uint8_t* rxbuf,
-                                    uint16_t rxlen,
-                                    uint16_t* actrxlength)
+ReturnCode iso14443TransmitAndReceiveL4Co(coroutine_t *co, void *arg)
 {
-    ReturnCode err;
+    iso14443L4Context_t *l4 = (iso14443L4Context_t*)arg;
+    ReturnCode err = ERR_NONE;
 
-    *actrxlength = 0;
+    CO_BEGIN(co);
 
-    memcpy(iso14443TxBuf.apdu,txbuf, txlen);
+    *l4->actrxlength = 0;
+
+    memcpy(iso14443TxBuf.apdu, l4->txbuf, l4->txlen);
     iso14443L4TxRxParams.txBuf = &iso14443TxBuf;
-    iso14443L4TxRxParams.txBufLen = txlen;
+    iso14443L4TxRxParams.txBufLen = l4->txlen;
     iso14443L4TxRxParams.rxBuf = &iso14443RxBuf;
-    iso14443L4TxRxParams.rxLen = &rxlen;
+    iso14443L4TxRxParams.rxLen = &l4->rxlen;
     iso14443L4TxRxParams.tmpBuf = &iso14443TmpBuf;
 
     err = rfalIsoDepStartApduTransceive( iso14443L4TxRxParams );
-    if (err) return err;
+    CO_EXIT_ON_ERR(co, err);
+
+    CO_WAIT_WHILE(co, ERR_BUSY == (err = rfalIsoDepGetApduTransceiveStatus()));
 
-    while(ERR_BUSY == (err= rfalIsoDepGetApduTransceiveStatus()))
+    if (ERR_NONE == err)
     {
-        rfalWorker();
+        *l4->actrxlength = l4->rxlen;
+        memcpy(l4->rxbuf, iso14443RxBuf.apdu, *l4->actrxlength);
     }
-    if (ERR_NONE == err)
+
+    CO_END(co, err);
+}
+
+ReturnCode iso14443TransmitAndReceiveL4(const uint8_t* txbuf,
+                                    uint16_t txlen,
+                                    uint8_t* rxbuf,
+                                    uint16_t rxlen,
+                                    uint16_t* actrxlength)
+{
+    ReturnCode err;
+    coroutine_t co;
+    iso14443L4Context_t l4;
+
+    l4.txbuf = txbuf;
+    l4.txlen = txlen;
+    l4.rxbuf = rxbuf;
+    l4.rxlen = rxlen;
+    l4.actrxlength = actrxlength;
+
+    CO_INIT(&co);
+    while(ERR_BUSY == (err = iso14443TransmitAndReceiveL4Co(&co, &l4)))
     {
-        *actrxlength = rxlen;
-        memcpy(rxbuf,iso14443RxBuf.apdu,*actrxlength);
+        rfalWorker();
     }
     return err;
 }
@@ -106,7 +152,200 @@ ReturnCode iso14443TransmitAndReceive(const uint8_t* txbuf, uint16_t txlen, uint
 }
 
 
+void iso14443L4SetDevice(const rfalIsoDepDevice *dev, rfalIsoDepFSxI fsdi, iso14443L4Activation_t *act)
+{
+    iso14443L4TxRxParams.FWT    = dev->info.FWT;
+    iso14443L4TxRxParams.dFWT   = dev->info.dFWT;
+    iso14443L4TxRxParams.FSx    = dev->info.FSx;
+    iso14443L4TxRxParams.ourFSx = rfalIsoDepFSxI2FSx(fsdi);
+    iso14443L4TxRxParams.DID    = dev->info.DID;
+
+    act->dsi  = dev->info.DSI;
+    act->dri  = dev->info.DRI;
+    act->fsc  = dev->info.FSx;
+    act->fsd  = iso14443L4TxRxParams.ourFSx;
+    act->fwi  = dev->info.FWI;
+    act->sfgi = dev->info.SFGI;
+    act->did  = dev->info.DID;
+}
+
 ReturnCode iso14443Deselect( void )
 {
     return rfalIsoDepDeselect();
 }
+
+ReturnCode iso14443L4PipeWrite(const uint8_t *data, uint16_t len, bool last)
+{
+    ReturnCode err;
+
+    /* the running I-block stays in place, data is appended behind it */
+    err = rfPipeStage(&iso14443Pipe, data, len, last);
+    if ((ERR_NONE != err) || iso14443Pipe.running)
+    {
+        return err;
+    }
+    return iso14443L4PipeSend();
+}
+
+ReturnCode iso14443L4PipeRead(uint8_t *buf, uint16_t bufLen, uint16_t *len)
+{
+    ReturnCode err;
+
+    *len = 0;
+
+    if (!iso14443Pipe.active)
+    {
+        return ERR_WRONG_STATE;
+    }
+
+    if (!iso14443Pipe.rxDone)
+    {
+        err = iso14443L4PipeRun();
+        if (ERR_NONE != err)
+        {
+            iso14443Pipe.active = false;
+            return err;
+        }
+    }
+    return rfPipeRead(&iso14443Pipe, buf, bufLen, len);
+}
+
+uint16_t iso14443L4PipeTxFree(void)
+{
+    return rfPipeTxFree(&iso14443Pipe);
+}
+
+bool iso14443L4PipeIsActive(void)
+{
+    return iso14443Pipe.active;
+}
+
+void iso14443L4PipeAbort(void)
+{
+    ReturnCode err;
+
+    if (!iso14443Pipe.active)
+    {
+        return;
+    }
+    iso14443Pipe.active = false;
+
+    if (iso14443Pipe.running)
+    { /* let the block on the air finish, the PICC would not take an S-block now */
+        /* a chained response is received to its end and dropped */
+        while ((ERR_BUSY == (err = rfalIsoDepGetTransceiveStatus())) || (ERR_AGAIN == err))
+        {
+            rfalWorker();
+        }
+        iso14443Pipe.running = false;
+    }
+
+    /* the next exchange must not go on with the block number and
+       chaining state of the aborted one */
+    err = rfalIsoDepDeselect();
+    if (ERR_NONE != err)
+    { /* also when S(DESELECT) could not be sent */
+        rfalIsoDepInitialize();
+    }
+}
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+/*!
+ *****************************************************************************
+ *  \brief  Start the next I-block of the command APDU if there is one
+ *****************************************************************************
+ */
+static ReturnCode iso14443L4PipeSend(void)
+{
+    rfalIsoDepTxRxParam param;
+    uint16_t maxInf;
+    ReturnCode err;
+
+    /* same as rfalIsoDepGetMaxInfLen() which is valid only once a transceive started */
+    maxInf = iso14443L4TxRxParams.FSx - RFAL_ISODEP_PCB_LEN - RFAL_ISODEP_DID_LEN - RFAL_CRC_LEN;
+    maxInf = MIN(maxInf, ISO14443_PIPE_INF_LEN);
+
+    if (!rfPipeNextFrame(&iso14443Pipe, maxInf, &param.txBufLen, &param.isTxChaining))
+    { /* wait for more data */
+        return ERR_NONE;
+    }
+
+    /* the prologue lies in front of the staged data, so it is sent in place */
+    param.txBuf        = (rfalIsoDepBufFormat*)&iso14443TxBuf;
+    param.rxBuf        = &iso14443TmpBuf;
+    param.rxLen        = &iso14443PipeRxLen;
+    param.isRxChaining = &iso14443PipeRxChaining;
+    param.FWT          = iso14443L4TxRxParams.FWT;
+    param.dFWT         = iso14443L4TxRxParams.dFWT;
+    param.ourFSx       = iso14443L4TxRxParams.ourFSx;
+    param.FSx          = iso14443L4TxRxParams.FSx;
+    param.DID          = iso14443L4TxRxParams.DID;
+
+    err = rfalIsoDepStartTransceive(param);
+    if (ERR_NONE == err)
+    {
+        iso14443Pipe.running    = true;
+        iso14443Pipe.txChaining = param.isTxChaining;
+        iso14443PipeTxBlockLen  = param.txBufLen;
+    }
+    return err;
+}
+
+/*!
+ *****************************************************************************
+ *  \brief  Advance the APDU exchange
+ *
+ *  The next I-block is taken only when the ring can hold it.
+ *
+ *  \return ERR_NONE : No error, exchange is ongoing or done.
+ *  \return others : ISO-DEP error, exchange is over.
+ *
+ *****************************************************************************
+ */
+static ReturnCode iso14443L4PipeRun(void)
+{
+    ReturnCode err;
+
+    if (!iso14443Pipe.running)
+    {
+        return iso14443L4PipeSend();
+    }
+
+    if (rfPipeRxFree(&iso14443Pipe) < ISO14443_PIPE_INF_LEN)
+    {
+        return ERR_NONE;
+    }
+
+    err = rfalIsoDepGetTransceiveStatus();
+    switch (err)
+    {
+        case ERR_BUSY:
+            return ERR_NONE;
+
+        case ERR_AGAIN:
+            /* the R(ACK) is sent already: the next I-block arrives in
+               iso14443TmpBuf with the next rfalWorker() */
+            rfPipeQueue(&iso14443Pipe, iso14443TmpBuf.inf, MIN(iso14443PipeRxLen, ISO14443_PIPE_INF_LEN));
+            return ERR_NONE;
+
+        case ERR_NONE:
+            if (iso14443Pipe.txChaining)
+            { /* R(ACK) of a chained I-block */
+                iso14443Pipe.running = false;
+                rfPipeDrop(&iso14443Pipe, iso14443PipeTxBlockLen);
+                return iso14443L4PipeSend();
+            }
+            rfPipeQueue(&iso14443Pipe, iso14443TmpBuf.inf, MIN(iso14443PipeRxLen, ISO14443_PIPE_INF_LEN));
+            iso14443Pipe.running = false;
+            iso14443Pipe.rxDone  = true;
+            return ERR_NONE;
+
+        default:
+            return err;
+    }
+}
+
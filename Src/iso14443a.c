@@ -53,6 +53,13 @@
 /*  REQA, etc. have much shorter time of 1172/fc ~= 19*64/fc */
 #define ISO14443A_INVENTORY_WAITING_TIME 35
 
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static rfalNfcaListenDevice iso14443ADevices[ISO14443A_MAX_CARDS]; /*!< result of #iso14443AResolveAll */
+
 /*
 ******************************************************************************
 * GLOBAL FUNCTIONS
@@ -125,6 +132,58 @@ ReturnCode iso14443ASendHlta()
     return rfalNfcaPollerSleep();
 }
 
+ReturnCode iso14443AResolveAll(uint8_t options, iso14443AProximityCard_t* cards, uint8_t maxCards, uint8_t* cardsFound)
+{
+    ReturnCode err;
+    uint8_t devCnt = 0;
+    uint8_t i;
+
+    *cardsFound = 0;
+    if ((maxCards == 0) || (maxCards > ISO14443A_MAX_CARDS))
+    {
+        return ERR_PARAM;
+    }
+
+    if (options & ISO14443A_RESOLVE_OPT_WUPA)
+    { /* RFAL sends WUPA and halts every PICC resolved */
+        err = rfalNfcaPollerFullCollisionResolution(RFAL_COMPLIANCE_MODE_NFC, maxCards, iso14443ADevices, &devCnt);
+    }
+    else
+    { /* ISO mode expects the PICCs in READY state already */
+        err = rfalNfcaPollerCheckPresence(RFAL_14443A_SHORTFRAME_CMD_REQA, &iso14443ADevices[0].sensRes);
+        if (ERR_NONE == err)
+        {
+            err = rfalNfcaPollerFullCollisionResolution(RFAL_COMPLIANCE_MODE_ISO, maxCards, iso14443ADevices, &devCnt);
+        }
+    }
+
+    if ((devCnt > 0) && (options & ISO14443A_RESOLVE_OPT_HALT_LAST) && !iso14443ADevices[devCnt - 1].isSleep)
+    {
+        rfalNfcaPollerSleep();
+        iso14443ADevices[devCnt - 1].isSleep = true;
+    }
+
+    for (i = 0; i < devCnt; i++)
+    {
+        ST_MEMSET(&cards[i], 0, sizeof(iso14443AProximityCard_t));
+        ST_MEMCPY(cards[i].uid, iso14443ADevices[i].nfcId1, iso14443ADevices[i].nfcId1Len);
+        cards[i].actlength = iso14443ADevices[i].nfcId1Len;
+        ST_MEMCPY(cards[i].atqa, &iso14443ADevices[i].sensRes, sizeof(cards[i].atqa));
+        cards[i].sak[0] = iso14443ADevices[i].selRes.sak;
+        cards[i].cascadeLevels = (cards[i].actlength == RFAL_NFCA_CASCADE_3_UID_LEN) ? 3 :
+                                 ((cards[i].actlength == RFAL_NFCA_CASCADE_2_UID_LEN) ? 2 : 1);
+        cards[i].collision = (devCnt > 1);
+    }
+    *cardsFound = devCnt;
+
+    if ((ERR_TIMEOUT == err) && (devCnt == 0))
+    {
+        err = ERR_NOTFOUND;
+    }
+
+    return err;
+}
+
 extern rfalIsoDepApduTxRxParam iso14443L4TxRxParams;
 
 ReturnCode iso14443AEnterProtocolMode(uint8_t fscid, uint8_t* answer, uint16_t maxlength, uint16_t* length)
@@ -155,6 +214,37 @@ ReturnCode iso14443AEnterProtocolMode(uint8_t fscid, uint8_t* answer, uint16_t m
     return err;
 }
 
+ReturnCode iso14443AActivate(uint8_t maxBR, uint8_t did, iso14443L4Activation_t* act)
+{
+    ReturnCode err;
+    rfalIsoDepDevice dev;
+
+    if ((maxBR > RFAL_BR_848) || (did > RFAL_ISODEP_DID_MAX))
+    {
+        return ERR_PARAM;
+    }
+
+    rfalIsoDepInitialize();
+
+    err = rfalIsoDepPollAHandleActivation(ISO14443_L4_MAX_FSDI, did, (rfalBitRate)maxBR, &dev);
+
+    /* map timeout error to PICC not found */
+    if (ERR_TIMEOUT == err)
+    {
+        err = ERR_NOTFOUND;
+    }
+    if (ERR_NONE != err)
+    {
+        return err;
+    }
+
+    iso14443L4SetDevice(&dev, ISO14443_L4_MAX_FSDI, act);
+    act->answerLen = MIN(dev.activation.A.Listener.ATSLen, sizeof(act->answer));
+    ST_MEMCPY(act->answer, &dev.activation.A.Listener.ATS, act->answerLen);
+
+    return ERR_NONE;
+}
+
 ReturnCode iso14443ASendProtocolAndParameterSelection(uint8_t cid, uint8_t pps1)
 {
     ReturnCode err;
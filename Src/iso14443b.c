@@ -60,6 +60,13 @@
    communication. Limit to 100ms = 21186 * 64/fc. */
 #define ISO14443B_FRAME_DELAY_TIME  21186
 
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static rfalNfcbListenDevice iso14443BDevices[ISO14443B_MAX_CARDS]; /*!< result of #iso14443BResolveAll */
+
 /*
 ******************************************************************************
 * LOCAL FUNCTION PROTOTYPES
@@ -146,6 +153,50 @@ ReturnCode iso14443BSelect(iso14443BCommand_t cmd,
     return err;
 }
 
+ReturnCode iso14443BResolveAll(uint8_t afi,
+                iso14443BSlotCount_t initSlots,
+                iso14443BSlotCount_t endSlots,
+                iso14443BProximityCard_t* cards,
+                uint8_t maxCards,
+                uint8_t* cardsFound,
+                bool* colPending)
+{
+    ReturnCode err;
+    uint8_t devCnt = 0;
+    uint8_t i;
+
+    *cardsFound = 0;
+    *colPending = false;
+    if ((maxCards == 0) || (maxCards > ISO14443B_MAX_CARDS) ||
+        (endSlots > ISO14443B_SLOT_COUNT_16) || (initSlots > endSlots))
+    {
+        return ERR_PARAM;
+    }
+
+    /* Configure AFI on the NFCB module */
+    rfalNfcbPollerInitializeWithParams( afi, 0x00 );
+
+    /* NFC Forum mode starts with ALLB_REQ (WUPB) and allows more than one initial slot */
+    err = rfalNfcbPollerCollisionResolutionSlotted( RFAL_COMPLIANCE_MODE_NFC, maxCards,
+                    (rfalNfcbSlots)initSlots, (rfalNfcbSlots)endSlots, iso14443BDevices, &devCnt, colPending );
+
+    for (i = 0; i < devCnt; i++)
+    {
+        ST_MEMSET(&cards[i], 0, sizeof(iso14443BProximityCard_t));
+        ST_MEMCPY(&cards[i], (uint8_t*)&iso14443BDevices[i].sensbRes, MIN(iso14443BDevices[i].sensbResLen, ISO14443B_ATQB_LENGTH));
+        cards[i].collision = ((devCnt > 1) || *colPending);
+    }
+    *cardsFound = devCnt;
+
+    if ((devCnt == 0) && ((ERR_TIMEOUT == err) || (ERR_NONE == err)))
+    {
+        /* Remap Timeout to Not Found */
+        err = ERR_NOTFOUND;
+    }
+
+    return err;
+}
+
 ReturnCode iso14443BSendHltb(iso14443BProximityCard_t* card)
 {
     return rfalNfcbPollerSleep( card->pupi );
@@ -186,3 +237,46 @@ ReturnCode iso14443BEnterProtocolMode(iso14443BProximityCard_t* card,
     return err;
 }
 
+ReturnCode iso14443BActivate(const iso14443BProximityCard_t* card, uint8_t maxBR, uint8_t did, iso14443L4Activation_t* act)
+{
+    ReturnCode err;
+    rfalNfcbListenDevice nfcbDev;
+    rfalIsoDepDevice dev;
+
+    if ((maxBR > RFAL_BR_848) || (did > RFAL_ISODEP_DID_MAX))
+    {
+        return ERR_PARAM;
+    }
+
+    /* the card holds the SENSB_RES as received */
+    ST_MEMSET(&nfcbDev, 0, sizeof(nfcbDev));
+    ST_MEMCPY(&nfcbDev.sensbRes, card, RFAL_NFCB_SENSB_RES_LEN);
+    nfcbDev.sensbResLen = RFAL_NFCB_SENSB_RES_LEN;
+
+    if (!(nfcbDev.sensbRes.protInfo.FwiAdcFo & RFAL_NFCB_SENSB_RES_FO_DID_MASK))
+    { /* RFAL refuses a DID the PICC does not support */
+        did = RFAL_ISODEP_NO_DID;
+    }
+
+    rfalIsoDepInitialize();
+
+    err = rfalIsoDepPollBHandleActivation(ISO14443_L4_MAX_FSDI, did, (rfalBitRate)maxBR,
+            RFAL_ISODEP_ATTRIB_REQ_PARAM1_DEFAULT, &nfcbDev, NULL, 0, &dev);
+
+    if (ERR_TIMEOUT == err)
+    {
+        /* Remap Timeout to Not Found */
+        err = ERR_NOTFOUND;
+    }
+    if (ERR_NONE != err)
+    {
+        return err;
+    }
+
+    iso14443L4SetDevice(&dev, ISO14443_L4_MAX_FSDI, act);
+    act->answerLen = MIN(dev.activation.B.Listener.ATTRIB_RESLen, sizeof(act->answer));
+    ST_MEMCPY(act->answer, &dev.activation.B.Listener.ATTRIB_RES, act->answerLen);
+
+    return ERR_NONE;
+}
+
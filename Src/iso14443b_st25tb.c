@@ -50,6 +50,7 @@
 * LOCAL DEFINES
 ******************************************************************************
 */
+#define ISO14443B_ST25TB_DUMP_RETRIES 2 /*!< repetitions of a failed block read */
 
 /*
 ******************************************************************************
@@ -57,6 +58,12 @@
 ******************************************************************************
 */
 
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static rfalSt25tbListenDevice iso14443B_ST25TB_Devices[ISO14443B_ST25TB_MAX_TAGS]; /*!< result of the collision resolution */
 
 /*
 ******************************************************************************
@@ -128,3 +135,119 @@ ReturnCode iso14443B_ST25TB_SingulateAndGetUID(iso14443B_ST25TB_t *card)
 
     return err;
 }
+
+ReturnCode iso14443B_ST25TB_ResolveAll(iso14443B_ST25TB_t *cards, uint8_t maxCards, uint8_t *cardsFound)
+{
+    ReturnCode err;
+    uint8_t devCnt = 0;
+    uint8_t i;
+
+    *cardsFound = 0;
+    if ((maxCards == 0) || (maxCards > ISO14443B_ST25TB_MAX_TAGS))
+    {
+        return ERR_PARAM;
+    }
+
+    err = rfalSt25tbPollerCollisionResolution( maxCards, iso14443B_ST25TB_Devices, &devCnt );
+    for (i = 0; i < devCnt; i++)
+    {
+        cards[i].Chip_ID = iso14443B_ST25TB_Devices[i].chipID;
+        ST_MEMCPY( cards[i].uid, iso14443B_ST25TB_Devices[i].UID, RFAL_ST25TB_UID_LEN );
+        cards[i].collision = (devCnt > 1);
+    }
+    *cardsFound = devCnt;
+
+    if (devCnt == 0)
+    {
+        return ((ERR_NONE == err) ? ERR_NOTFOUND : err);
+    }
+
+    return ERR_NONE;
+}
+
+ReturnCode iso14443B_ST25TB_DumpInit(iso14443B_ST25TB_Dump_t *dump, uint8_t firstBlock, uint8_t lastBlock, uint8_t maxTags, bool complete)
+{
+    if (firstBlock > lastBlock)
+    {
+        return ERR_PARAM;
+    }
+
+    ST_MEMSET(dump, 0, sizeof(iso14443B_ST25TB_Dump_t));
+    dump->firstBlock = firstBlock;
+    dump->lastBlock = lastBlock;
+    dump->nextBlock = firstBlock;
+    dump->complete = complete;
+
+    return iso14443B_ST25TB_ResolveAll(dump->tags, maxTags, &dump->numTags);
+}
+
+ReturnCode iso14443B_ST25TB_DumpChunk(iso14443B_ST25TB_Dump_t *dump, uint8_t *rxBuf, uint16_t rxBufLen, uint8_t *tag, uint8_t *startBlock, uint8_t *numBlocks)
+{
+    ReturnCode err = ERR_NONE;
+    uint16_t num = 0;
+    uint16_t ask;
+
+    *tag = dump->tag;
+    *startBlock = (uint8_t)dump->nextBlock;
+    *numBlocks = 0;
+
+    if (dump->tag >= dump->numTags)
+    {
+        return ERR_NONE;
+    }
+
+    ask = MIN(rxBufLen / ISO14443B_ST25TB_BLOCKSIZE, 0xFF);
+    if (ask == 0)
+    {
+        return ERR_NOMEM;
+    }
+
+    /* the tag selected before falls back to Deselected state */
+    while ((num < ask) && (dump->nextBlock <= dump->lastBlock))
+    {
+        if (!dump->selected)
+        {
+            err = rfalSt25tbPollerSelect( dump->tags[dump->tag].Chip_ID );
+            dump->selected = (ERR_NONE == err);
+        }
+        if (dump->selected)
+        {
+            err = rfalSt25tbPollerReadBlock( (uint8_t)dump->nextBlock, (rfalSt25tbBlock*) &rxBuf[num * ISO14443B_ST25TB_BLOCKSIZE] );
+            dump->frames++;
+        }
+
+        if (ERR_NONE == err)
+        {
+            dump->attempts = 0;
+            dump->nextBlock++;
+            num++;
+            continue;
+        }
+
+        /* select again, the tag may have lost its state */
+        dump->selected = false;
+        dump->retries++;
+        if (++dump->attempts > ISO14443B_ST25TB_DUMP_RETRIES)
+        {
+            dump->tagsFailed++;
+            dump->nextBlock = (uint16_t)dump->lastBlock + 1;
+            break;
+        }
+    }
+    dump->bytes += num * ISO14443B_ST25TB_BLOCKSIZE;
+    *numBlocks = (uint8_t)num;
+
+    if (dump->nextBlock > dump->lastBlock)
+    { /* tag done, the next one is selected with the next chunk */
+        if (dump->complete && dump->selected)
+        {
+            rfalSt25tbPollerCompletion();
+        }
+        dump->attempts = 0;
+        dump->selected = false;
+        dump->nextBlock = dump->firstBlock;
+        dump->tag++;
+    }
+
+    return ((dump->tag < dump->numTags) ? ERR_BUSY : ERR_NONE);
+}
@@ -46,6 +46,9 @@
 #include "utils.h"
 
 #include "rfal_rf.h"
+#include "st25r3911.h"
+#include "st25r3911_com.h"
+#include "delay.h"
 
 /*
 ******************************************************************************
@@ -62,6 +65,29 @@
 
 #define ISO15693_BUFFER_SIZE (64 + 8) /*!< length of iso15693 general purpose buffer */
 
+#define ISO15693_T1_MAX_1FC       4384U /*!< t1max: latest start of a VICC response after the VCD EOF, in 1/fc */
+#define ISO15693_T_SOF_1FC        2048U /*!< tSOF: duration of the VICC SOF at high data rate, halved in fast mode */
+#define ISO15693_T3_AM_MARGIN_1FC  128U /*!< extra t3 with 10% ASK: the VICC sees the end of a shallow pulse one pulse width later */
+
+#define ISO15693_FIELD_RESET_MS          5U /*!< field off time which makes PICCs leave the quiet state */
+#define ISO15693_MULTI_INV_MAX_DEPTH    15U /*!< deepest mask partition in nibbles, leaves room for the slot number */
+#define ISO15693_MULTI_INV_MAX_ERRORS    8U /*!< broken inventory rounds tolerated by a multi round inventory */
+#define ISO15693_ADAPT_16_SLOTS_MIN      8U /*!< adaptive inventory: expected PICCs from which 16 slots pay off */
+#define ISO15693_ADAPT_SCHOUTE_C       239U /*!< Schoute: PICCs per collided slot, in 1/100 */
+
+#define ISO15693_DUMP_RETRIES            3U /*!< failed attempts per chunk before a dump gives up */
+#define ISO15693_INFO_FLAG_MEM_SIZE   0x04U /*!< system information contains the memory size */
+
+#define ISO15693_GPT_TIMEOUT_US       5000U /*!< longest wait for the GP timer counting t3, it needs < 1 ms */
+
+#define ISO15693_SIM_TX_FRAME_US       113U /*!< simulated air time of VCD SOF + EOF, 1 out of 4 */
+#define ISO15693_SIM_TX_BYTE_US        302U /*!< simulated air time of one VCD byte, 1 out of 4 */
+#define ISO15693_SIM_TX_EOF_US          38U /*!< simulated air time of a VCD EOF */
+#define ISO15693_SIM_RESPONSE_US      4246U /*!< simulated t1 + inventory response at high data rate */
+#define ISO15693_SIM_AFTER_RESPONSE_US 309U /*!< simulated t2 */
+#define ISO15693_SIM_SILENT_US         474U /*!< simulated t3 of a slot without response */
+#define ISO15693_SIM_NRT_US            382U /*!< simulated no response time after a request */
+
 /*
 ******************************************************************************
 * LOCAL VARIABLES
@@ -75,6 +101,27 @@ static uint8_t iso15693DirMarker[ISO15693_NUM_UID_BITS]; /*!< direction marker
                                 bit position. 1 means that left path is tried and
                                 2 means right path is tried */
 static uint8_t iso15693DefaultSendFlags; /*!< default flags used for iso15693SendRequest */
+static uint32_t iso15693InventoryFrames; /*!< inventory requests and slot EOFs sent so far */
+static struct
+{
+    uint8_t empty;    /*!< slots without response */
+    uint8_t single;   /*!< slots with one response */
+    uint8_t collided; /*!< slots with a collision */
+} iso15693SlotStats; /*!< outcome of the 16 slots of the last inventory */
+
+/*! Simulated PICC population answering inventories instead of the RF */
+static struct
+{
+    uint16_t numTags;                           /*!< number of simulated PICCs, 0: use the RF */
+    uint32_t seed;                              /*!< seed the UIDs are derived from */
+    uint8_t  quiet[ISO15693_SIM_MAX_TAGS / 8];  /*!< quiet state per PICC */
+    uint8_t  flags;                             /*!< flags of the last inventory request */
+    uint8_t  afi;                               /*!< AFI of the last inventory request */
+    uint8_t  maskLength;                        /*!< mask length of the last inventory request */
+    uint8_t  mask[ISO15693_UID_LENGTH];         /*!< mask of the last inventory request */
+    uint8_t  slot;                              /*!< current slot of the last inventory request */
+    uint32_t airTimeUs;                         /*!< modelled air time spent so far */
+} iso15693Sim;
 
 /*
 ******************************************************************************
@@ -90,6 +137,15 @@ static ReturnCode iso15693SendRequest(uint8_t cmd,
                 uint8_t* addSendData,
                 uint8_t addSendDataLength,
                 uint32_t no_response_time_64fcs);
+static uint16_t iso15693SlotWait8fc(void);
+static ReturnCode iso15693InventoryFrame(uint8_t *txBuf, uint8_t txBufLen, uint8_t *rxBuf, uint8_t rxBufLen, uint16_t *actLen);
+static ReturnCode iso15693InventoryEOF(uint8_t *rxBuf, uint8_t rxBufLen, uint16_t *actLen);
+static void iso15693SimUid(uint16_t idx, uint8_t *uid);
+static ReturnCode iso15693SimRespond(uint8_t *rxBuf, uint8_t rxBufLen, uint16_t *actLen);
+static bool iso15693MultiInventoryNextPartition(iso15693MultiInventory_t *inv);
+static iso15693NumSlots_t iso15693MultiInventoryAdapt(iso15693MultiInventory_t *inv, uint8_t maxCards);
+static void iso15693MultiInventoryEstimate(iso15693MultiInventory_t *inv, uint16_t foundBefore, uint8_t cardsFound, uint8_t maxCards);
+static ReturnCode iso15693DumpRequest(const iso15693Dump_t *dump, uint8_t numBlocks, uint8_t *rxBuf, uint16_t rxBufLen, uint16_t *actLen);
 /*
 ******************************************************************************
 * GLOBAL FUNCTIONS
@@ -126,6 +182,17 @@ ReturnCode iso15693Inventory(iso15693NumSlots_t slotcnt,
                     iso15693ProximityCard_t* cards,
                     uint8_t maxCards,
                     uint8_t* cardsFound)
+{
+    return iso15693InventoryAfi(slotcnt, NULL, maskLength, mask, cards, maxCards, cardsFound);
+}
+
+ReturnCode iso15693InventoryAfi(iso15693NumSlots_t slotcnt,
+                    const uint8_t* afi,
+                    uint8_t maskLength,
+                    uint8_t* mask,
+                    iso15693ProximityCard_t* cards,
+                    uint8_t maxCards,
+                    uint8_t* cardsFound)
 {
     ReturnCode err; /* error variable */
     uint16_t i; /* count variable */
@@ -141,6 +208,10 @@ ReturnCode iso15693Inventory(iso15693NumSlots_t slotcnt,
     uint64_t collisions; /* 64 bit long marker holding all unresolved collisions within 64bit UID */
     iso15693ProximityCard_t* crdptr = cards; /* pointer to the card currently used */
     uint8_t crdidx = 0; /* index of the card currently used */
+    uint16_t slotWait8fc; /* part of t3 not yet covered by the no response time */
+    bool slotSilent = false; /* no VICC answered in the previous slot */
+    uint8_t hdrLen = (afi != NULL) ? 3 : 2; /* flags, command and optional AFI preceding the mask */
+    uint8_t* maskField = &iso15693Buffer[hdrLen]; /* mask length followed by the mask */
 
     if (maxCards == 0)
     {
@@ -159,11 +230,16 @@ ReturnCode iso15693Inventory(iso15693NumSlots_t slotcnt,
         iso15693Buffer[0] |= ISO15693_REQ_FLAG_1_SLOT;
     }
     iso15693Buffer[1] = ISO15693_CMD_INVENTORY;
-    iso15693Buffer[2] = maskLength;
+    if (afi != NULL)
+    {
+        iso15693Buffer[0] |= ISO15693_REQ_FLAG_AFI;
+        iso15693Buffer[2] = *afi;
+    }
+    maskField[0] = maskLength;
 
     /* convert maskLength from number of bits to bytes */
     maskLengthBytes = (maskLength >> 3) + (((maskLength & 7) > 0) ? 1 : 0);
-    if ((maskLengthBytes + 3) > ISO15693_BUFFER_SIZE)
+    if ((maskLengthBytes + hdrLen + 1) > ISO15693_BUFFER_SIZE)
     {
         err = ERR_NOMEM;
         goto out;
@@ -175,7 +251,7 @@ ReturnCode iso15693Inventory(iso15693NumSlots_t slotcnt,
         bitmask = (1 << (maskLength & 7)) - 1;
         mask[maskLengthBytes-1] &= bitmask;
     }
-    ST_MEMCPY(&iso15693Buffer[3], mask, maskLengthBytes);
+    ST_MEMCPY(&maskField[1], mask, maskLengthBytes);
 
     slotNumPos = maskLength & 7;
     currColPos = 0;
@@ -183,6 +259,8 @@ ReturnCode iso15693Inventory(iso15693NumSlots_t slotcnt,
     colSlots = 0;
     currColSlot = -1;
     slot = (slotcnt == ISO15693_NUM_SLOTS_1) ? -1 : 15;
+    ST_MEMSET(&iso15693SlotStats, 0, sizeof(iso15693SlotStats));
+    slotWait8fc = iso15693Sim.numTags ? 0 : iso15693SlotWait8fc();
     do
     {
         /* this outer loop iterates as long as there are unresolved
@@ -197,17 +275,50 @@ ReturnCode iso15693Inventory(iso15693NumSlots_t slotcnt,
             if ((slotcnt == ISO15693_NUM_SLOTS_1) || (slot == 15))
             {
                 /* send the request. Note: CRC is appended by physical layer.
-                   Add 3 to mask for flag field, command field and mask length */
-                err = rfalISO15693TransceiveAnticollisionFrame(iso15693Buffer, (3 + maskLengthBytes),
+                   Add flag field, command field, AFI and mask length to mask */
+                err = iso15693InventoryFrame(iso15693Buffer, (hdrLen + 1 + maskLengthBytes),
                             (uint8_t*)crdptr, sizeof(iso15693ProximityCard_t), &actlength);
             }
             else
             {
-                HAL_Delay(5); /* this is a worst case delay for sending EOF. t3min depends on modulation depth and data rate */
+                /* After a response RFAL holds the EOF back for FDT poll (= t2min)
+                   counted by the GP timer from the end of reception. After a silent
+                   slot only the no response time has passed since our last EOF,
+                   let the GP timer count the remainder of t3min. */
+                if (slotSilent && slotWait8fc)
+                {
+                    uint32_t start = getUs();
+
+                    st25r3911StartGPTimer_8fcs(slotWait8fc, ST25R3911_REG_GPT_CONTROL_gptc_no_trigger);
+                    while (st25r3911IsGPTRunning())
+                    {
+                        if ((getUs() - start) > ISO15693_GPT_TIMEOUT_US)
+                        { /* the chip does not answer, do not hang in the inventory */
+                            err = ERR_SYSTEM;
+                            goto out;
+                        }
+                    }
+                }
                 /* in case if slot count 16 slot is incremented by just sending EOF */
-                err = rfalISO15693TransceiveAnticollisionEOF(
+                err = iso15693InventoryEOF(
                             (uint8_t*)crdptr, sizeof(iso15693ProximityCard_t), &actlength);
             }
+            slotSilent = (ERR_TIMEOUT == err);
+            if (ISO15693_NUM_SLOTS_16 == slotcnt)
+            {
+                if (ERR_TIMEOUT == err)
+                {
+                    iso15693SlotStats.empty++;
+                }
+                else if (ERR_RF_COLLISION == err)
+                {
+                    iso15693SlotStats.collided++;
+                }
+                else
+                {
+                    iso15693SlotStats.single++;
+                }
+            }
 
             bitsBeforeCol = actlength%8;
             actlength /= 8;
@@ -234,31 +345,31 @@ ReturnCode iso15693Inventory(iso15693NumSlots_t slotcnt,
                     /* in case slot count is 1 collision needs to be resolved */
                     /* find position of collision within received UID and
                        update mask and mask length appropriately */
-                    iso15693Buffer[2] = ((actlength - 2) << 3) + bitsBeforeCol + 1;
-                    if (iso15693Buffer[2] > ISO15693_NUM_UID_BITS)
+                    maskField[0] = ((actlength - 2) << 3) + bitsBeforeCol + 1;
+                    if (maskField[0] > ISO15693_NUM_UID_BITS)
                     { /* The collision is inside the CRC: This should not happen,
                          treat this as a timeout and continue */
                         err = ERR_TIMEOUT;
                         break;
                     }
-                    currColPos = iso15693Buffer[2] - 1;
+                    currColPos = maskField[0] - 1;
                     collisions |= ((uint64_t)1 << (uint64_t)currColPos);
                     maskLengthBytes = actlength - 1;
 
                     /* copy received UID to mask */
-                    ST_MEMCPY(&iso15693Buffer[3], crdptr->uid, maskLengthBytes);
+                    ST_MEMCPY(&maskField[1], crdptr->uid, maskLengthBytes);
                     bitmask = (1 << bitsBeforeCol) - 1;
 
                     /* clear bit where collision happened which means try
                        left branch of the tree first */
-                    iso15693Buffer[2+maskLengthBytes] &= bitmask;
+                    maskField[maskLengthBytes] &= bitmask;
 
                     if (1 == iso15693DirMarker[currColPos])
                     {
                         /* if left branch has been tried out before (dirMarker set to 1)
                            the set the bit where collision happened to 1, i.e.
                            try right branch */
-                        iso15693Buffer[2+maskLengthBytes] |= (1 << (currColPos & 7));
+                        maskField[maskLengthBytes] |= (1 << (currColPos & 7));
                     }
                     /* in any case increment dirMarker to indicate the way we chose */
                     iso15693DirMarker[currColPos]++;
@@ -313,9 +424,9 @@ ReturnCode iso15693Inventory(iso15693NumSlots_t slotcnt,
                                 also means that left branch was tried before.
                                 Switch to right branch now */
                                 currColPos = i;
-                                iso15693Buffer[2] = currColPos + 1;
+                                maskField[0] = currColPos + 1;
                                 maskLengthBytes = (currColPos >> 3) + 1;
-                                iso15693Buffer[2+maskLengthBytes] |= (1 << (currColPos & 7));
+                                maskField[maskLengthBytes] |= (1 << (currColPos & 7));
                                 iso15693DirMarker[currColPos]++;
                                 break;
                             }
@@ -365,19 +476,19 @@ ReturnCode iso15693Inventory(iso15693NumSlots_t slotcnt,
                         /* also if slot number would overlap add an additional byte */
                         maskLengthBytes++;
                         /* add slot number to mask */
-                        iso15693Buffer[2+maskLengthBytes] &= ~((1 << (8 - slotNumPos)) - 1);
-                        iso15693Buffer[2+maskLengthBytes] |= i >> (8 - slotNumPos);
-                        iso15693Buffer[1+maskLengthBytes] &= (1 << slotNumPos) - 1;
-                        iso15693Buffer[1+maskLengthBytes] |= (i << slotNumPos);
+                        maskField[maskLengthBytes] &= ~((1 << (8 - slotNumPos)) - 1);
+                        maskField[maskLengthBytes] |= i >> (8 - slotNumPos);
+                        maskField[maskLengthBytes-1] &= (1 << slotNumPos) - 1;
+                        maskField[maskLengthBytes-1] |= (i << slotNumPos);
                     }
                     else
                     {
                         /* add slot number to mask */
-                        iso15693Buffer[2+maskLengthBytes] &= (1 << slotNumPos) - 1;
-                        iso15693Buffer[2+maskLengthBytes] |= (i << slotNumPos);
+                        maskField[maskLengthBytes] &= (1 << slotNumPos) - 1;
+                        maskField[maskLengthBytes] |= (i << slotNumPos);
                     }
                     /* in any case number of mask bits needs to be incremented by 4 */
-                    iso15693Buffer[2] = maskLength + 4;
+                    maskField[0] = maskLength + 4;
                     currColSlot = i;
                     break;
                 }
@@ -393,7 +504,7 @@ out_max_cards:
 out:
     *cardsFound = crdidx;
 
-    if (*cardsFound == 0)
+    if ((*cardsFound == 0) && (err != ERR_SYSTEM))
     {
         err = ERR_NOTFOUND;
     }
@@ -406,6 +517,24 @@ ReturnCode iso15693SendStayQuiet(const iso15693ProximityCard_t* card)
     uint16_t actlength;
     uint8_t data;
 
+    if (iso15693Sim.numTags)
+    {
+        /* simulated PICCs carry their index in UID bytes 4 and 5 */
+        uint16_t idx = card->uid[4] | (card->uid[5] << 8);
+        uint8_t uid[ISO15693_UID_LENGTH];
+
+        iso15693Sim.airTimeUs += ISO15693_SIM_TX_FRAME_US + (ISO15693_UID_LENGTH + 4) * ISO15693_SIM_TX_BYTE_US + ISO15693_SIM_NRT_US;
+        if (idx < iso15693Sim.numTags)
+        {
+            iso15693SimUid(idx, uid);
+            if (!ST_BYTECMP(uid, card->uid, ISO15693_UID_LENGTH))
+            {
+                iso15693Sim.quiet[idx >> 3] |= (1 << (idx & 7));
+            }
+        }
+        return ERR_TIMEOUT;
+    }
+
 
     /* just send the command - no reply sent by the PICC */
     return iso15693SendRequest(ISO15693_CMD_STAY_QUIET,
@@ -691,11 +820,620 @@ out:
     return err;
 }
 
+ReturnCode iso15693MultiInventoryInit(iso15693MultiInventory_t *inv, uint8_t options, uint8_t afi)
+{
+    if (inv == NULL)
+    {
+        return ERR_PARAM;
+    }
+
+    ST_MEMSET(inv, 0, sizeof(iso15693MultiInventory_t));
+    inv->options = options;
+    inv->afi = afi;
+
+    if (options & ISO15693_MULTI_INV_OPT_STAY_QUIET)
+    {
+        /* PICCs quieted before would not take part: power cycle them */
+        if (iso15693Sim.numTags)
+        {
+            ST_MEMSET(iso15693Sim.quiet, 0, sizeof(iso15693Sim.quiet));
+        }
+        else
+        {
+            rfalFieldOff();
+            platformDelay(ISO15693_FIELD_RESET_MS);
+            rfalFieldOnAndStartGT();
+        }
+    }
+    return ERR_NONE;
+}
+
+ReturnCode iso15693MultiInventoryRound(iso15693MultiInventory_t *inv,
+                    iso15693ProximityCard_t* cards,
+                    uint8_t maxCards,
+                    uint8_t* cardsFound)
+{
+    ReturnCode err;
+    uint8_t mask[ISO15693_UID_LENGTH];
+    uint32_t frames = iso15693InventoryFrames;
+    uint16_t foundBefore = inv->found;
+    iso15693NumSlots_t slotcnt;
+    uint8_t i;
+
+    *cardsFound = 0;
+    if (inv->done)
+    {
+        return ERR_NONE;
+    }
+
+    if (inv->options & ISO15693_MULTI_INV_OPT_ADAPTIVE)
+    {
+        slotcnt = iso15693MultiInventoryAdapt(inv, maxCards);
+    }
+    else
+    {
+        slotcnt = (inv->options & ISO15693_MULTI_INV_OPT_16_SLOTS) ? ISO15693_NUM_SLOTS_16 : ISO15693_NUM_SLOTS_1;
+    }
+    inv->slots16 = (ISO15693_NUM_SLOTS_16 == slotcnt);
+
+    /* the inventory modifies the mask it is given */
+    ST_MEMCPY(mask, inv->mask, ISO15693_UID_LENGTH);
+    err = iso15693InventoryAfi(slotcnt,
+                    (inv->options & ISO15693_MULTI_INV_OPT_AFI) ? &inv->afi : NULL,
+                    inv->depth * 4,
+                    mask,
+                    cards,
+                    maxCards,
+                    cardsFound);
+    inv->rounds++;
+    inv->frames += iso15693InventoryFrames - frames;
+
+    if ((err != ERR_NONE) && (err != ERR_NOTFOUND) && (++inv->errors >= ISO15693_MULTI_INV_MAX_ERRORS))
+    {
+        /* the RF keeps failing, give up */
+        inv->done = true;
+    }
+
+    if (inv->options & ISO15693_MULTI_INV_OPT_ADAPTIVE)
+    {
+        iso15693MultiInventoryEstimate(inv, foundBefore, *cardsFound, maxCards);
+    }
+
+    if (inv->options & ISO15693_MULTI_INV_OPT_STAY_QUIET)
+    {
+        for (i = 0; i < *cardsFound; i++)
+        {
+            iso15693SendStayQuiet(&cards[i]);
+            inv->quiets++;
+        }
+        if (*cardsFound == maxCards)
+        {
+            /* PICCs left in this partition answer the next round again */
+        }
+        else if (inv->depth > 0)
+        {
+            /* after the last partition the whole population is asked again */
+            iso15693MultiInventoryNextPartition(inv);
+        }
+        else if (ERR_NOTFOUND == err)
+        {
+            /* nobody left */
+            inv->done = true;
+        }
+    }
+    else if ((*cardsFound == maxCards) && (inv->depth < ISO15693_MULTI_INV_MAX_DEPTH))
+    {
+        /* partition may hold more PICCs than fit: drop the result and split
+           it, its PICCs are found again in the sub-partitions */
+        *cardsFound = 0;
+        inv->depth++;
+    }
+    else if ((err == ERR_NONE) || (err == ERR_NOTFOUND))
+    {
+        inv->done = !iso15693MultiInventoryNextPartition(inv);
+    }
+    else
+    {
+        /* broken round: repeat the partition, drop what would be found twice */
+        *cardsFound = 0;
+    }
+
+    inv->found += *cardsFound;
+
+    return inv->done ? ERR_NONE : ERR_BUSY;
+}
+
+void iso15693SetSimulation(uint16_t numTags, uint32_t seed)
+{
+    ST_MEMSET(&iso15693Sim, 0, sizeof(iso15693Sim));
+    iso15693Sim.numTags = MIN(numTags, ISO15693_SIM_MAX_TAGS);
+    iso15693Sim.seed = seed;
+}
+
+uint32_t iso15693GetSimulationAirTime(void)
+{
+    return iso15693Sim.airTimeUs;
+}
+
+ReturnCode iso15693DumpInit(iso15693Dump_t *dump, const uint8_t *uid, bool allowFast)
+{
+    iso15693PiccSystemInformation_t sysInfo;
+    uint16_t sysInfoLen;
+    ReturnCode err;
+
+    if ((dump == NULL) || (uid == NULL))
+    {
+        return ERR_PARAM;
+    }
+
+    ST_MEMSET(dump, 0, sizeof(iso15693Dump_t));
+    ST_MEMCPY(dump->card.uid, uid, ISO15693_UID_LENGTH);
+
+    err = iso15693GetPiccSystemInformation(&dump->card, &sysInfo, &sysInfoLen);
+    EVAL_ERR_NE_GOTO(ERR_NONE, err, out);
+    if (!(sysInfo.infoFlags & ISO15693_INFO_FLAG_MEM_SIZE))
+    {
+        err = ERR_NOTSUPP;
+        goto out;
+    }
+
+    /* both are coded as value - 1 */
+    dump->numBlocks = sysInfo.memNumBlocks + 1;
+    dump->blockSize = (sysInfo.memBlockSize & 0x1F) + 1;
+    dump->fast = (allowFast && (uid[6] == ISO15693_M24LR_IC_MFG_CODE));
+    /* start big, chunks are halved on failure and doubled again on success */
+    dump->chunkBlocks = ISO15693_DUMP_MAX_CHUNK_BLOCKS;
+
+out:
+    return err;
+}
+
+ReturnCode iso15693DumpChunk(iso15693Dump_t *dump, uint8_t *rxBuf, uint16_t rxBufLen, uint16_t *startBlock, uint8_t *numBlocks)
+{
+    ReturnCode err;
+    uint16_t actlength;
+    uint16_t num;
+
+    *startBlock = dump->nextBlock;
+    *numBlocks = 0;
+
+    while (dump->nextBlock < dump->numBlocks)
+    {
+        /* flags byte and CRC are received with the data */
+        num = (rxBufLen > 3) ? ((rxBufLen - 3) / dump->blockSize) : 0;
+        num = MIN(num, dump->chunkBlocks);
+        num = MIN(num, dump->numBlocks - dump->nextBlock);
+        if (num == 0)
+        {
+            return ERR_NOMEM;
+        }
+
+        err = iso15693DumpRequest(dump, (uint8_t)num, rxBuf, rxBufLen, &actlength);
+        dump->frames++;
+        if ((ERR_NONE == err) && (actlength >= 1) && (rxBuf[0] & ISO15693_RESP_FLAG_ERROR))
+        {
+            /* e.g. chunk crosses a locked or non existing area */
+            err = ERR_NOTSUPP;
+        }
+        else if ((ERR_NONE == err) && (actlength != (1 + num * dump->blockSize)))
+        {
+            err = ERR_FRAMING;
+        }
+
+        if (ERR_NONE == err)
+        {
+            /* a single marginal frame must not slow down the rest of the dump */
+            dump->chunkBlocks = (uint8_t)MIN(2 * (uint16_t)dump->chunkBlocks, ISO15693_DUMP_MAX_CHUNK_BLOCKS);
+            dump->attempts = 0;
+            dump->nextBlock += num;
+            dump->bytes += num * dump->blockSize;
+            *numBlocks = (uint8_t)num;
+            return (dump->nextBlock < dump->numBlocks) ? ERR_BUSY : ERR_NONE;
+        }
+
+        /* retry smaller: long frames are more likely to be hit by noise and
+           some PICCs limit the blocks per read */
+        dump->retries++;
+        if (++dump->attempts > ISO15693_DUMP_RETRIES)
+        {
+            return err;
+        }
+        dump->chunkBlocks = MAX(num / 2, 1);
+    }
+    return ERR_NONE;
+}
+
 /*
 ******************************************************************************
 * LOCAL FUNCTIONS
 ******************************************************************************
 */
+/*!
+ *****************************************************************************
+ *  \brief  Wait needed before the EOF following a silent inventory slot
+ *
+ *  ISO15693-3 requires t3min = t1max + tSOF between two EOFs if no VICC
+ *  answered, plus some margin if the VCD uses 10% ASK. The no response time
+ *  after the previous EOF already covers most of it.
+ *
+ *  \return the remaining wait in 8/fc, 0 if none is needed
+ *
+ *****************************************************************************
+ */
+static uint16_t iso15693SlotWait8fc(void)
+{
+    rfalBitRate txBR;
+    rfalBitRate rxBR;
+    uint32_t t3;
+    uint32_t nrt;
+
+    rfalGetBitRate(&txBR, &rxBR);
+
+    t3 = ISO15693_T1_MAX_1FC + ((RFAL_BR_52p97 == rxBR) ? (ISO15693_T_SOF_1FC / 2) : ISO15693_T_SOF_1FC);
+    if (st25r3911CheckReg(ST25R3911_REG_AUX, ST25R3911_REG_AUX_tr_am, ST25R3911_REG_AUX_tr_am))
+    {
+        t3 += ISO15693_T3_AM_MARGIN_1FC;
+    }
+
+    nrt = rfalConv64fcTo1fc(ISO15693_NO_RESPONSE_TIME);
+    if (t3 <= nrt)
+    {
+        return 0;
+    }
+    return (uint16_t)rfalConv1fcTo8fc(t3 - nrt + 7);
+}
+
+static ReturnCode iso15693InventoryFrame(uint8_t *txBuf, uint8_t txBufLen, uint8_t *rxBuf, uint8_t rxBufLen, uint16_t *actLen)
+{
+    uint8_t pos = 2;
+    uint8_t maskBytes;
+
+    iso15693InventoryFrames++;
+    if (!iso15693Sim.numTags)
+    {
+        return rfalISO15693TransceiveAnticollisionFrame(txBuf, txBufLen, rxBuf, rxBufLen, actLen);
+    }
+
+    /* remember the request, the simulated PICCs answer its slots */
+    iso15693Sim.flags = txBuf[0];
+    if (iso15693Sim.flags & ISO15693_REQ_FLAG_AFI)
+    {
+        iso15693Sim.afi = txBuf[pos++];
+    }
+    iso15693Sim.maskLength = MIN(txBuf[pos], ISO15693_NUM_UID_BITS);
+    pos++;
+    maskBytes = MIN((uint8_t)(txBufLen - pos), ISO15693_UID_LENGTH);
+    ST_MEMSET(iso15693Sim.mask, 0, ISO15693_UID_LENGTH);
+    ST_MEMCPY(iso15693Sim.mask, &txBuf[pos], maskBytes);
+    iso15693Sim.slot = 0;
+
+    iso15693Sim.airTimeUs += ISO15693_SIM_TX_FRAME_US + (txBufLen + 2) * ISO15693_SIM_TX_BYTE_US;
+    return iso15693SimRespond(rxBuf, rxBufLen, actLen);
+}
+
+static ReturnCode iso15693InventoryEOF(uint8_t *rxBuf, uint8_t rxBufLen, uint16_t *actLen)
+{
+    iso15693InventoryFrames++;
+    if (!iso15693Sim.numTags)
+    {
+        return rfalISO15693TransceiveAnticollisionEOF(rxBuf, rxBufLen, actLen);
+    }
+
+    iso15693Sim.slot++;
+    iso15693Sim.airTimeUs += ISO15693_SIM_TX_EOF_US;
+    return iso15693SimRespond(rxBuf, rxBufLen, actLen);
+}
+
+/*!
+ *****************************************************************************
+ *  \brief  Derive the UID of simulated PICC \a idx
+ *
+ *  UIDs are random apart from the index kept in bytes 4 and 5, which makes
+ *  them unique and lets Stay Quiet find the PICC again.
+ *
+ *****************************************************************************
+ */
+static void iso15693SimUid(uint16_t idx, uint8_t *uid)
+{
+    uint32_t h = iso15693Sim.seed ^ (idx * 0x9E3779B9UL);
+
+    /* murmur3 finalizer */
+    h ^= h >> 16;
+    h *= 0x85EBCA6BUL;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35UL;
+    h ^= h >> 16;
+
+    uid[0] = (h >>  0) & 0xFF;
+    uid[1] = (h >>  8) & 0xFF;
+    uid[2] = (h >> 16) & 0xFF;
+    uid[3] = (h >> 24) & 0xFF;
+    uid[4] = (idx >> 0) & 0xFF;
+    uid[5] = (idx >> 8) & 0xFF;
+    uid[6] = ISO15693_M24LR_IC_MFG_CODE;
+    uid[7] = 0xE0;
+}
+
+/*!
+ *****************************************************************************
+ *  \brief  Answer the current slot of the last inventory by the simulated PICCs
+ *
+ *  Simulated PICC \a idx has AFI (idx % 4) << 4. A collision is reported
+ *  at the first UID bit where the answering PICCs differ, like the RF does.
+ *
+ *****************************************************************************
+ */
+static ReturnCode iso15693SimRespond(uint8_t *rxBuf, uint8_t rxBufLen, uint16_t *actLen)
+{
+    uint8_t uid[ISO15693_UID_LENGTH];
+    uint8_t first[ISO15693_UID_LENGTH];
+    uint16_t responders = 0;
+    uint8_t colBit = ISO15693_NUM_UID_BITS;
+    uint16_t idx;
+    uint8_t tagAfi;
+    uint8_t bit;
+
+    *actLen = 0;
+
+    for (idx = 0; idx < iso15693Sim.numTags; idx++)
+    {
+        if (iso15693Sim.quiet[idx >> 3] & (1 << (idx & 7)))
+        {
+            continue;
+        }
+        if (iso15693Sim.flags & ISO15693_REQ_FLAG_AFI)
+        {
+            tagAfi = (idx & 3) << 4;
+            if (((iso15693Sim.afi & 0xF0) && ((iso15693Sim.afi & 0xF0) != (tagAfi & 0xF0))) ||
+                ((iso15693Sim.afi & 0x0F) && ((iso15693Sim.afi & 0x0F) != (tagAfi & 0x0F))))
+            {
+                continue;
+            }
+        }
+
+        iso15693SimUid(idx, uid);
+
+        for (bit = 0; bit < iso15693Sim.maskLength; bit++)
+        {
+            if ((uid[bit >> 3] ^ iso15693Sim.mask[bit >> 3]) & (1 << (bit & 7)))
+            {
+                break;
+            }
+        }
+        if (bit < iso15693Sim.maskLength)
+        {
+            continue;
+        }
+
+        if (!(iso15693Sim.flags & ISO15693_REQ_FLAG_1_SLOT))
+        {
+            /* 16 slots: the 4 bits following the mask select the slot */
+            uint8_t nibble = 0;
+            for (bit = 0; bit < 4; bit++)
+            {
+                uint8_t pos = iso15693Sim.maskLength + bit;
+                if ((pos < ISO15693_NUM_UID_BITS) && (uid[pos >> 3] & (1 << (pos & 7))))
+                {
+                    nibble |= (1 << bit);
+                }
+            }
+            if (nibble != iso15693Sim.slot)
+            {
+                continue;
+            }
+        }
+
+        if (responders++ == 0)
+        {
+            ST_MEMCPY(first, uid, ISO15693_UID_LENGTH);
+            continue;
+        }
+        for (bit = 0; bit < colBit; bit++)
+        {
+            if ((uid[bit >> 3] ^ first[bit >> 3]) & (1 << (bit & 7)))
+            {
+                colBit = bit;
+                break;
+            }
+        }
+    }
+
+    if (responders == 0)
+    {
+        iso15693Sim.airTimeUs += ISO15693_SIM_SILENT_US;
+        return ERR_TIMEOUT;
+    }
+
+    iso15693Sim.airTimeUs += ISO15693_SIM_RESPONSE_US + ISO15693_SIM_AFTER_RESPONSE_US;
+
+    /* flags, dsfid, uid, crc */
+    ST_MEMSET(rxBuf, 0, rxBufLen);
+    ST_MEMCPY(&rxBuf[2], first, MIN(ISO15693_UID_LENGTH, rxBufLen - 2));
+
+    if (responders > 1)
+    {
+        *actLen = 16 + colBit;
+        return ERR_RF_COLLISION;
+    }
+    *actLen = rfalConvBytesToBits(MIN(rxBufLen, (2 + ISO15693_UID_LENGTH + 2)));
+    return ERR_NONE;
+}
+
+/*!
+ *****************************************************************************
+ *  \brief  Move mask partitioning to the next partition in depth first order
+ *
+ *  \return false if all partitions are done, depth is back to 0 then
+ *
+ *****************************************************************************
+ */
+static bool iso15693MultiInventoryNextPartition(iso15693MultiInventory_t *inv)
+{
+    uint8_t nib;
+    uint8_t shift;
+
+    while (inv->depth > 0)
+    {
+        nib = inv->depth - 1;
+        shift = (nib & 1) * 4;
+        if (((inv->mask[nib >> 1] >> shift) & 0x0F) != 0x0F)
+        {
+            inv->mask[nib >> 1] += (1 << shift);
+            return true;
+        }
+        /* all 16 sub-partitions done, continue with the parent's sibling */
+        inv->mask[nib >> 1] &= ~(0x0F << shift);
+        inv->depth--;
+    }
+    return false;
+}
+
+/*!
+ *****************************************************************************
+ *  \brief  Choose slot count and mask depth of the next adaptive round
+ *
+ *  The population estimate is scaled down to the current partition. A
+ *  partition expected to overflow the card buffer is split before asking
+ *  it, small ones are asked with 1 slot as 16 mostly silent slots would
+ *  cost more frames than the binary search they save.
+ *
+ *****************************************************************************
+ */
+static iso15693NumSlots_t iso15693MultiInventoryAdapt(iso15693MultiInventory_t *inv, uint8_t maxCards)
+{
+    uint16_t expected;
+
+    if (!inv->estimated)
+    {
+        /* first round probes the population */
+        inv->expected = 0;
+        return ISO15693_NUM_SLOTS_16;
+    }
+
+    if ((inv->options & ISO15693_MULTI_INV_OPT_STAY_QUIET) && (inv->depth == 0))
+    {
+        /* PICCs already read are quiet */
+        expected = (inv->estimate > inv->found) ? (inv->estimate - inv->found) : 0;
+    }
+    else
+    {
+        expected = inv->estimate >> (4 * inv->depth);
+    }
+
+    while ((expected >= maxCards) && (inv->depth < ISO15693_MULTI_INV_MAX_DEPTH))
+    {
+        /* sub-partition 0 of the new level: its mask nibble is clear */
+        inv->depth++;
+        expected >>= 4;
+    }
+
+    inv->expected = expected;
+
+    return (expected >= ISO15693_ADAPT_16_SLOTS_MIN) ? ISO15693_NUM_SLOTS_16 : ISO15693_NUM_SLOTS_1;
+}
+
+/*!
+ *****************************************************************************
+ *  \brief  Update the population estimate after an adaptive round
+ *
+ *  A round which read its whole partition gives the exact count of the
+ *  partition, the estimate follows it smoothly. A round which filled the
+ *  card buffer only gives a lower bound: then the outcome of its 16 slots
+ *  is used (Schoute: every single slot holds one PICC, every collided slot
+ *  2.39 PICCs on average, extrapolated if the round stopped early) and the
+ *  estimate is raised at once.
+ *
+ *****************************************************************************
+ */
+static void iso15693MultiInventoryEstimate(iso15693MultiInventory_t *inv, uint16_t foundBefore, uint8_t cardsFound, uint8_t maxCards)
+{
+    uint32_t sample;
+    uint8_t slots = iso15693SlotStats.empty + iso15693SlotStats.single + iso15693SlotStats.collided;
+    bool overflow = (cardsFound >= maxCards);
+
+    sample = cardsFound;
+    if (overflow)
+    {
+        if (inv->slots16 && slots)
+        {
+            sample = ((iso15693SlotStats.single * 100U + iso15693SlotStats.collided * ISO15693_ADAPT_SCHOUTE_C) * 16U) / (slots * 100U);
+        }
+        /* with all slots collided Schoute underestimates: at least double
+           what was expected, like the Q algorithm raises Q on collisions */
+        sample = MAX(sample, 2U * MAX(inv->expected, maxCards));
+    }
+
+    if ((inv->options & ISO15693_MULTI_INV_OPT_STAY_QUIET) && (inv->depth == 0))
+    {
+        /* this round saw the PICCs not read before */
+        sample += foundBefore;
+    }
+    else
+    {
+        sample <<= MIN(4 * inv->depth, 16);
+    }
+    sample = MIN(sample, 0xFFFF);
+
+    if (!inv->estimated || (overflow && (sample > inv->estimate)))
+    {
+        inv->estimate = sample;
+    }
+    else if (!overflow)
+    {
+        inv->estimate = (uint16_t)((3U * inv->estimate + sample) / 4U);
+    }
+    inv->estimated = true;
+}
+
+/*!
+ *****************************************************************************
+ *  \brief  Send the read request for the next chunk of a dump
+ *
+ *  Addressed (Fast) Read Multiple Blocks, received directly into \a rxBuf.
+ *  The ST Fast Read is answered at double data rate, the receiver is switched
+ *  to it for the response only.
+ *
+ *****************************************************************************
+ */
+static ReturnCode iso15693DumpRequest(const iso15693Dump_t *dump, uint8_t numBlocks, uint8_t *rxBuf, uint16_t rxBufLen, uint16_t *actLen)
+{
+    rfalBitRate txBR;
+    rfalBitRate rxBR;
+    uint8_t length = 0;
+    ReturnCode err;
+
+    iso15693Buffer[length++] = iso15693DefaultSendFlags | ISO15693_REQ_FLAG_ADDRESS;
+    if (dump->fast)
+    {
+        iso15693Buffer[length++] = ISO15693_CMD_FAST_READ_MULTI_BLOCK;
+        iso15693Buffer[length++] = ISO15693_M24LR_IC_MFG_CODE;
+    }
+    else
+    {
+        iso15693Buffer[length++] = ISO15693_CMD_READ_MULTIPLE_BLOCKS;
+    }
+    ST_MEMCPY(&iso15693Buffer[length], dump->card.uid, ISO15693_UID_LENGTH);
+    length += ISO15693_UID_LENGTH;
+    iso15693Buffer[length++] = (uint8_t)dump->nextBlock;
+    iso15693Buffer[length++] = numBlocks - 1;
+
+    if (dump->fast)
+    {
+        rfalGetBitRate(&txBR, &rxBR);
+        rfalSetBitRate(RFAL_BR_KEEP, RFAL_BR_52p97);
+    }
+
+    err = rfalTransceiveBlockingTxRx( iso15693Buffer, length, rxBuf, rxBufLen, actLen,
+                                     (RFAL_TXRX_FLAGS_CRC_TX_AUTO | RFAL_TXRX_FLAGS_CRC_RX_REMV | RFAL_TXRX_FLAGS_NFCIP1_OFF | RFAL_TXRX_FLAGS_AGC_ON | RFAL_TXRX_FLAGS_PAR_RX_REMV),
+                                      rfalConv64fcTo1fc( ISO15693_NO_RESPONSE_TIME * 4 ) );
+
+    if (dump->fast)
+    {
+        rfalSetBitRate(RFAL_BR_KEEP, rxBR);
+    }
+    return err;
+}
+
 static ReturnCode iso15693SendRequest(uint8_t cmd,
                 uint8_t flags,
                 const iso15693ProximityCard_t* card,
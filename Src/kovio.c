@@ -42,6 +42,7 @@
 #include "rfal_rf.h"
 #include "rfal_nfca.h"
 #include "rfal_crc.h"
+#include "delay.h"
 
 /*
 ******************************************************************************
@@ -55,11 +56,33 @@
 /* Kovio barcode transmits every 5 ms = 1067 * 64/fc. */
 #define KOVIO_FRAME_DELAY_TIME  1067
 
+/* [1.2ms tx - 3.6ms sleep - 1.2ms tx - ...] grid of a 128 bit tag */
+#define KOVIO_PERIOD_US         4800
+#define KOVIO_PERIOD_MIN_US     4000
+#define KOVIO_PERIOD_MAX_US     6000
+
+/* burst lengths received of a 128 and a 256 bit tag, the SOF bit is not counted */
+#define KOVIO_BURST_BITS_MIN    127
+#define KOVIO_BURST_BITS_MAX    255
+
+/* one bit takes 128/fc = 9.44us, the SOF bit is not part of the received length */
+#define KOVIO_BURST_US(bits)    ((((uint32_t)(bits) + 1) * 944) / 100)
+
+/* receiver opened this early, covers latency of the end of burst detection */
+#define KOVIO_GUARD_US          300
+
+/* period errors add up, beyond this the phase is not trusted anymore */
+#define KOVIO_SYNC_MAX_US       50000
+
+/* windows tried by one kovioCaptureRead() */
+#define KOVIO_CAPTURE_ATTEMPTS  3
+
 /*
 ******************************************************************************
 * LOCAL FUNCTION PROTOTYPES
 ******************************************************************************
 */
+static void kovioCaptureWait(const kovioCapture_t *cap, uint16_t bits);
 
 uint8_t reverse8(uint8_t x)
 {
@@ -109,58 +132,141 @@ ReturnCode kovioDeinitialize(uint8_t keep_on)
 }
 
 ReturnCode kovioRead(kovioProximityCard_t *card)
+{
+    kovioCapture_t cap;
+
+    /* a burst joined late gives the phase, the next one is received in sync */
+    kovioCaptureInit(&cap);
+    return kovioCaptureRead(&cap, card);
+}
+
+void kovioCaptureInit(kovioCapture_t *cap)
+{
+    ST_MEMSET(cap, 0, sizeof(kovioCapture_t));
+    cap->periodUs = KOVIO_PERIOD_US;
+}
+
+ReturnCode kovioCaptureRead(kovioCapture_t *cap, kovioProximityCard_t *card)
 {
     int i;
-    ReturnCode err;
+    ReturnCode err = ERR_TIMEOUT;
     uint16_t actrxlength = 0;
     uint16_t crc;
+    uint32_t fwt;
+    uint32_t endUs;
+    uint32_t delta;
+    bool seen = false;
 
     card->length = 0;
 
-    for (i = 0; i < 2; i++)
-    { /* Scan two times for ID, since we might start receiving in the middle of a transmission */
+    for (i = 0; i < KOVIO_CAPTURE_ATTEMPTS; i++)
+    {
+        if (cap->synced && ((getUs() - cap->lastEndUs) > KOVIO_SYNC_MAX_US))
+        {
+            cap->synced = false;
+        }
+
+        if (cap->synced && (cap->burstBits != 0))
+        { /* the burst starts within the guard time after the window opened */
+            kovioCaptureWait(cap, cap->burstBits);
+            fwt = rfalConvUsTo1fc(2 * KOVIO_GUARD_US);
+        }
+        else if (cap->synced)
+        { /* phase from a partial burst only: open for the longest burst and
+             keep open until the shortest one has started too */
+            kovioCaptureWait(cap, KOVIO_BURST_BITS_MAX);
+            fwt = rfalConvUsTo1fc((2 * KOVIO_GUARD_US) + KOVIO_BURST_US(KOVIO_BURST_BITS_MAX) - KOVIO_BURST_US(KOVIO_BURST_BITS_MIN));
+        }
+        else
+        { /* Kovio barcode tag can transmit at any time, listen for a whole period */
+            fwt = rfalConvMsTo1fc(5);
+        }
 
-        EXIT_ON_ERR(err, rfalTransceiveBlockingTx( NULL, 0, card->uid, KOVIO_UID_LENGTH, &actrxlength, (RFAL_TXRX_FLAGS_DEFAULT | RFAL_TXRX_FLAGS_CRC_RX_KEEP | RFAL_TXRX_FLAGS_PAR_RX_KEEP), rfalConvMsTo1fc(5) ));
+        err = rfalTransceiveBlockingTx( NULL, 0, card->uid, KOVIO_UID_LENGTH, &actrxlength, (RFAL_TXRX_FLAGS_DEFAULT | RFAL_TXRX_FLAGS_CRC_RX_KEEP | RFAL_TXRX_FLAGS_PAR_RX_KEEP), fwt );
+        if (ERR_NONE != err)
+        {
+            return err;
+        }
         err = rfalTransceiveBlockingRx();  /* Get rcvd length in bits */
+        endUs = getUs();
 
-        if ( (ERR_TIMEOUT != err) && ((127 == actrxlength) || (255 == actrxlength)) )
-        { /* Complete UID was received */
-            card->length = rfalConvBitsToBytes(actrxlength);
-            break;
+        if ((ERR_TIMEOUT == err) || (actrxlength == 0))
+        {
+            cap->misses++;
+            cap->synced = false;
+            continue;
         }
-        /* If we started to receive a little after the start of transmission,
-           we are now in the middle, with 2ms delay we should be in correct
-           position inside the [1.2ms tx - 3.6ms sleep - 1.2ms tx - ...] grid. */
-        platformDelay(1);
-        /* FIXME timerDelayInMs(2) led to ~3ms on KL25 */
-        /* FIXME tmerDelayinUs(2000) led to ~200us on KL25 (clocks probabyl not correctly initialized */
-    }
+        seen = true;
 
+        if ((KOVIO_BURST_BITS_MIN != actrxlength) && (KOVIO_BURST_BITS_MAX != actrxlength))
+        { /* we started to receive in the middle, still the end of the burst gives
+             the phase, but not its length */
+            cap->partial++;
+            cap->lastEndUs = endUs;
+            cap->synced = true;
+            continue;
+        }
 
-    /* map incomplete byte error as no error (parity bits are also received) */
-    if ( ERR_INCOMPLETE_BYTE == err )
-    {
-        err = ERR_NONE;
-    }
+        /* Complete UID was received, refine the period by bursts one period apart */
+        delta = endUs - cap->lastEndUs;
+        if (cap->synced && (delta >= KOVIO_PERIOD_MIN_US) && (delta <= KOVIO_PERIOD_MAX_US))
+        {
+            cap->periodUs = ((3 * cap->periodUs) + delta) / 4;
+        }
+        cap->lastEndUs = endUs;
+        cap->burstBits = actrxlength;
+        cap->synced = true;
 
-    /* map parity error or receive timeout to not found error */
-    if ((ERR_TIMEOUT == err) ||
-            (ERR_NOMSG == err))
-    {
-        return ERR_NOTFOUND;
+        card->length = rfalConvBitsToBytes(actrxlength);
+        kovioNormalizeUID(card);
+
+        crc = rfalCrcCalculateCcitt(0x6363, card->uid, card->length - 2);
+        if ((crc & 0xff) != card->uid[card->length - 1] || (crc>>8) != card->uid[card->length - 2])
+        { /* try the next burst, no need to cycle the field */
+            cap->crcErrors++;
+            err = ERR_CRC;
+            continue;
+        }
+
+        cap->reads++;
+        return ERR_NONE;
     }
 
-    if ( (actrxlength != 0) && (32 != card->length) && (16 != card->length) )
+    if (ERR_CRC == err)
     {
-        return ERR_FRAMING;
+        return err;
     }
 
-    kovioNormalizeUID(card);
-
-    crc = rfalCrcCalculateCcitt(0x6363, card->uid, card->length - 2);
+    /* bursts joined late only: a tag is there but could not be read */
+    return (seen ? ERR_FRAMING : ERR_NOTFOUND);
+}
 
-    if ((crc & 0xff) != card->uid[card->length - 1] || (crc>>8) != card->uid[card->length - 2])
-      err = ERR_CRC;
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+/*!
+ *****************************************************************************
+ *  \brief  Wait until the guard time before the next burst
+ *
+ *  \param[in] cap : synchronized capture state.
+ *  \param[in] bits : length of the burst expected.
+ *
+ *****************************************************************************
+ */
+static void kovioCaptureWait(const kovioCapture_t *cap, uint16_t bits)
+{
+    uint32_t elapsed = getUs() - cap->lastEndUs;
+    uint32_t start = cap->periodUs - KOVIO_BURST_US(bits) - KOVIO_GUARD_US;
+    uint32_t phase = elapsed % cap->periodUs;
 
-     return err;
+    if (phase < start)
+    {
+        delayUs(start - phase);
+    }
+    else if (phase > (start + KOVIO_GUARD_US))
+    { /* burst is already running, take the next one */
+        delayUs(cap->periodUs - phase + start);
+    }
 }
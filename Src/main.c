@@ -49,6 +49,7 @@
 
 #include "stream_dispatcher.h"
 #include "dispatcher.h"
+#include "rfal_coroutine.h"
 #include "rfal_analogConfig.h"
 #include "rfal_rf.h"
 #include "rfal_analogConfig.h"
@@ -193,6 +194,7 @@ int main(void)
       ProcessIO();
       dispatcherInterruptHandler();
       rfalWorker();
+      rfalCoroutineWorker();
 
   }
   /* USER CODE END 3 */
@@ -42,6 +42,9 @@
 #include "iso14443_common.h"
 #include "utils.h"
 #include "rfal_rf.h"
+#include "rfal_coroutine.h"
+#include "iso14443a.h"
+#include "rfal_nfca.h"
 
 /*
 ******************************************************************************
@@ -56,60 +59,113 @@
 */
 #define MIFARE_UL_CMD_READ 0x30
 #define MIFARE_UL_CMD_WRITE 0xA2
+#define MIFARE_UL_CMD_GET_VERSION 0x60
+#define MIFARE_UL_CMD_FAST_READ 0x3A
+
+#define MIFARE_UL_LEGACY_PAGES 16 /*!< pages of a PICC without GET_VERSION */
+#define MIFARE_UL_READ_PAGES 4 /*!< pages returned by READ */
+#define MIFARE_UL_DUMP_RETRIES 3 /*!< failed attempts per chunk before a dump gives up */
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+/*! Total pages by storage size byte of the GET_VERSION response */
+static const struct
+{
+    uint8_t storageSize;
+    uint8_t pages;
+} mifareUlPages[] =
+{
+    { 0x0B, 20 },   /* MF0UL11, NTAG210 */
+    { 0x0E, 41 },   /* MF0UL21, NTAG212 */
+    { 0x0F, 45 },   /* NTAG213 */
+    { 0x11, 135 },  /* NTAG215 */
+    { 0x13, 231 },  /* NTAG216 */
+};
+
+/*
+******************************************************************************
+* LOCAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+static ReturnCode mifareUlReselect(const uint8_t *uid);
 
 /*
 ******************************************************************************
 * GLOBAL FUNCTIONS
 ******************************************************************************
 */
-ReturnCode mifareUlReadNBytes(uint8_t startAddr, uint8_t* readbuf, uint8_t length, uint8_t* actLength)
+ReturnCode mifareUlReadNBytesCo(coroutine_t *co, void *arg)
 {
-    ReturnCode err;
-    uint8_t txbuf[2];
-    uint16_t actrxlength;
-    uint8_t rxbuf[16];
+    mifareUlReadContext_t *rd = (mifareUlReadContext_t*)arg;
+    ReturnCode err = ERR_NONE;
+
+    CO_BEGIN(co);
 
-    *actLength = 0;
+    *rd->actLength = 0;
 
-    if (startAddr > 0xf)
+    if (rd->startAddr > 0xf)
     {
-        return ERR_PARAM;
+        CO_RETURN(co, ERR_PARAM);
     }
 
-    txbuf[0] = MIFARE_UL_CMD_READ;
+    rd->txbuf[0] = MIFARE_UL_CMD_READ;
 
     do
     {
-        txbuf[1] = startAddr;
+        rd->txbuf[1] = rd->startAddr;
 
-        err = rfalTransceiveBlockingTxRx( (uint8_t*)txbuf, sizeof(txbuf), rxbuf, sizeof(rxbuf), &actrxlength, RFAL_TXRX_FLAGS_DEFAULT, rfalConvMsTo1fc(5) );
-        EXIT_ON_ERR(err, ERR_NONE);
+        CO_INIT(&rd->co);
+        CO_AWAIT(co, err, rfalCoTransceiveTxRx(&rd->co, rd->txbuf, sizeof(rd->txbuf), rd->rxbuf, sizeof(rd->rxbuf), &rd->actrxlength, RFAL_TXRX_FLAGS_DEFAULT, rfalConvMsTo1fc(5)));
+        CO_EXIT_ON_ERR(co, err);
 
-        if (actrxlength != sizeof(rxbuf))
+        if (rd->actrxlength != sizeof(rd->rxbuf))
         {
             /* only NAK received or less than 16 bytes */
-            return ERR_NOMSG;
+            CO_RETURN(co, ERR_NOMSG);
         }
-        if (actrxlength > length)
+        if (rd->actrxlength > rd->length)
         {
-            length = 0;
+            rd->length = 0;
         }
         else
         {
-            length -= actrxlength;
+            rd->length -= rd->actrxlength;
         }
         /* copy received bytes to output buffer */
-        ST_MEMCPY(readbuf, rxbuf, actrxlength);
-        readbuf += actrxlength;
-        *actLength += actrxlength;
+        ST_MEMCPY(rd->readbuf, rd->rxbuf, rd->actrxlength);
+        rd->readbuf += rd->actrxlength;
+        *rd->actLength += rd->actrxlength;
 
-        startAddr += 4;
+        rd->startAddr += 4;
         /* roll back in case we go behind 0xf */
-        if (startAddr > 0xf)
+        if (rd->startAddr > 0xf)
         {
-            startAddr -= 0x10;
+            rd->startAddr -= 0x10;
         }
-    } while (length > 0);
+    } while (rd->length > 0);
+
+    CO_END(co, err);
+}
+
+ReturnCode mifareUlReadNBytes(uint8_t startAddr, uint8_t* readbuf, uint8_t length, uint8_t* actLength)
+{
+    ReturnCode err;
+    coroutine_t co;
+    mifareUlReadContext_t rd;
+
+    rd.startAddr = startAddr;
+    rd.readbuf   = readbuf;
+    rd.length    = length;
+    rd.actLength = actLength;
+
+    CO_INIT(&co);
+    while (ERR_BUSY == (err = mifareUlReadNBytesCo(&co, &rd)))
+    {
+        rfalWorker();
+    }
 
     return err;
 }
@@ -152,3 +208,166 @@ ReturnCode mifareUlWritePage(uint8_t pageAddr, const uint8_t* writebuf)
     return err;
 }
 
+ReturnCode mifareUlDumpInit(mifareUlDump_t *dump, bool allowFast)
+{
+    ReturnCode err;
+    uint8_t txbuf[2];
+    uint8_t rxbuf[MIFARE_UL_READ_PAGES * MIFARE_UL_PAGE_SIZE + 2];
+    uint16_t actrxlength;
+    uint8_t i;
+
+    ST_MEMSET(dump, 0, sizeof(mifareUlDump_t));
+    dump->numPages = MIFARE_UL_LEGACY_PAGES;
+    dump->chunkPages = 0xFF;
+
+    /* UID0..2 BCC0 UID3..6: the PICC to select again after a NAK */
+    txbuf[0] = MIFARE_UL_CMD_READ;
+    txbuf[1] = 0;
+    err = rfalTransceiveBlockingTxRx( txbuf, 2, rxbuf, sizeof(rxbuf), &actrxlength, RFAL_TXRX_FLAGS_DEFAULT, rfalConvMsTo1fc(5) );
+    if ((ERR_NONE == err) && (actrxlength != (MIFARE_UL_READ_PAGES * MIFARE_UL_PAGE_SIZE)))
+    { /* NAK */
+        err = ERR_NOMSG;
+    }
+    if (ERR_NONE != err)
+    {
+        return ((ERR_TIMEOUT == err) ? ERR_NOTFOUND : err);
+    }
+    ST_MEMCPY(&dump->uid[0], &rxbuf[0], 3);
+    ST_MEMCPY(&dump->uid[3], &rxbuf[4], 4);
+
+    txbuf[0] = MIFARE_UL_CMD_GET_VERSION;
+    err = rfalTransceiveBlockingTxRx( txbuf, 1, rxbuf, sizeof(rxbuf), &actrxlength, RFAL_TXRX_FLAGS_DEFAULT, rfalConvMsTo1fc(5) );
+    if ((ERR_NONE != err) || (actrxlength != MIFARE_UL_VERSION_LEN))
+    { /* MIFARE UL or UL C: NAK or no answer, which halted the PICC */
+        return mifareUlReselect(dump->uid);
+    }
+
+    ST_MEMCPY(dump->version, rxbuf, MIFARE_UL_VERSION_LEN);
+    for (i = 0; i < (sizeof(mifareUlPages)/sizeof(mifareUlPages[0])); i++)
+    {
+        if (mifareUlPages[i].storageSize == dump->version[6])
+        {
+            dump->numPages = mifareUlPages[i].pages;
+            dump->fast = allowFast;
+            break;
+        }
+    }
+
+    return ERR_NONE;
+}
+
+ReturnCode mifareUlDumpChunk(mifareUlDump_t *dump, uint8_t *rxBuf, uint16_t rxBufLen, uint16_t *startPage, uint8_t *numPages)
+{
+    ReturnCode err;
+    uint8_t txbuf[3];
+    uint16_t actrxlength;
+    uint16_t num;
+    uint16_t ask;
+    uint16_t expect;
+
+    *startPage = dump->nextPage;
+    *numPages = 0;
+
+    while (dump->nextPage < dump->numPages)
+    {
+        num = dump->numPages - dump->nextPage;
+        if (dump->fast)
+        {
+            /* the CRC is received into the buffer too */
+            ask = (rxBufLen > 2) ? ((rxBufLen - 2) / MIFARE_UL_PAGE_SIZE) : 0;
+            ask = MIN(ask, dump->chunkPages);
+            num = MIN(num, ask);
+            if (num == 0)
+            {
+                return ERR_NOMEM;
+            }
+            txbuf[0] = MIFARE_UL_CMD_FAST_READ;
+            txbuf[1] = (uint8_t)dump->nextPage;
+            txbuf[2] = (uint8_t)(dump->nextPage + num - 1);
+            expect = num * MIFARE_UL_PAGE_SIZE;
+            err = rfalTransceiveBlockingTxRx( txbuf, 3, rxBuf, rxBufLen, &actrxlength, RFAL_TXRX_FLAGS_DEFAULT, rfalConvMsTo1fc(5) );
+        }
+        else
+        {
+            /* READ always returns 4 pages, rolling over at the end */
+            num = MIN(num, MIFARE_UL_READ_PAGES);
+            expect = MIFARE_UL_READ_PAGES * MIFARE_UL_PAGE_SIZE;
+            if (rxBufLen < (MIFARE_UL_READ_PAGES * MIFARE_UL_PAGE_SIZE + 2))
+            {
+                return ERR_NOMEM;
+            }
+            txbuf[0] = MIFARE_UL_CMD_READ;
+            txbuf[1] = (uint8_t)dump->nextPage;
+            err = rfalTransceiveBlockingTxRx( txbuf, 2, rxBuf, rxBufLen, &actrxlength, RFAL_TXRX_FLAGS_DEFAULT, rfalConvMsTo1fc(5) );
+        }
+        dump->frames++;
+
+        if ((ERR_NONE == err) && (actrxlength != expect))
+        { /* NAK */
+            err = ERR_NOMSG;
+        }
+
+        if (ERR_NONE == err)
+        {
+            /* a single marginal frame must not slow down the rest of the read */
+            dump->chunkPages = (uint8_t)MIN(2 * (uint16_t)dump->chunkPages, 0xFF);
+            dump->attempts = 0;
+            dump->nextPage += num;
+            dump->bytes += num * MIFARE_UL_PAGE_SIZE;
+            *numPages = (uint8_t)num;
+            return (dump->nextPage < dump->numPages) ? ERR_BUSY : ERR_NONE;
+        }
+
+        /* a NAK halts the PICC; long frames are more likely to be hit by noise */
+        dump->retries++;
+        if (++dump->attempts > MIFARE_UL_DUMP_RETRIES)
+        {
+            return err;
+        }
+        dump->chunkPages = MAX(num / 2, 1);
+        err = mifareUlReselect(dump->uid);
+        if (ERR_NONE != err)
+        {
+            return err;
+        }
+    }
+    return ERR_NONE;
+}
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+/*!
+ *****************************************************************************
+ *  \brief  Bring a halted PICC back to ACTIVE state
+ *
+ *  Needed after a NAK. Other PICCs in the field may wake up by the WUPA
+ *  too, but only the one with \a uid answers the SELECT of both cascade
+ *  levels.
+ *
+ *****************************************************************************
+ */
+static ReturnCode mifareUlReselect(const uint8_t *uid)
+{
+    rfalNfcaSensRes sensRes;
+    rfalNfcaSelRes selRes;
+    uint8_t nfcid1[MIFARE_UL_UID_LEN];
+    ReturnCode err;
+
+    /* a collision of the ATQAs is fine, the SELECT tells the PICCs apart */
+    err = rfalNfcaPollerCheckPresence(RFAL_14443A_SHORTFRAME_CMD_WUPA, &sensRes);
+    if (ERR_NONE == err)
+    {
+        ST_MEMCPY(nfcid1, uid, MIFARE_UL_UID_LEN);
+        err = rfalNfcaPollerSelect(nfcid1, MIFARE_UL_UID_LEN, &selRes);
+    }
+    if (ERR_TIMEOUT == err)
+    {
+        err = ERR_NOTFOUND;
+    }
+
+    return err;
+}
+
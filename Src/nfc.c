@@ -46,6 +46,7 @@
 #include "rfal_nfcDep.h"
 #include "rfal_nfca.h"
 #include "rfal_nfcf.h"
+#include "rf_pipe.h"
 
 
 /*
@@ -71,6 +72,10 @@
 /*! Timeout is for receive new data is ~2400 milliseconds */
 #define TIMEOUT_DATA_64fcs  rfalConvMsTo1fc(2400)
 
+/*! Longest INF of a DEP frame, the header is counted against the frame size.
+    DID and NAD are always reserved, whether used or not. */
+#define NFC_DEP_PIPE_INF_LEN(fsx)  ((fsx) - RFAL_NFCDEP_DEPREQ_HEADER_LEN)
+
 /*
 ******************************************************************************
 * LOCAL VARIABLES
@@ -110,6 +115,17 @@ uint8_t                   nfcLmState;
 uint8_t                   nfcid[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07};
 uint8_t                   sensfRes[] = {RFAL_NFCF_CMD_POLLING_RES, RFAL_NFCF_SENSF_NFCID2_BYTE1_NFCDEP, RFAL_NFCF_SENSF_NFCID2_BYTE2_NFCDEP, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
 
+/*! Data to be sent in DEP frames, taken from the front as each frame is started */
+static uint8_t nfcDepPipeTxBuf[NFC_DEP_PIPE_LEN];
+/*! INF of the received DEP frames, used as ring buffer */
+static uint8_t nfcDepPipeRxBuf[NFC_DEP_PIPE_LEN];
+
+/*! NFC-DEP pipe */
+static rfPipe_t nfcDepPipe = { .txBuf = nfcDepPipeTxBuf, .txSize = NFC_DEP_PIPE_LEN,
+                               .rxBuf = nfcDepPipeRxBuf, .rxSize = NFC_DEP_PIPE_LEN };
+/*! Error which ended the exchange of the NFC-DEP pipe */
+static ReturnCode nfcDepPipeErr;
+
 
 /*
 ******************************************************************************
@@ -117,6 +133,8 @@ uint8_t                   sensfRes[] = {RFAL_NFCF_CMD_POLLING_RES, RFAL_NFCF_SEN
 ******************************************************************************
 */
 bool nfcDeactivateCheck( void );
+static ReturnCode nfcDepPipeSend( void );
+static ReturnCode nfcDepPipeRun( void );
 
 /*
 ******************************************************************************
@@ -333,18 +351,10 @@ ReturnCode nfcRxNBytes(uint8_t *bitrate, uint8_t *buf, uint16_t bufsize, uint16_
 
 ReturnCode nfcDepTx( const uint8_t *buf, uint16_t bufSize )
 {
+    /* a new exchange, drop whatever is left of the previous one */
+    nfcDepPipeAbort();
 
-    /* Set Deactivate Callback */
-    rfalNfcDepSetDeactivatingCallback( (rfalNfcDepDeactCallback) nfcDeactivateCheck );
-
-    /* Copy data to send */
-    ST_MEMCPY( nfcDepTxBuf.inf, buf, MIN( bufSize, RFAL_NFCDEP_FRAME_SIZE_MAX_LEN ) );
-
-    rfalNfcDepTxRx.txBuf        = &nfcDepTxBuf;
-    rfalNfcDepTxRx.txBufLen     = bufSize;
-    rfalNfcDepTxRx.isTxChaining = false;
-
-    return rfalNfcDepStartTransceive( &rfalNfcDepTxRx );
+    return nfcDepPipeWrite( buf, bufSize, true );
 }
 
 
@@ -354,6 +364,13 @@ ReturnCode nfcDepRx( uint8_t *buf, uint16_t bufsize, uint16_t *actlen )
 
     *actlen = 0;
 
+    if( nfcDepPipe.active )
+    {
+        ret = nfcDepPipeRead( buf, bufsize, actlen );
+        /* part of a chained answer, the rest follows */
+        return (((ret == ERR_BUSY) && (*actlen > 0)) ? ERR_AGAIN : ret);
+    }
+
     ret = rfalNfcDepGetTransceiveStatus();
     switch( ret )
     {
@@ -370,6 +387,79 @@ ReturnCode nfcDepRx( uint8_t *buf, uint16_t bufsize, uint16_t *actlen )
     return ret;
 }
 
+
+ReturnCode nfcDepPipeWrite( const uint8_t *data, uint16_t len, bool last )
+{
+    ReturnCode err;
+
+    if( !nfcDepPipe.active )
+    {
+        nfcDepPipeErr = ERR_NONE;
+
+        /* Set Deactivate Callback */
+        rfalNfcDepSetDeactivatingCallback( (rfalNfcDepDeactCallback) nfcDeactivateCheck );
+    }
+
+    err = rfPipeStage( &nfcDepPipe, data, len, last );
+    if( (err != ERR_NONE) || nfcDepPipe.running )
+    {
+        return err;
+    }
+
+    err = nfcDepPipeSend();
+    if( err != ERR_NONE )
+    {
+        nfcDepPipe.active = false;
+    }
+    return err;
+}
+
+
+ReturnCode nfcDepPipeRead( uint8_t *buf, uint16_t bufLen, uint16_t *len )
+{
+    *len = 0;
+
+    if( !nfcDepPipe.active )
+    {
+        return ERR_WRONG_STATE;
+    }
+
+    nfcDepPipeWorker();
+    if( nfcDepPipeErr != ERR_NONE )
+    {
+        nfcDepPipe.active = false;
+        return nfcDepPipeErr;
+    }
+    return rfPipeRead( &nfcDepPipe, buf, bufLen, len );
+}
+
+
+void nfcDepPipeWorker( void )
+{
+    if( nfcDepPipe.active && !nfcDepPipe.rxDone && (nfcDepPipeErr == ERR_NONE) )
+    {
+        nfcDepPipeErr = nfcDepPipeRun();
+    }
+}
+
+
+uint16_t nfcDepPipeTxFree( void )
+{
+    return rfPipeTxFree( &nfcDepPipe );
+}
+
+
+bool nfcDepPipeIsActive( void )
+{
+    return nfcDepPipe.active;
+}
+
+
+void nfcDepPipeAbort( void )
+{
+    nfcDepPipe.active = false;
+}
+
 ReturnCode nfcDepInitiatorHandleActivation( uint8_t* nfcid3, uint8_t desiredBitRate, uint8_t gbLen, uint8_t* gb, uint8_t* currentBitRate, uint8_t* atrResLen, uint8_t *atrRes )
 {
     rfalNfcDepAtrParam   param;
@@ -391,6 +481,12 @@ ReturnCode nfcDepInitiatorHandleActivation( uint8_t* nfcid3, uint8_t desiredBitR
     param.commMode  = ((nfcIsActive) ? RFAL_NFCDEP_COMM_ACTIVE : RFAL_NFCDEP_COMM_PASSIVE);
     param.operParam = (RFAL_NFCDEP_OPER_FULL_MI_DIS | RFAL_NFCDEP_OPER_EMPTY_DEP_DIS | RFAL_NFCDEP_OPER_ATN_EN | RFAL_NFCDEP_OPER_RTOX_REQ_EN);
 
+    /* Highest bit rate every NFC-DEP target must accept */
+    if( desiredBitRate == NFC_DEP_BR_HIGHEST )
+    {
+        desiredBitRate = RFAL_BR_424;
+    }
+
     /* Perform Initiator Activation */
     ret = rfalNfcDepInitiatorHandleActivation( &param, (rfalBitRate) desiredBitRate, &nfcDepDev );
     if( ret == ERR_NONE )
@@ -612,4 +708,96 @@ bool nfcDeactivateCheck( void )
     return true;
 }
 
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+/*!
+ *****************************************************************************
+ *  \brief  Start the next DEP frame of the outgoing data if there is one
+ *****************************************************************************
+ */
+static ReturnCode nfcDepPipeSend( void )
+{
+    uint16_t   maxInf;
+    ReturnCode err;
+
+    maxInf = NFC_DEP_PIPE_INF_LEN( rfalNfcDepTxRx.FSx );
+
+    if( !rfPipeNextFrame( &nfcDepPipe, maxInf, &rfalNfcDepTxRx.txBufLen, &rfalNfcDepTxRx.isTxChaining ) )
+    { /* wait for more data */
+        return ERR_NONE;
+    }
+
+    /* the frame is sent from nfcDepTxBuf, so its data can be dropped right away */
+    ST_MEMCPY( nfcDepTxBuf.inf, nfcDepPipeTxBuf, rfalNfcDepTxRx.txBufLen );
+    rfPipeDrop( &nfcDepPipe, rfalNfcDepTxRx.txBufLen );
+
+    rfalNfcDepTxRx.txBuf = &nfcDepTxBuf;
+    rfalNfcDepTxRx.rxBuf = &nfcDepRxBuf;
+    rfalNfcDepTxRx.rxLen = &nfcRxBufferActLength;
+
+    err = rfalNfcDepStartTransceive( &rfalNfcDepTxRx );
+    if( err == ERR_NONE )
+    {
+        nfcDepPipe.running    = true;
+        nfcDepPipe.txChaining = rfalNfcDepTxRx.isTxChaining;
+    }
+    return err;
+}
+
+/*!
+ *****************************************************************************
+ *  \brief  Advance the exchange
+ *
+ *  The next DEP frame is taken only when the ring can hold it.
+ *
+ *  \return ERR_NONE : No error, exchange is ongoing or done.
+ *  \return others : NFC-DEP error, exchange is over.
+ *
+ *****************************************************************************
+ */
+static ReturnCode nfcDepPipeRun( void )
+{
+    ReturnCode err;
+
+    if( !nfcDepPipe.running )
+    {
+        return nfcDepPipeSend();
+    }
+
+    if( rfPipeRxFree( &nfcDepPipe ) < RFAL_NFCDEP_FRAME_SIZE_MAX_LEN )
+    {
+        return ERR_NONE;
+    }
+
+    err = rfalNfcDepGetTransceiveStatus();
+    switch( err )
+    {
+        case ERR_BUSY:
+            return ERR_NONE;
+
+        case ERR_AGAIN:
+            /* the ACK is sent already: the next frame arrives in
+               nfcDepRxBuf with the next rfalWorker() */
+            rfPipeQueue( &nfcDepPipe, nfcDepRxBuf.inf, nfcRxBufferActLength );
+            return ERR_NONE;
+
+        case ERR_NONE:
+            if( nfcDepPipe.txChaining )
+            { /* ACK of a chained frame */
+                nfcDepPipe.running = false;
+                return nfcDepPipeSend();
+            }
+            rfPipeQueue( &nfcDepPipe, nfcDepRxBuf.inf, nfcRxBufferActLength );
+            nfcDepPipe.running = false;
+            nfcDepPipe.rxDone  = true;
+            return ERR_NONE;
+
+        default:
+            return err;
+    }
+}
+
 
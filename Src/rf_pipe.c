@@ -0,0 +1,145 @@
+/******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2016 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+/*
+ *      PROJECT:   ST25R3911 firmware
+ *      $Revision: $
+ *      LANGUAGE:  ANSI C
+ */
+
+/*! \file
+ *
+ *  \brief Buffers of a chained exchange streamed between host and RF
+ *
+ */
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include "rf_pipe.h"
+#include "utils.h"
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+ReturnCode rfPipeStage(rfPipe_t *pipe, const uint8_t *data, uint16_t len, bool last)
+{
+    if ((len > pipe->txSize) || ((len > 0) && (data == NULL)))
+    {
+        return ERR_PARAM;
+    }
+
+    if (!pipe->active)
+    {
+        pipe->running    = false;
+        pipe->txChaining = false;
+        pipe->rxDone     = false;
+        pipe->txLen      = 0;
+        pipe->rxHead     = 0;
+        pipe->rxTail     = 0;
+        pipe->rxUsed     = 0;
+        pipe->active     = true;
+    }
+    else if (pipe->txLast)
+    { /* answer of the previous exchange not read yet */
+        return ERR_BUSY;
+    }
+
+    if (len > (pipe->txSize - pipe->txLen))
+    {
+        return ERR_BUSY;
+    }
+    ST_MEMCPY(&pipe->txBuf[pipe->txLen], data, len);
+    pipe->txLen += len;
+    pipe->txLast = last;
+    return ERR_NONE;
+}
+
+bool rfPipeNextFrame(const rfPipe_t *pipe, uint16_t maxInf, uint16_t *len, bool *chaining)
+{
+    if ((pipe->txLen > maxInf) || ((pipe->txLen == maxInf) && !pipe->txLast))
+    {
+        *chaining = true;
+        *len      = maxInf;
+        return true;
+    }
+    if (pipe->txLast)
+    {
+        *chaining = false;
+        *len      = pipe->txLen;
+        return true;
+    }
+    return false;
+}
+
+void rfPipeDrop(rfPipe_t *pipe, uint16_t len)
+{
+    len = MIN(len, pipe->txLen);
+    pipe->txLen -= len;
+    ST_MEMMOVE(pipe->txBuf, &pipe->txBuf[len], pipe->txLen);
+}
+
+void rfPipeQueue(rfPipe_t *pipe, const uint8_t *data, uint16_t len)
+{
+    uint16_t n;
+
+    len = MIN(len, rfPipeRxFree(pipe));
+    n   = MIN(len, pipe->rxSize - pipe->rxHead);
+    ST_MEMCPY(&pipe->rxBuf[pipe->rxHead], data, n);
+    ST_MEMCPY(pipe->rxBuf, &data[n], len - n);
+    pipe->rxHead  = ((pipe->rxHead + len) % pipe->rxSize);
+    pipe->rxUsed += len;
+}
+
+ReturnCode rfPipeRead(rfPipe_t *pipe, uint8_t *buf, uint16_t bufLen, uint16_t *len)
+{
+    uint16_t n;
+
+    *len = 0;
+    while ((*len < bufLen) && (pipe->rxUsed > 0))
+    {
+        n = MIN(bufLen - *len, pipe->rxUsed);
+        n = MIN(n, pipe->rxSize - pipe->rxTail);
+        ST_MEMCPY(&buf[*len], &pipe->rxBuf[pipe->rxTail], n);
+        pipe->rxTail  = ((pipe->rxTail + n) % pipe->rxSize);
+        pipe->rxUsed -= n;
+        *len += n;
+    }
+
+    if (pipe->rxDone && (pipe->rxUsed == 0))
+    {
+        pipe->active = false;
+        return ERR_NONE;
+    }
+    return ERR_BUSY;
+}
+
+uint16_t rfPipeRxFree(const rfPipe_t *pipe)
+{
+    return (pipe->rxSize - pipe->rxUsed);
+}
+
+uint16_t rfPipeTxFree(const rfPipe_t *pipe)
+{
+    return (pipe->active ? (pipe->txSize - pipe->txLen) : pipe->txSize);
+}
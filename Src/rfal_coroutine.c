@@ -0,0 +1,132 @@
+/******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2016 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+/*
+ *      PROJECT:   ST25R3911 firmware
+ *      $Revision: $
+ *      LANGUAGE:  ANSI C
+ */
+
+/*! \file
+ *
+ *  \brief Cooperative execution of RFAL based protocol operations
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include "platform.h"
+#include "rfal_coroutine.h"
+#include "rfal_rf.h"
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static rfalCoroutineFunc rfalCoFunc;              /*!< background operation, NULL if none running */
+static void             *rfalCoArg;               /*!< context of the background operation        */
+static coroutine_t       rfalCo;                  /*!< control block of the background operation  */
+static ReturnCode        rfalCoStatus = ERR_NONE; /*!< result of the last finished operation      */
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+ReturnCode rfalCoTransceiveTxRx( coroutine_t *co, uint8_t* txBuf, uint16_t txBufLen, uint8_t* rxBuf, uint16_t rxBufLen, uint16_t* actLen, uint32_t flags, uint32_t fwt )
+{
+    ReturnCode            ret = ERR_NONE;
+    rfalTransceiveContext ctx;
+
+    CO_BEGIN(co);
+
+    /* context is copied by rfalStartTransceive(), no need to keep it */
+    rfalCreateByteFlagsTxRxContext( ctx, txBuf, txBufLen, rxBuf, rxBufLen, actLen, flags, fwt );
+    ret = rfalStartTransceive( &ctx );
+    CO_EXIT_ON_ERR(co, ret);
+
+    CO_WAIT_WHILE(co, (ret = rfalGetTransceiveStatus()) == ERR_BUSY);
+
+    /* Convert received bits to bytes */
+    if( actLen != NULL )
+    {
+        *actLen = rfalConvBitsToBytes(*actLen);
+    }
+
+    CO_END(co, ret);
+}
+
+
+ReturnCode rfalCoroutineStart( rfalCoroutineFunc func, void *arg )
+{
+    if (func == NULL)
+    {
+        return ERR_PARAM;
+    }
+    if (rfalCoFunc != NULL)
+    {
+        return ERR_BUSY;
+    }
+
+    CO_INIT(&rfalCo);
+    rfalCoArg    = arg;
+    rfalCoFunc   = func;
+    rfalCoStatus = ERR_BUSY;
+
+    return ERR_NONE;
+}
+
+
+void rfalCoroutineWorker( void )
+{
+    ReturnCode ret;
+
+    if (rfalCoFunc == NULL)
+    {
+        return;
+    }
+
+    ret = rfalCoFunc(&rfalCo, rfalCoArg);
+    if (ret != ERR_BUSY)
+    {
+        rfalCoFunc   = NULL;
+        rfalCoStatus = ret;
+    }
+}
+
+
+ReturnCode rfalCoroutineGetStatus( void )
+{
+    return rfalCoStatus;
+}
+
+
+void rfalCoroutineAbort( void )
+{
+    if (rfalCoFunc != NULL)
+    {
+        rfalCoFunc   = NULL;
+        rfalCoStatus = ERR_INTERNAL;
+    }
+}
@@ -41,6 +41,7 @@
 #include "utils.h"
 #include "rfal_rf.h"
 #include "rfal_t1t.h"
+#include "rfal_coroutine.h"
 
 /*
 ******************************************************************************
@@ -59,12 +60,30 @@
 #define TOPAZ_WRITE_E_WAITING_TIME 1200
 /* DRD for WRITE_E is n=281 => 563*64/fc */
 #define TOPAZ_WRITE_NE_WAITING_TIME 600
+/* DRD for RALL is n=9 => 1236/fc, doubled as by RFAL */
+#define TOPAZ_READ_WAITING_TIME_1FC (1236*2)
+
+/* HR0: upper nibble 1 for NDEF capable, lower nibble 1 static, 2 dynamic memory */
+#define TOPAZ_HR0_TYPE_MASK 0x0F
+#define TOPAZ_HR0_TYPE_STATIC 0x01
+
+/* capability container in block 1: magic number, version, memory size, access */
+#define TOPAZ_CC_OFFSET 8
+#define TOPAZ_CC_MAGIC 0xE1
+#define TOPAZ_DYNAMIC_DEFAULT_SIZE 512
+
+/*! blocks which are not data: UID, reserved, static lock bits and OTP, reserved */
+#define TOPAZ_BLOCK_UID 0x00
+#define TOPAZ_BLOCK_RESERVED 0x0D
+#define TOPAZ_BLOCK_LOCK_OTP 0x0E
+#define TOPAZ_BLOCK_RESERVED_DYNAMIC 0x0F
 
 /*
 ******************************************************************************
 * LOCAL FUNCTION PROTOTYPES
 ******************************************************************************
 */
+static ReturnCode topazIdentify(topazProximityCard_t* card);
 
 
 /*
@@ -110,9 +129,42 @@ ReturnCode topazReadUID(topazProximityCard_t* card)
     return ret;
 }
 
+ReturnCode topazReadAllCo(coroutine_t *co, void *arg)
+{
+    topazReadAllContext_t *rd = (topazReadAllContext_t*)arg;
+    ReturnCode err = ERR_NONE;
+
+    CO_BEGIN(co);
+
+    /* RALL: command, address and data 0, UID */
+    ST_MEMSET(rd->txbuf, 0, sizeof(rd->txbuf));
+    rd->txbuf[0] = RFAL_T1T_CMD_RALL;
+    ST_MEMCPY(&rd->txbuf[3], rd->card->uid, TOPAZ_UID_LENGTH);
+
+    CO_INIT(&rd->co);
+    CO_AWAIT(co, err, rfalCoTransceiveTxRx(&rd->co, rd->txbuf, sizeof(rd->txbuf), rd->buf, rd->bufSize, rd->actSize, RFAL_TXRX_FLAGS_DEFAULT, TOPAZ_READ_WAITING_TIME_1FC));
+
+    CO_END(co, err);
+}
+
 ReturnCode topazReadAll(const topazProximityCard_t* card, uint8_t *buf, uint16_t buf_size, uint16_t* act_size)
 {
-    return rfalT1TPollerRall( (uint8_t*)card->uid, buf, buf_size, act_size );
+    ReturnCode err;
+    coroutine_t co;
+    topazReadAllContext_t rd;
+
+    rd.card    = card;
+    rd.buf     = buf;
+    rd.bufSize = buf_size;
+    rd.actSize = act_size;
+
+    CO_INIT(&co);
+    while (ERR_BUSY == (err = topazReadAllCo(&co, &rd)))
+    {
+        rfalWorker();
+    }
+
+    return err;
 }
 
 ReturnCode topazWriteByte(topazProximityCard_t* card, uint8_t addr, uint8_t data)
@@ -120,3 +172,209 @@ ReturnCode topazWriteByte(topazProximityCard_t* card, uint8_t addr, uint8_t data
     return rfalT1TPollerWrite( (uint8_t*)card->uid, addr, data );
 }
 
+ReturnCode topazReadSegment(const topazProximityCard_t* card, uint8_t segment, uint8_t *buf)
+{
+    return rfalT1TPollerRseg( (uint8_t*)card->uid, segment, buf );
+}
+
+ReturnCode topazReadBlock(const topazProximityCard_t* card, uint8_t block, uint8_t *buf)
+{
+    return rfalT1TPollerRead8( (uint8_t*)card->uid, block, buf );
+}
+
+ReturnCode topazWriteBlock(const topazProximityCard_t* card, uint8_t block, const uint8_t *data, bool erase)
+{
+    return rfalT1TPollerWrite8( (uint8_t*)card->uid, block, data, erase );
+}
+
+ReturnCode topazReadMemory(topazProximityCard_t* card, uint8_t *buf, uint16_t bufSize, uint16_t *actSize, uint8_t *frames)
+{
+    ReturnCode err;
+    uint16_t memSize;
+    uint16_t act;
+    uint8_t segment;
+
+    *actSize = 0;
+    *frames = 1;
+    err = topazIdentify(card);
+    if (ERR_NONE != err)
+    {
+        return err;
+    }
+
+    if ((card->hr[0] & TOPAZ_HR0_TYPE_MASK) == TOPAZ_HR0_TYPE_STATIC)
+    {
+        if (bufSize < (TOPAZ_HR_LENGTH + TOPAZ_STATIC_MEM_SIZE))
+        {
+            return ERR_NOMEM;
+        }
+        (*frames)++;
+        err = topazReadAll(card, buf, bufSize, &act);
+        if (ERR_NONE != err)
+        {
+            return err;
+        }
+        if (act != (TOPAZ_HR_LENGTH + TOPAZ_STATIC_MEM_SIZE))
+        {
+            return ERR_PROTO;
+        }
+        /* RALL repeats HR0 HR1 in front of the memory */
+        ST_MEMMOVE(buf, &buf[TOPAZ_HR_LENGTH], TOPAZ_STATIC_MEM_SIZE);
+        *actSize = TOPAZ_STATIC_MEM_SIZE;
+        return ERR_NONE;
+    }
+
+    /* segment 0 holds the capability container telling the size */
+    memSize = TOPAZ_SEGMENT_LENGTH;
+    for (segment = 0; (segment * TOPAZ_SEGMENT_LENGTH) < memSize; segment++)
+    {
+        if (bufSize < ((segment + 1) * TOPAZ_SEGMENT_LENGTH))
+        {
+            return ERR_NOMEM;
+        }
+        (*frames)++;
+        err = topazReadSegment(card, segment, &buf[segment * TOPAZ_SEGMENT_LENGTH]);
+        if (ERR_NONE != err)
+        {
+            return err;
+        }
+        *actSize += TOPAZ_SEGMENT_LENGTH;
+
+        if (segment == 0)
+        {
+            memSize = TOPAZ_DYNAMIC_DEFAULT_SIZE;
+            if (buf[TOPAZ_CC_OFFSET] == TOPAZ_CC_MAGIC)
+            { /* TMS: memory size is (TMS + 1) * 8 bytes */
+                memSize = (buf[TOPAZ_CC_OFFSET + 2] + 1) * TOPAZ_BLOCK_LENGTH;
+            }
+            memSize = MIN(memSize, TOPAZ_MAX_MEM_SIZE);
+        }
+    }
+
+    /* the last segment may reach beyond the memory */
+    *actSize = MIN(*actSize, memSize);
+
+    return ERR_NONE;
+}
+
+ReturnCode topazWriteMemory(topazProximityCard_t* card, uint8_t firstBlock, const uint8_t *data, uint16_t len, bool erase, bool lockOtp, uint8_t *frames)
+{
+    ReturnCode err;
+    uint16_t memSize;
+    uint16_t endBlock;
+    uint16_t block;
+    uint16_t i;
+    uint8_t cc[TOPAZ_BLOCK_LENGTH];
+    bool isStatic;
+
+    *frames = 0;
+    endBlock = firstBlock + (len / TOPAZ_BLOCK_LENGTH);
+    /* block numbers are 8 bit wide, they must not wrap */
+    if (((len % TOPAZ_BLOCK_LENGTH) != 0) || (endBlock > (TOPAZ_MAX_MEM_SIZE / TOPAZ_BLOCK_LENGTH)))
+    {
+        return ERR_PARAM;
+    }
+
+    *frames = 1;
+    err = topazIdentify(card);
+    if (ERR_NONE != err)
+    {
+        return err;
+    }
+    isStatic = ((card->hr[0] & TOPAZ_HR0_TYPE_MASK) == TOPAZ_HR0_TYPE_STATIC);
+
+    if (isStatic)
+    {
+        memSize = TOPAZ_STATIC_MEM_SIZE;
+    }
+    else
+    { /* the capability container in block 1 tells the size, as in topazReadMemory() */
+        (*frames)++;
+        err = topazReadBlock(card, (TOPAZ_CC_OFFSET / TOPAZ_BLOCK_LENGTH), cc);
+        if (ERR_NONE != err)
+        {
+            return err;
+        }
+        memSize = TOPAZ_DYNAMIC_DEFAULT_SIZE;
+        if (cc[0] == TOPAZ_CC_MAGIC)
+        {
+            memSize = (cc[2] + 1) * TOPAZ_BLOCK_LENGTH;
+        }
+        memSize = MIN(memSize, TOPAZ_MAX_MEM_SIZE);
+    }
+    if ((endBlock * TOPAZ_BLOCK_LENGTH) > memSize)
+    {
+        return ERR_PARAM;
+    }
+    for (block = firstBlock; (block < endBlock) && !lockOtp; block++)
+    { /* a write there cannot be undone or is refused by the tag */
+        if ((block == TOPAZ_BLOCK_UID) || (block == TOPAZ_BLOCK_RESERVED) || (block == TOPAZ_BLOCK_LOCK_OTP) ||
+            (!isStatic && (block == TOPAZ_BLOCK_RESERVED_DYNAMIC)))
+        {
+            return ERR_PARAM;
+        }
+    }
+
+    if (isStatic)
+    { /* no block writes, ADD is block(4) byte(3) */
+        if (!erase)
+        {
+            return ERR_NOTSUPP;
+        }
+        for (i = 0; i < len; i++)
+        {
+            (*frames)++;
+            err = topazWriteByte(card, (uint8_t)((firstBlock * TOPAZ_BLOCK_LENGTH) + i), data[i]);
+            if (ERR_NONE != err)
+            {
+                return err;
+            }
+        }
+        return ERR_NONE;
+    }
+
+    for (i = 0; i < len; i += TOPAZ_BLOCK_LENGTH)
+    {
+        (*frames)++;
+        err = topazWriteBlock(card, (uint8_t)(firstBlock + (i / TOPAZ_BLOCK_LENGTH)), &data[i], erase);
+        if (ERR_NONE != err)
+        {
+            return err;
+        }
+    }
+
+    return ERR_NONE;
+}
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+/*!
+ *****************************************************************************
+ *  \brief  Get the HR of the card with the UID in \a card
+ *
+ *  RID is answered by every card in READY state, so the UID returned is
+ *  checked against the one asked for.
+ *
+ *****************************************************************************
+ */
+static ReturnCode topazIdentify(topazProximityCard_t* card)
+{
+    topazProximityCard_t rid;
+    ReturnCode err;
+
+    err = topazReadUID(&rid);
+    if (ERR_NONE != err)
+    {
+        return err;
+    }
+    if (ST_BYTECMP(rid.uid, card->uid, TOPAZ_UID_LENGTH) != 0)
+    {
+        return ERR_NOTFOUND;
+    }
+    ST_MEMCPY(card->hr, rid.hr, TOPAZ_HR_LENGTH);
+
+    return ERR_NONE;
+}
@@ -113,7 +113,8 @@ void uartStreamDisconnect (void)
 
 uint8_t uartStreamReady (void)
 {
-  return initalized;
+  /* txBuffer is transmitted in place, it is busy until the DMA has finished */
+  return ( initalized && ( uartMaxTxBytes(CTRL_UART) > 0 ) );
 }
 
 void uartStreamPacketProcessed ( uint16_t rxed )
@@ -283,22 +284,21 @@ void uartStreamTransmit ( uint16_t packetSize )
 	{
 		ioLedOn( );
 
-		/* wait here (and before copying the IN-buffer) until the Uart is free again */
+		uint8_t * uartHeader = txBuffer - UART_HEADER_SIZE; /* ST_STREAM_TX_HEADROOM in front of txBuffer */
+
+		/* wait here (and before writing the header) until the Uart is free again */
 		while ( uartMaxTxBytes(CTRL_UART) == 0 )
 		  ;
 		/* generate a new tid for tx */
 		UART_GENERATE_TID_FOR_TX( rxTid, txTid );
 
 		/* TX-packet setup */
-		UART_TID( uartTxBuffer )          = txTid;
-		UART_STATUS( uartTxBuffer )       = StreamDispatcherGetLastError();
-		UART_SET_PAYLOAD_SIZE( uartTxBuffer, packetSize);
-
-		/* copy data to uart buffer */
-		memcpy( UART_PAYLOAD( uartTxBuffer ), txBuffer, packetSize );
+		UART_TID( uartHeader )          = txTid;
+		UART_STATUS( uartHeader )       = StreamDispatcherGetLastError();
+		UART_SET_PAYLOAD_SIZE( uartHeader, packetSize);
 
-		/* initiate transfer now */
-		uartTxNBytes(CTRL_UART, uartTxBuffer, UART_HEADER_SIZE+packetSize);
+		/* initiate transfer now, DMA reads the stream buffer directly */
+		uartTxNBytesInPlace(CTRL_UART, uartHeader, UART_HEADER_SIZE+packetSize);
 
 		ioLedOff( );
 	}
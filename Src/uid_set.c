@@ -0,0 +1,248 @@
+/******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2016 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+/*
+ *      PROJECT:   ST25R3911 firmware
+ *      $Revision: $
+ *      LANGUAGE:  ANSI C
+ */
+
+/*! \file
+ *
+ *  \brief Set of recently seen UIDs with time to live
+ *
+ */
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include "uid_set.h"
+#include "utils.h"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define UID_SET_MASK          (UID_SET_SIZE - 1U)
+#define UID_SET_FNV_OFFSET    2166136261UL
+#define UID_SET_FNV_PRIME     16777619UL
+#define UID_SET_FP_HASH_MASK  ((1UL << UID_SET_FP_TECH_SHIFT) - 1U)
+#define UID_SET_EMPTY         0UL          /*!< fingerprint of a free slot */
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static uint32_t uidSetFp[UID_SET_SIZE]; /*!< fingerprint per slot, UID_SET_EMPTY if free */
+static uint16_t uidSetSeenAt[UID_SET_SIZE]; /*!< tick the PICC of the slot was last seen */
+static uint16_t uidSetEntries; /*!< slots in use */
+static uint16_t uidSetTtl; /*!< time to live in ticks */
+static uint16_t uidSetSweep; /*!< next slot checked by uidSetExpire() */
+
+/*
+******************************************************************************
+* LOCAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+static bool uidSetValid(uint8_t tech, const uint8_t *uid, uint8_t uidLen);
+static void uidSetRemove(uint16_t slot);
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+ReturnCode uidSetInit(uint32_t ttlMs)
+{
+    if (ttlMs > UID_SET_MAX_TTL_MS)
+    {
+        return ERR_PARAM;
+    }
+
+    ST_MEMSET(uidSetFp, 0, sizeof(uidSetFp));
+    uidSetEntries = 0;
+    uidSetSweep = 0;
+    /* round up, a PICC must not depart before its TTL */
+    uidSetTtl = (uint16_t)((ttlMs + (1UL << UID_SET_TICK_SHIFT) - 1) >> UID_SET_TICK_SHIFT);
+
+    return ERR_NONE;
+}
+
+ReturnCode uidSetSeen(uint8_t tech, const uint8_t *uid, uint8_t uidLen, uint32_t nowMs, bool *arrived)
+{
+    uint16_t now = (uint16_t)(nowMs >> UID_SET_TICK_SHIFT);
+    uint32_t fp;
+    uint16_t slot;
+
+    if (!uidSetValid(tech, uid, uidLen))
+    {
+        return ERR_PARAM;
+    }
+
+    fp = uidSetFingerprint(tech, uid, uidLen);
+    /* the home slot is given by the low bits of the fingerprint */
+    for (slot = (uint16_t)(fp & UID_SET_MASK); uidSetFp[slot] != UID_SET_EMPTY; slot = ((slot + 1) & UID_SET_MASK))
+    {
+        if (uidSetFp[slot] == fp)
+        {
+            if (arrived != NULL)
+            { /* expired but not swept yet: it has been away */
+                *arrived = ((uint16_t)(now - uidSetSeenAt[slot]) > uidSetTtl);
+            }
+            uidSetSeenAt[slot] = now;
+            return ERR_NONE;
+        }
+    }
+
+    /* the load limit keeps the probe sequences short */
+    if (uidSetEntries >= UID_SET_MAX_ENTRIES)
+    {
+        return ERR_NOMEM;
+    }
+    uidSetFp[slot] = fp;
+    uidSetSeenAt[slot] = now;
+    uidSetEntries++;
+    if (arrived != NULL)
+    {
+        *arrived = true;
+    }
+
+    return ERR_NONE;
+}
+
+uint16_t uidSetExpire(uint32_t nowMs, uint16_t maxSlots, uint32_t *departed, uint16_t maxDeparted)
+{
+    uint16_t now = (uint16_t)(nowMs >> UID_SET_TICK_SHIFT);
+    uint16_t cnt = 0;
+
+    while ((maxSlots > 0) && (cnt < maxDeparted))
+    {
+        if ((uidSetFp[uidSetSweep] != UID_SET_EMPTY) &&
+            ((uint16_t)(now - uidSetSeenAt[uidSetSweep]) > uidSetTtl))
+        {
+            departed[cnt++] = uidSetFp[uidSetSweep];
+            /* an entry of the same cluster may move here, check the slot again */
+            uidSetRemove(uidSetSweep);
+            continue;
+        }
+        uidSetSweep = ((uidSetSweep + 1) & UID_SET_MASK);
+        maxSlots--;
+    }
+
+    return cnt;
+}
+
+uint16_t uidSetCount(void)
+{
+    return uidSetEntries;
+}
+
+uint32_t uidSetFingerprint(uint8_t tech, const uint8_t *uid, uint8_t uidLen)
+{
+    uint32_t key = UID_SET_FNV_OFFSET;
+    uint8_t i;
+
+    key = (key ^ tech) * UID_SET_FNV_PRIME;
+    for (i = 0; i < uidLen; i++)
+    {
+        key = (key ^ uid[i]) * UID_SET_FNV_PRIME;
+    }
+
+    /* FNV-1a mixes its low bits poorly for short inputs, they choose the slot */
+    key ^= key >> 16;
+    key *= 0x85EBCA6BUL;
+    key ^= key >> 13;
+    key *= 0xC2B2AE35UL;
+    key ^= key >> 16;
+
+    return (((uint32_t)tech << UID_SET_FP_TECH_SHIFT) | (key & UID_SET_FP_HASH_MASK));
+}
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+/*!
+ *****************************************************************************
+ *  \brief  Check that the UID length matches the technology
+ *
+ *****************************************************************************
+ */
+static bool uidSetValid(uint8_t tech, const uint8_t *uid, uint8_t uidLen)
+{
+    if (uid == NULL)
+    {
+        return false;
+    }
+
+    switch (tech)
+    {
+        case UID_SET_TECH_ISO15693:
+        case UID_SET_TECH_FELICA:
+        case UID_SET_TECH_ST25TB:
+            return (uidLen == 8);
+        case UID_SET_TECH_NFCA:
+            return ((uidLen == 4) || (uidLen == 7) || (uidLen == 10));
+        case UID_SET_TECH_NFCB:
+            return (uidLen == 4);
+        default:
+            return false;
+    }
+}
+
+/*!
+ *****************************************************************************
+ *  \brief  Free a slot
+ *
+ *  Backward shift deletion: the following entries of the cluster which
+ *  would not be found anymore across the hole are moved into it, so no
+ *  tombstones are needed and lookups stay short.
+ *
+ *****************************************************************************
+ */
+static void uidSetRemove(uint16_t slot)
+{
+    uint16_t hole = slot;
+    uint16_t next = slot;
+    uint16_t home;
+
+    for (;;)
+    {
+        next = ((next + 1) & UID_SET_MASK);
+        if (uidSetFp[next] == UID_SET_EMPTY)
+        {
+            break;
+        }
+        home = (uint16_t)(uidSetFp[next] & UID_SET_MASK);
+        /* move unless home lies cyclically in (hole, next] */
+        if (((next - home) & UID_SET_MASK) >= ((next - hole) & UID_SET_MASK))
+        {
+            uidSetFp[hole] = uidSetFp[next];
+            uidSetSeenAt[hole] = uidSetSeenAt[next];
+            hole = next;
+        }
+    }
+    uidSetFp[hole] = UID_SET_EMPTY;
+    uidSetEntries--;
+}
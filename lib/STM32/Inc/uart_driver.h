@@ -262,6 +262,23 @@ uint32_t uartMaxTxBytes( uint8_t id );
  */
 uint32_t uartTxNBytes( uint8_t id, const uint8_t * buffer, uint32_t size );
 
+/*!
+ *****************************************************************************
+ *  \brief Send N bytes without copying
+ *
+ *  Starts transmitting size bytes by DMA directly from the given buffer.
+ *  The buffer must not be modified until #uartMaxTxBytes() reports the UART
+ *  to be free again. Not limited by UART_DMA_BUFFER_SIZE.
+ *
+ *  \param id : Identifier of the UART
+ *  \param buffer : buffer holding the data
+ *  \param size : size of the buffer, at most 0xFFFF
+ *
+ *  \return >= 0 : number of bytes that are transmitted
+ *****************************************************************************
+ */
+uint32_t uartTxNBytesInPlace( uint8_t id, const uint8_t * buffer, uint32_t size );
+
 /*!
  *****************************************************************************
  *  \brief Get number of bytes that can be fetched from buffer
@@ -273,6 +273,34 @@ uint32_t uartTxNBytes( uint8_t id, const uint8_t * buffer, uint32_t size )
     return 0;
 }
 
+/*******************************************************************************/
+uint32_t uartTxNBytesInPlace( uint8_t id, const uint8_t * buffer, uint32_t size )
+{
+    HAL_StatusTypeDef ret;
+
+    if( (id >= UART_MAX_NUMBER_OF_UARTS) || (buffer == 0) || (size == 0) || (size > 0xFFFF) )
+    {
+        return 0;
+    }
+
+    if( uartInfo[id].hUART == NULL )
+    {
+        return 0;
+    }
+
+    if( uartMaxTxBytes(id) > 0 )
+    {
+        /* Trigger a DMA transmission directly from the callers buffer */
+        ret = HAL_UART_Transmit_DMA( uartInfo[id].hUART, (uint8_t*)buffer, size );
+        if( ret == HAL_OK )
+        {
+            return size;
+        }
+    }
+
+    return 0;
+}
+
 /*******************************************************************************/
 uint32_t uartRxBytesReadyForReceive( uint8_t id )
 {
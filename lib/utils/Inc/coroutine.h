@@ -0,0 +1,108 @@
+/******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2016 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+
+/*
+ *      PROJECT:   NFCC firmware
+ *      $Revision: $
+ *      LANGUAGE:  ISO C99
+ */
+
+/*! \file
+ *
+ *  \brief Stackless coroutines (protothread style)
+ *
+ *  A coroutine is an ordinary function taking a #coroutine_t and returning a
+ *  ReturnCode. While it has not finished it returns ERR_BUSY, once finished
+ *  it returns its final result and is reset so that the next call starts it
+ *  over again.
+ *
+ *  The resume point is kept in the #coroutine_t, local variables are NOT
+ *  preserved across CO_YIELD()/CO_WAIT_WHILE()/CO_AWAIT(). Everything which
+ *  must survive a yield has to be kept in a context structure owned by the
+ *  caller. A switch statement must not be used inside CO_BEGIN()/CO_END().
+ *
+ */
+
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdint.h>
+#include "st_errno.h"
+
+/*
+******************************************************************************
+* GLOBAL DATATYPES
+******************************************************************************
+*/
+
+/*! Coroutine control block: holds the resume point (0 = not started) */
+typedef struct
+{
+    uint16_t lc;    /*!< Local continuation, line number to resume at */
+} coroutine_t;
+
+/*
+******************************************************************************
+* GLOBAL MACROS
+******************************************************************************
+*/
+
+#define CO_INIT(co)              do { (co)->lc = 0; } while (0)                  /*!< (Re)start coroutine \a co from the beginning on its next call */
+#define CO_IS_RUNNING(co)        ((co)->lc != 0)                                 /*!< True if \a co has been started and not yet finished           */
+
+/*! Opens the body of a coroutine, must be the first statement of the function */
+#define CO_BEGIN(co)             switch ((co)->lc) { case 0:
+
+/*! Closes the body of a coroutine, finishing it with result \a ret */
+#define CO_END(co, ret)          } (co)->lc = 0; return (ret)
+
+/*! Leaves the coroutine with ERR_BUSY and resumes right after it on the next call */
+#define CO_YIELD(co)                                                           \
+    do { (co)->lc = __LINE__; return ERR_BUSY; case __LINE__:; } while (0)
+
+/*! Leaves the coroutine with ERR_BUSY as long as \a cond evaluates to true */
+#define CO_WAIT_WHILE(co, cond)                                                \
+    do { (co)->lc = __LINE__; case __LINE__: if (cond) return ERR_BUSY; } while (0)
+
+/*!
+ * Runs the child coroutine \a call (an expression returning ReturnCode)
+ * until it returns something else than ERR_BUSY; its result is stored
+ * in \a ret.
+ */
+#define CO_AWAIT(co, ret, call)                                                \
+    do { (co)->lc = __LINE__; case __LINE__: (ret) = (call); if ((ret) == ERR_BUSY) return ERR_BUSY; } while (0)
+
+/*! Finishes the coroutine with result \a ret */
+#define CO_RETURN(co, ret)       do { (co)->lc = 0; return (ret); } while (0)
+
+/*!
+ * Finishes the coroutine with result \a ret if it is not ERR_NONE,
+ * counterpart of EXIT_ON_ERR for coroutines.
+ */
+#define CO_EXIT_ON_ERR(co, ret)  do { if ((ret) != ERR_NONE) CO_RETURN(co, ret); } while (0)
+
+#endif /* COROUTINE_H */
@@ -311,6 +311,10 @@
 /* the size of a buffer to hold at least one packet + header */
 #define ST_STREAM_BUFFER_SIZE                  ( ST_STREAM_HEADER_SIZE + ST_STREAM_MAX_DATA_SIZE )
 
+/* space reserved in front of the tx buffer, the stream driver puts its own
+   header there so the buffer can be transmitted in place without copying */
+#define ST_STREAM_TX_HEADROOM                  UART_HEADER_SIZE
+
 
 
 /* the size of the serialized i2c config object in byte */
@@ -47,7 +47,8 @@
 
 /* ------------- local variables -------------------------------------------- */
 static uint8_t rxBuffer[ ST_STREAM_BUFFER_SIZE ]; /*! buffer to store protocol packets received from the Host */
-static uint8_t txBuffer[ ST_STREAM_BUFFER_SIZE ]; /*! buffer to store protocol packets which are transmitted to the Host */
+static uint8_t txFrame[ ST_STREAM_TX_HEADROOM + ST_STREAM_BUFFER_SIZE ]; /*! tx buffer including room for the stream driver header */
+static uint8_t * const txBuffer = &txFrame[ ST_STREAM_TX_HEADROOM ];    /*! buffer to store protocol packets which are transmitted to the Host */
 
 static uint8_t lastError; /* flag indicating different types of errors that cannot be reported in the protocol status field */
 
@@ -222,7 +223,11 @@ void ProcessIO(void)
       /* transmit any data waiting in the module-local buffer */
       StreamTransmit( txSize );
     }
+  }
 
+  /* the txBuffer is transmitted in place: do not touch it before
+     the stream driver is ready again */
+  if ( StreamReady() ) {
     /* we need to call the processCyclic function for all applications that
        have any data to send (without receiving a hid packet). The data to
        be sent is written into the module-local buffer */
@@ -0,0 +1,21 @@
+/*! \file platform.h
+ *
+ *  \brief Host stand-in for the platform layer
+ *
+ *  Lets the hardware independent modules build on the host for the tests
+ *  in this directory. Only what those modules use is defined here.
+ *
+ */
+
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "st_errno.h"
+
+#define RFAL_FEATURE_NFCV   true
+
+#endif /* PLATFORM_H */
@@ -0,0 +1,456 @@
+/*! \file iso15693_2_host.c
+ *
+ *  \brief Host test of the ISO15693 phy coder and decoder against the baseline
+ *
+ *  The table driven VCD coder and VICC decoder in rfal_iso15693_2.c have to
+ *  behave exactly as the baseline ones in ref/rfal_iso15693_2_baseline.c,
+ *  whose global functions are renamed with the ref prefix by the Makefile.
+ *
+ *  The coder is checked in both codings for every byte value and for random
+ *  frames with every CRC/flags/PicoPass variant, coded through the ERR_AGAIN
+ *  protocol with random FIFO chunk sizes.
+ *
+ *  The decoder is checked with Manchester streams of valid frames, frames
+ *  with a wrong CRC, a collision at every bit position with and without
+ *  ignoreBits covering it, truncated streams, broken SOF, missing EOF,
+ *  short output buffers and random streams. Return code, output,
+ *  outBufPos and bitsBeforeCol have to match.
+ *
+ *  Afterwards both implementations are timed.
+ *
+ *  Exits with 1 on the first mismatch.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "rfal_iso15693_2.h"
+#include "rfal_crc.h"
+#include "utils.h"
+
+extern ReturnCode refIso15693PhyConfigure(const iso15693PhyConfig_t* config, const struct iso15693StreamConfig ** needed_stream_config);
+extern ReturnCode refIso15693VCDCode(uint8_t* buffer, uint16_t length, bool sendCrc, bool sendFlags, bool picopassMode,
+                   uint16_t *subbit_total_length, uint16_t *offset,
+                   uint8_t* outbuf, uint16_t outBufSize, uint16_t* actOutBufSize);
+extern ReturnCode refIso15693VICCDecode(uint8_t *inBuf, uint16_t inBufLen, uint8_t* outBuf, uint16_t outBufLen,
+                      uint16_t* outBufPos, uint16_t* bitsBeforeCol, uint16_t ignoreBits, bool picopassMode);
+
+#define CODE_MAX_FRAME      256
+#define CODE_MAX_STREAM     (1 + (CODE_MAX_FRAME + 2) * 64 + 1)
+#define CODE_RANDOM_FRAMES  20000
+#define CODE_BENCH_ROUNDS   2000
+
+#define DEC_MAX_FRAME       300
+#define DEC_MAX_STREAM      (1 + (DEC_MAX_FRAME * 16 + 5 + 8 + 64) / 8)
+#define DEC_SLACK           4       /* the decoders may look one byte behind the stream */
+#define DEC_RANDOM_FRAMES   50000
+#define DEC_BENCH_ROUNDS    20000
+
+typedef ReturnCode (*vcdCode_t)(uint8_t*, uint16_t, bool, bool, bool, uint16_t*, uint16_t*, uint8_t*, uint16_t, uint16_t*);
+typedef ReturnCode (*viccDecode_t)(uint8_t*, uint16_t, uint8_t*, uint16_t, uint16_t*, uint16_t*, uint16_t, bool);
+
+/* Manchester stream as received from the ST25R3911, written LSB first */
+typedef struct
+{
+    uint8_t  buf[DEC_MAX_STREAM + DEC_SLACK];
+    uint16_t bits;
+} stream_t;
+
+static unsigned long failures;
+
+static void setCoding(iso15693VcdCoding_t coding)
+{
+    const struct iso15693StreamConfig *stream;
+    iso15693PhyConfig_t config;
+
+    config.coding = coding;
+    config.fastMode = false;
+    iso15693PhyConfigure(&config, &stream);
+    refIso15693PhyConfigure(&config, &stream);
+}
+
+/* Minimum chunk the coder accepts for the coding */
+static uint16_t minChunk(iso15693VcdCoding_t coding)
+{
+    return ((ISO15693_VCD_CODING_1_4 == coding) ? 5 : 65);
+}
+
+/* Code a frame as rfalTransceiveTx() does: chunk after chunk until no ERR_AGAIN */
+static ReturnCode codeFrame(vcdCode_t code, const uint8_t *frame, uint16_t len, bool crc, bool flags, bool picopass,
+                            const uint16_t *chunks, uint8_t *out, uint16_t *outLen, uint16_t *subbits, unsigned *calls)
+{
+    uint8_t buf[CODE_MAX_FRAME];
+    uint16_t offset = 0;
+    uint16_t act;
+    ReturnCode err;
+
+    ST_MEMCPY(buf, frame, len);
+    *outLen = 0;
+    *calls  = 0;
+    do
+    {
+        err = code(buf, len, crc, flags, picopass, subbits, &offset, &out[*outLen], chunks[*calls], &act);
+        *outLen += act;
+        (*calls)++;
+    } while ((ERR_AGAIN == err) && (*calls < 4096));
+    return err;
+}
+
+static void compareFrame(iso15693VcdCoding_t coding, const uint8_t *frame, uint16_t len, bool crc, bool flags, bool picopass, const uint16_t *chunks)
+{
+    static uint8_t outNew[CODE_MAX_STREAM];
+    static uint8_t outRef[CODE_MAX_STREAM];
+    uint16_t lenNew, lenRef, subNew, subRef;
+    unsigned callsNew, callsRef;
+    ReturnCode errNew, errRef;
+
+    errNew = codeFrame(iso15693VCDCode, frame, len, crc, flags, picopass, chunks, outNew, &lenNew, &subNew, &callsNew);
+    errRef = codeFrame(refIso15693VCDCode, frame, len, crc, flags, picopass, chunks, outRef, &lenRef, &subRef, &callsRef);
+
+    if ((errNew != errRef) || (lenNew != lenRef) || (subNew != subRef) || (callsNew != callsRef)
+        || (0 != memcmp(outNew, outRef, lenNew)))
+    {
+        printf("code mismatch: coding %d len %u crc %d flags %d picopass %d: err %d/%d len %u/%u subbits %u/%u calls %u/%u\n",
+               coding, len, crc, flags, picopass, errNew, errRef, lenNew, lenRef, subNew, subRef, callsNew, callsRef);
+        failures++;
+    }
+}
+
+static void testCodeAllBytes(iso15693VcdCoding_t coding)
+{
+    uint16_t chunks[4096];
+    uint8_t frame[1];
+    unsigned i;
+    unsigned v;
+
+    for (i = 0; i < 4096; i++)
+    {
+        chunks[i] = CODE_MAX_STREAM;
+    }
+    for (v = 0; v < 256; v++)
+    {
+        frame[0] = (uint8_t)v;
+        compareFrame(coding, frame, 1, false, false, false, chunks);
+        compareFrame(coding, frame, 1, true, false, false, chunks);
+    }
+}
+
+static void testCodeRandom(iso15693VcdCoding_t coding)
+{
+    uint16_t chunks[4096];
+    uint8_t frame[CODE_MAX_FRAME];
+    unsigned n;
+    unsigned i;
+    uint16_t len;
+
+    for (n = 0; n < CODE_RANDOM_FRAMES; n++)
+    {
+        len = (uint16_t)(rand() % ((ISO15693_VCD_CODING_1_4 == coding) ? CODE_MAX_FRAME : 40));
+        for (i = 0; i < len; i++)
+        {
+            frame[i] = (uint8_t)rand();
+        }
+        for (i = 0; i < 4096; i++)
+        { /* mostly usable chunks, sometimes one the coder refuses */
+            chunks[i] = (uint16_t)(minChunk(coding) - ((rand() % 16) == 0) + (rand() % 300));
+        }
+        /* PicoPass leaves the command byte out of the CRC, so it needs one */
+        compareFrame(coding, frame, len, (rand() & 1), (rand() & 1), ((len > 0) && (rand() & 1)), chunks);
+    }
+}
+
+static void streamBit(stream_t *st, unsigned bit)
+{
+    if (bit)
+    {
+        st->buf[st->bits / 8] |= (uint8_t)(1 << (st->bits % 8));
+    }
+    st->bits++;
+}
+
+/* SOF, a Manchester pair per bit LSB first, EOF 10111000 and \a pad 0 bits */
+static void streamFrame(stream_t *st, const uint8_t *frame, uint16_t len, unsigned pad)
+{
+    static const uint8_t sof[5] = { 1, 1, 1, 0, 1 };
+    static const uint8_t eof[8] = { 1, 0, 1, 1, 1, 0, 0, 0 };
+    unsigned i;
+
+    memset(st, 0, sizeof(stream_t));
+    for (i = 0; i < 5; i++)
+    {
+        streamBit(st, sof[i]);
+    }
+    for (i = 0; i < (len * 8U); i++)
+    {
+        unsigned bit = (frame[i / 8] >> (i % 8)) & 1;
+        streamBit(st, !bit);
+        streamBit(st, bit);
+    }
+    for (i = 0; i < 8; i++)
+    {
+        streamBit(st, eof[i]);
+    }
+    for (i = 0; i < pad; i++)
+    {
+        streamBit(st, 0);
+    }
+}
+
+static uint16_t streamLen(const stream_t *st)
+{
+    return (uint16_t)((st->bits + 7) / 8);
+}
+
+/* Turn the pair of payload bit \a bit into 00 or 11 */
+static void streamCollide(stream_t *st, unsigned bit, unsigned both)
+{
+    unsigned p = 5 + 2 * bit;
+    unsigned i;
+
+    for (i = p; i < (p + 2); i++)
+    {
+        if (both)
+        {
+            st->buf[i / 8] |= (uint8_t)(1 << (i % 8));
+        }
+        else
+        {
+            st->buf[i / 8] &= (uint8_t)~(1 << (i % 8));
+        }
+    }
+}
+
+/* Payload of \a len bytes, the last 2 are a valid CRC if \a crcOk */
+static void makeFrame(uint8_t *frame, uint16_t len, bool picopass, bool crcOk)
+{
+    uint16_t crc;
+    unsigned i;
+
+    for (i = 0; i < len; i++)
+    {
+        frame[i] = (uint8_t)rand();
+    }
+    if (crcOk && (len > 2))
+    {
+        crc = rfalCrcCalculateCcitt((picopass ? 0xE012 : 0xFFFF), frame, len - 2);
+        crc = (picopass ? crc : (uint16_t)~crc);
+        frame[len - 2] = (uint8_t)(crc & 0xff);
+        frame[len - 1] = (uint8_t)(crc >> 8);
+    }
+}
+
+static void compareDecode(const char *what, const stream_t *st, uint16_t inBufLen, uint16_t outBufLen, uint16_t ignoreBits, bool picopass)
+{
+    static stream_t inNew, inRef;
+    static uint8_t outNew[DEC_MAX_FRAME + 8];
+    static uint8_t outRef[DEC_MAX_FRAME + 8];
+    uint16_t posNew = 0xFFFF, posRef = 0xFFFF, colNew = 0xFFFF, colRef = 0xFFFF;
+    ReturnCode errNew, errRef;
+
+    inNew = *st;
+    inRef = *st;
+    memset(outNew, 0x5a, sizeof(outNew));
+    memset(outRef, 0x5a, sizeof(outRef));
+
+    errNew = iso15693VICCDecode(inNew.buf, inBufLen, outNew, outBufLen, &posNew, &colNew, ignoreBits, picopass);
+    errRef = refIso15693VICCDecode(inRef.buf, inBufLen, outRef, outBufLen, &posRef, &colRef, ignoreBits, picopass);
+
+    if ((errNew != errRef) || (posNew != posRef) || (colNew != colRef) || (0 != memcmp(outNew, outRef, sizeof(outNew))))
+    {
+        printf("decode mismatch (%s): inLen %u outLen %u ignore %u picopass %d: err %d/%d pos %u/%u bitsBeforeCol %u/%u\n",
+               what, inBufLen, outBufLen, ignoreBits, picopass, errNew, errRef, posNew, posRef, colNew, colRef);
+        failures++;
+    }
+}
+
+static void testDecodeValid(void)
+{
+    static stream_t st;
+    uint8_t frame[DEC_MAX_FRAME];
+    unsigned n;
+
+    for (n = 0; n < DEC_RANDOM_FRAMES; n++)
+    {
+        uint16_t len = (uint16_t)(rand() % DEC_MAX_FRAME);
+        bool picopass = (rand() & 1);
+        bool crcOk = ((rand() % 4) != 0);
+
+        makeFrame(frame, len, picopass, crcOk);
+        streamFrame(&st, frame, len, rand() % 24);
+        compareDecode(crcOk ? "valid" : "crc", &st, streamLen(&st), DEC_MAX_FRAME, 0, picopass);
+        /* output buffer shorter than, equal to or longer than the frame */
+        compareDecode("outLen", &st, streamLen(&st), (uint16_t)(rand() % (len + 3)), 0, picopass);
+    }
+}
+
+static void testDecodeCollisions(void)
+{
+    static stream_t st;
+    uint8_t frame[64];
+    unsigned len;
+    unsigned bit;
+
+    for (len = 1; len <= sizeof(frame); len += 7)
+    {
+        makeFrame(frame, (uint16_t)len, false, true);
+        for (bit = 0; bit < (len * 8); bit++)
+        {
+            streamFrame(&st, frame, (uint16_t)len, 8);
+            streamCollide(&st, bit, (bit & 1));
+            compareDecode("collision", &st, streamLen(&st), DEC_MAX_FRAME, 0, false);
+            compareDecode("collision ignored", &st, streamLen(&st), DEC_MAX_FRAME, (uint16_t)(bit + 1), false);
+            compareDecode("collision at ignore", &st, streamLen(&st), DEC_MAX_FRAME, (uint16_t)bit, false);
+            compareDecode("collision all ignored", &st, streamLen(&st), DEC_MAX_FRAME, (uint16_t)(len * 8 + 16), false);
+            /* a second collision further on */
+            if ((bit + 5) < (len * 8))
+            {
+                streamCollide(&st, bit + 5, !(bit & 1));
+                compareDecode("two collisions", &st, streamLen(&st), DEC_MAX_FRAME, (uint16_t)(bit + 1), false);
+            }
+        }
+    }
+}
+
+static void testDecodeErrors(void)
+{
+    static stream_t st;
+    uint8_t frame[DEC_MAX_FRAME];
+    unsigned n;
+    unsigned i;
+
+    for (n = 0; n < DEC_RANDOM_FRAMES; n++)
+    {
+        uint16_t len = (uint16_t)(1 + (rand() % 80));
+        uint16_t inLen;
+
+        makeFrame(frame, len, false, true);
+
+        /* truncated anywhere, also inside the SOF */
+        streamFrame(&st, frame, len, 0);
+        inLen = (uint16_t)(1 + (rand() % streamLen(&st)));
+        compareDecode("truncated", &st, inLen, DEC_MAX_FRAME, 0, false);
+
+        /* broken SOF */
+        streamFrame(&st, frame, len, 8);
+        st.buf[0] ^= (uint8_t)(1 << (rand() % 5));
+        compareDecode("sof", &st, streamLen(&st), DEC_MAX_FRAME, 0, false);
+
+        /* no EOF, random bits behind the last pair */
+        streamFrame(&st, frame, len, 0);
+        st.bits -= 8;
+        for (i = 0; i < 24; i++)
+        {
+            streamBit(&st, rand() & 1);
+        }
+        st.buf[st.bits / 8] &= (uint8_t)((1 << (st.bits % 8)) - 1);
+        compareDecode("eof", &st, streamLen(&st), DEC_MAX_FRAME, 0, false);
+
+        /* random stream behind a valid SOF */
+        memset(&st, 0, sizeof(st));
+        inLen = (uint16_t)(1 + (rand() % 200));
+        for (i = 0; i < inLen; i++)
+        {
+            st.buf[i] = (uint8_t)rand();
+        }
+        st.buf[0] = (uint8_t)((st.buf[0] & 0xe0) | 0x17);
+        compareDecode("random", &st, inLen, (uint16_t)(rand() % DEC_MAX_FRAME), (uint16_t)(rand() % 64), (rand() & 1));
+    }
+}
+
+static double benchDecode(viccDecode_t decode, uint16_t len)
+{
+    static stream_t st;
+    static stream_t in;
+    uint8_t frame[DEC_MAX_FRAME];
+    uint8_t out[DEC_MAX_FRAME];
+    uint16_t pos, col;
+    clock_t start;
+    unsigned r;
+
+    makeFrame(frame, len, false, true);
+    streamFrame(&st, frame, len, 8);
+    in = st;
+    start = clock();
+    for (r = 0; r < DEC_BENCH_ROUNDS; r++)
+    {
+        decode(in.buf, streamLen(&st), out, sizeof(out), &pos, &col, 0, false);
+    }
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static double benchCode(vcdCode_t code, uint16_t len)
+{
+    static uint8_t out[CODE_MAX_STREAM];
+    uint8_t frame[CODE_MAX_FRAME];
+    uint16_t offset, act, subbits;
+    clock_t start;
+    unsigned r;
+
+    for (r = 0; r < len; r++)
+    {
+        frame[r] = (uint8_t)rand();
+    }
+    start = clock();
+    for (r = 0; r < CODE_BENCH_ROUNDS; r++)
+    {
+        offset = 0;
+        code(frame, len, true, false, false, &subbits, &offset, out, sizeof(out), &act);
+    }
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(void)
+{
+    static const struct
+    {
+        iso15693VcdCoding_t coding;
+        uint16_t len;
+        const char *name;
+    } bench[] =
+    {
+        { ISO15693_VCD_CODING_1_4,   255, "1 of 4, 255 bytes" },
+        { ISO15693_VCD_CODING_1_256, 32,  "1 of 256, 32 bytes" },
+    };
+    unsigned i;
+
+    srand(1);
+
+    setCoding(ISO15693_VCD_CODING_1_4);
+    testCodeAllBytes(ISO15693_VCD_CODING_1_4);
+    testCodeRandom(ISO15693_VCD_CODING_1_4);
+    setCoding(ISO15693_VCD_CODING_1_256);
+    testCodeAllBytes(ISO15693_VCD_CODING_1_256);
+    testCodeRandom(ISO15693_VCD_CODING_1_256);
+
+    testDecodeValid();
+    testDecodeCollisions();
+    testDecodeErrors();
+
+    for (i = 0; i < (sizeof(bench)/sizeof(bench[0])); i++)
+    {
+        double tNew, tRef;
+
+        setCoding(bench[i].coding);
+        tNew = benchCode(iso15693VCDCode, bench[i].len);
+        tRef = benchCode(refIso15693VCDCode, bench[i].len);
+        printf("code %s: %.1f us new, %.1f us baseline, %.1fx\n", bench[i].name,
+               tNew * 1e6 / CODE_BENCH_ROUNDS, tRef * 1e6 / CODE_BENCH_ROUNDS, (tNew > 0) ? (tRef / tNew) : 0.0);
+    }
+
+    {
+        double tNew = benchDecode(iso15693VICCDecode, 258);
+        double tRef = benchDecode(refIso15693VICCDecode, 258);
+
+        printf("decode 256 bytes + CRC: %.1f us new, %.1f us baseline, %.1fx\n",
+               tNew * 1e6 / DEC_BENCH_ROUNDS, tRef * 1e6 / DEC_BENCH_ROUNDS, (tNew > 0) ? (tRef / tNew) : 0.0);
+    }
+
+    if (failures)
+    {
+        printf("iso15693_2_host: %lu mismatches\n", failures);
+        return 1;
+    }
+    printf("iso15693_2_host: coder and decoder identical\n");
+    return 0;
+}
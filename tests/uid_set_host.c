@@ -0,0 +1,329 @@
+/*! \file uid_set_host.c
+ *
+ *  \brief Host test of the UID seen-set against a reference model
+ *
+ *  A population of synthetic PICCs of all technologies is seen, expired
+ *  and seen again at random times through uid_set.c, with random TTLs, set
+ *  loads up to and beyond #UID_SET_MAX_ENTRIES and partial sweeps. The
+ *  model keeps every PICC by index with a 32 bit timestamp; arrivals,
+ *  return codes, the entry count and every departure have to agree with
+ *  it, and after a full sweep no expired PICC may remain. Afterwards the
+ *  operations of the set are timed on a full table.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "uid_set.h"
+
+#define POPULATION        4000U
+#define OPERATIONS        400000U
+#define FULL_SWEEP_EVERY  1000U
+#define BENCH_ROUNDS      200U
+
+typedef struct
+{
+    uint8_t  tech;
+    uint8_t  uidLen;
+    uint8_t  uid[UID_SET_MAX_UID_LEN];
+    uint32_t fp;
+    bool     present;
+    uint32_t seenAt;        /* tick, not truncated */
+} picc_t;
+
+static picc_t   pop[POPULATION];
+static uint16_t byFp[POPULATION];   /* population indexes sorted by fingerprint */
+static uint16_t modelCount;
+static uint32_t modelTtl;
+static unsigned failures;
+
+static int cmpFp(const void *a, const void *b)
+{
+    uint32_t fa = pop[*(const uint16_t*)a].fp;
+    uint32_t fb = pop[*(const uint16_t*)b].fp;
+
+    return (fa > fb) - (fa < fb);
+}
+
+static void makePopulation(void)
+{
+    static const uint8_t nfcaLen[3] = { 4, 7, 10 };
+    unsigned n;
+    unsigned i;
+
+    for (n = 0; n < POPULATION; n++)
+    {
+        pop[n].tech = (uint8_t)(UID_SET_TECH_ISO15693 + (n % 5));
+        pop[n].uidLen = ((pop[n].tech == UID_SET_TECH_NFCA) ? nfcaLen[(n / 5) % 3] : ((pop[n].tech == UID_SET_TECH_NFCB) ? 4 : 8));
+        for (i = 0; i < pop[n].uidLen; i++)
+        {
+            pop[n].uid[i] = (uint8_t)rand();
+        }
+        pop[n].uid[0] = (uint8_t)(n >> 8);
+        pop[n].uid[1] = (uint8_t)n;
+        pop[n].fp = uidSetFingerprint(pop[n].tech, pop[n].uid, pop[n].uidLen);
+        if ((pop[n].fp == 0) || (UID_SET_FP_TECH(pop[n].fp) != pop[n].tech))
+        {
+            printf("fingerprint 0x%08x of technology %u\n", (unsigned)pop[n].fp, pop[n].tech);
+            failures++;
+        }
+        byFp[n] = (uint16_t)n;
+    }
+    qsort(byFp, POPULATION, sizeof(byFp[0]), cmpFp);
+    for (n = 1; n < POPULATION; n++)
+    {
+        if (pop[byFp[n]].fp == pop[byFp[n - 1]].fp)
+        { /* the model tells the PICCs apart, the set would not */
+            printf("population has a fingerprint collision, pick another seed\n");
+            exit(2);
+        }
+    }
+}
+
+static picc_t *findFp(uint32_t fp)
+{
+    unsigned lo = 0;
+    unsigned hi = POPULATION;
+
+    while (lo < hi)
+    {
+        unsigned mid = (lo + hi) / 2;
+
+        if (pop[byFp[mid]].fp < fp)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return (((lo < POPULATION) && (pop[byFp[lo]].fp == fp)) ? &pop[byFp[lo]] : NULL);
+}
+
+static bool modelExpired(const picc_t *p, uint32_t nowMs)
+{
+    return (((nowMs >> UID_SET_TICK_SHIFT) - p->seenAt) > modelTtl);
+}
+
+static void modelInit(uint32_t ttlMs)
+{
+    unsigned n;
+
+    for (n = 0; n < POPULATION; n++)
+    {
+        pop[n].present = false;
+    }
+    modelCount = 0;
+    modelTtl = ((ttlMs + (1UL << UID_SET_TICK_SHIFT) - 1) >> UID_SET_TICK_SHIFT);
+}
+
+static void checkSeen(picc_t *p, uint32_t nowMs)
+{
+    ReturnCode errModel = ERR_NONE;
+    ReturnCode err;
+    bool arrivedModel = false;
+    bool arrived = false;
+
+    if (p->present)
+    {
+        arrivedModel = modelExpired(p, nowMs);
+        p->seenAt = (nowMs >> UID_SET_TICK_SHIFT);
+    }
+    else if (modelCount >= UID_SET_MAX_ENTRIES)
+    {
+        errModel = ERR_NOMEM;
+    }
+    else
+    {
+        p->present = true;
+        p->seenAt = (nowMs >> UID_SET_TICK_SHIFT);
+        modelCount++;
+        arrivedModel = true;
+    }
+
+    err = uidSetSeen(p->tech, p->uid, p->uidLen, nowMs, &arrived);
+    if ((err != errModel) || ((err == ERR_NONE) && (arrived != arrivedModel)))
+    {
+        printf("seen at %u ms: err %d/%d arrived %d/%d\n", (unsigned)nowMs, err, errModel, arrived, arrivedModel);
+        failures++;
+    }
+}
+
+static void checkExpire(uint32_t nowMs, uint16_t maxSlots, uint16_t maxDeparted)
+{
+    static uint32_t departed[UID_SET_SIZE];
+    uint16_t cnt;
+    uint16_t i;
+
+    cnt = uidSetExpire(nowMs, maxSlots, departed, maxDeparted);
+    if (cnt > maxDeparted)
+    {
+        printf("expire returned %u of at most %u\n", cnt, maxDeparted);
+        failures++;
+        return;
+    }
+    for (i = 0; i < cnt; i++)
+    {
+        picc_t *p = findFp(departed[i]);
+
+        if ((p == NULL) || !p->present || !modelExpired(p, nowMs))
+        {
+            printf("departure of 0x%08x at %u ms not expected\n", (unsigned)departed[i], (unsigned)nowMs);
+            failures++;
+            continue;
+        }
+        p->present = false;
+        modelCount--;
+    }
+}
+
+static void checkFullSweep(uint32_t nowMs)
+{
+    unsigned n;
+
+    checkExpire(nowMs, UID_SET_SIZE, UID_SET_SIZE);
+    for (n = 0; n < POPULATION; n++)
+    {
+        if (pop[n].present && modelExpired(&pop[n], nowMs))
+        {
+            printf("PICC %u expired at %u ms but not swept\n", n, (unsigned)nowMs);
+            failures++;
+        }
+    }
+}
+
+static void testModel(uint32_t ttlMs, unsigned msStep, unsigned active)
+{
+    uint32_t now = (uint32_t)rand();
+    unsigned op;
+
+    if ((uidSetInit(ttlMs) != ERR_NONE))
+    {
+        printf("init with TTL %u failed\n", (unsigned)ttlMs);
+        failures++;
+        return;
+    }
+    modelInit(ttlMs);
+
+    for (op = 0; op < OPERATIONS; op++)
+    {
+        unsigned r = (unsigned)rand() % 100;
+
+        now += (unsigned)rand() % (msStep + 1);
+        if (r < 75)
+        {
+            checkSeen(&pop[(unsigned)rand() % active], now);
+        }
+        else
+        {
+            checkExpire(now, (uint16_t)((unsigned)rand() % 128), (uint16_t)((unsigned)rand() % 9));
+        }
+        if ((op % FULL_SWEEP_EVERY) == 0)
+        {
+            checkFullSweep(now);
+        }
+        if (uidSetCount() != modelCount)
+        {
+            printf("TTL %u ms: count %u, model %u\n", (unsigned)ttlMs, uidSetCount(), modelCount);
+            failures++;
+            return;
+        }
+    }
+}
+
+static void testParams(void)
+{
+    static const uint8_t uid[UID_SET_MAX_UID_LEN] = { 0 };
+    bool arrived;
+
+    if (uidSetInit(UID_SET_MAX_TTL_MS + 1) != ERR_PARAM)
+    {
+        printf("TTL beyond the maximum accepted\n");
+        failures++;
+    }
+    uidSetInit(1000);
+    if ((uidSetSeen(UID_SET_TECH_NFCB, uid, 7, 0, &arrived) != ERR_PARAM) ||
+        (uidSetSeen(UID_SET_TECH_NFCA, NULL, 4, 0, &arrived) != ERR_PARAM) ||
+        (uidSetSeen(0, uid, 8, 0, &arrived) != ERR_PARAM) ||
+        (uidSetSeen(UID_SET_TECH_ST25TB + 1, uid, 8, 0, &arrived) != ERR_PARAM) ||
+        (uidSetSeen(UID_SET_TECH_NFCA, uid, 10, 0, NULL) != ERR_NONE) ||
+        (uidSetCount() != 1))
+    {
+        printf("parameter checks differ\n");
+        failures++;
+    }
+}
+
+static double seconds(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void bench(void)
+{
+    static uint32_t departed[UID_SET_SIZE];
+    clock_t start;
+    double tInsert, tHit, tExpire;
+    unsigned r;
+    unsigned n;
+    bool arrived;
+
+    tInsert = 0;
+    tHit = 0;
+    tExpire = 0;
+    for (r = 0; r < BENCH_ROUNDS; r++)
+    {
+        uidSetInit(1000);
+
+        start = clock();
+        for (n = 0; n < UID_SET_MAX_ENTRIES; n++)
+        {
+            uidSetSeen(pop[n].tech, pop[n].uid, pop[n].uidLen, 0, &arrived);
+        }
+        tInsert += seconds(start);
+
+        start = clock();
+        for (n = 0; n < UID_SET_MAX_ENTRIES; n++)
+        {
+            uidSetSeen(pop[n].tech, pop[n].uid, pop[n].uidLen, 500, &arrived);
+        }
+        tHit += seconds(start);
+
+        start = clock();
+        uidSetExpire(5000, UID_SET_SIZE, departed, UID_SET_SIZE);
+        tExpire += seconds(start);
+    }
+
+    printf("uid set %u slots, %u bytes: insert %.1f ns, seen again %.1f ns, expire %.1f ns per PICC at 7/8 load\n",
+           UID_SET_SIZE, (unsigned)(UID_SET_SIZE * (sizeof(uint32_t) + sizeof(uint16_t))),
+           tInsert * 1e9 / (BENCH_ROUNDS * UID_SET_MAX_ENTRIES),
+           tHit * 1e9 / (BENCH_ROUNDS * UID_SET_MAX_ENTRIES),
+           tExpire * 1e9 / (BENCH_ROUNDS * UID_SET_MAX_ENTRIES));
+}
+
+int main(void)
+{
+    srand(38);
+    makePopulation();
+
+    testParams();
+    /* TTL 0 expires at the next tick, the maximum relies on the full sweeps */
+    testModel(0, 40, 500);
+    testModel(100, 20, 700);
+    testModel(1000, 10, UID_SET_MAX_ENTRIES);
+    testModel(5000, 10, POPULATION);
+    testModel(60000, 200, 2000);
+    testModel(UID_SET_MAX_TTL_MS, 500, POPULATION);
+
+    if (failures)
+    {
+        printf("uid_set_host: %u mismatches\n", failures);
+        return 1;
+    }
+
+    bench();
+    printf("uid_set_host: set agrees with the model\n");
+    return 0;
+}